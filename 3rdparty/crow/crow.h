@@ -10858,6 +10858,9 @@ namespace crow
         /// Call the after handle middleware and send the write the response to the connection.
         void complete_request()
         {
+            // Asynchronous handlers leave the last reference to this connection in res.complete_request_handler_,
+            // which is cleared below while it is still running; hold our own reference until the write is done.
+            auto self = this->shared_from_this();
             CROW_LOG_INFO << "Response: " << this << ' ' << req_.raw_url << ' ' << res.code << ' ' << close_connection_;
             res.is_alive_helper_ = nullptr;
 
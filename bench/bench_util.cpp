@@ -0,0 +1,143 @@
+#include "bench_util.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+namespace bench {
+
+Options::Options(int argc, char** argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) != 0) {
+            continue;
+        }
+        arg = arg.substr(2);
+
+        const std::size_t equals = arg.find('=');
+        if (equals != std::string::npos) {
+            values_[arg.substr(0, equals)] = arg.substr(equals + 1);
+        } else if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+            values_[arg] = argv[++i];
+        } else {
+            values_[arg] = "1";
+        }
+    }
+}
+
+bool Options::has(const std::string& key) const {
+    return values_.count(key) > 0;
+}
+
+std::string Options::getString(const std::string& key, const std::string& fallback) const {
+    const auto it = values_.find(key);
+    return it == values_.end() ? fallback : it->second;
+}
+
+long long Options::getInt(const std::string& key, long long fallback) const {
+    const auto it = values_.find(key);
+    if (it == values_.end()) {
+        return fallback;
+    }
+    try {
+        return std::stoll(it->second);
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+double Options::getDouble(const std::string& key, double fallback) const {
+    const auto it = values_.find(key);
+    if (it == values_.end()) {
+        return fallback;
+    }
+    try {
+        return std::stod(it->second);
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+LatencySummary summarize(std::vector<double> samplesMs) {
+    LatencySummary summary;
+    summary.count = samplesMs.size();
+    if (samplesMs.empty()) {
+        return summary;
+    }
+
+    std::sort(samplesMs.begin(), samplesMs.end());
+    const auto percentile = [&samplesMs](double p) {
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(samplesMs.size())));
+        return samplesMs[std::min(samplesMs.size() - 1, rank == 0 ? 0 : rank - 1)];
+    };
+
+    summary.meanMs = std::accumulate(samplesMs.begin(), samplesMs.end(), 0.0) / static_cast<double>(samplesMs.size());
+    summary.p50Ms = percentile(0.50);
+    summary.p95Ms = percentile(0.95);
+    summary.p99Ms = percentile(0.99);
+    summary.maxMs = samplesMs.back();
+    return summary;
+}
+
+std::string formatSummary(const LatencySummary& summary) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2)
+        << "n=" << summary.count
+        << " mean=" << summary.meanMs << "ms"
+        << " p50=" << summary.p50Ms << "ms"
+        << " p95=" << summary.p95Ms << "ms"
+        << " p99=" << summary.p99Ms << "ms"
+        << " max=" << summary.maxMs << "ms";
+    return out.str();
+}
+
+FakeProviderConfig readProviderConfig(const Options& options, int defaultPort) {
+    FakeProviderConfig config;
+    config.port = static_cast<int>(options.getInt("port", defaultPort));
+    config.videosPerPage = static_cast<std::size_t>(options.getInt("videos", 20));
+    config.pageCount = static_cast<std::size_t>(options.getInt("pages", 1));
+    config.episodesPerVideo = static_cast<std::size_t>(options.getInt("episodes", 40));
+    config.sourcesPerVideo = static_cast<std::size_t>(options.getInt("sources", 2));
+    config.contentBytes = static_cast<std::size_t>(options.getInt("content-bytes", 2048));
+    config.latencyMedianMs = options.getDouble("latency-ms", 80.0);
+    config.latencyP99Ms = options.getDouble("latency-p99-ms", 600.0);
+    config.errorRate = options.getDouble("error-rate", 0.0);
+    config.dripRate = options.getDouble("drip-rate", 0.0);
+    config.dripBytesPerSecond = static_cast<std::size_t>(options.getInt("drip-bytes-per-second", 32 * 1024));
+    config.encoding = options.getString("encoding", "identity");
+    config.seed = static_cast<unsigned>(options.getInt("seed", 1));
+    return config;
+}
+
+std::filesystem::path makeTempDir(const std::string& prefix) {
+    std::random_device device;
+    const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::ostringstream name;
+    name << prefix << '-' << std::hex << (static_cast<unsigned long long>(stamp) ^ device());
+
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / name.str();
+    std::filesystem::create_directories(dir);
+    return dir;
+}
+
+bool writeSourceConfig(const std::filesystem::path& file, std::size_t providers, int port, bool singleHost) {
+    nlohmann::json sites = nlohmann::json::object();
+    for (std::size_t i = 0; i < providers; ++i) {
+        const std::string name = "p" + std::to_string(i + 1);
+        const std::string host = singleHost ? "127.0.0.1" : "127.0.0." + std::to_string(i % 254 + 1);
+        sites[name + ".bench"] = {
+            {"name", "基准站点" + std::to_string(i + 1)},
+            {"api", "http://" + host + ":" + std::to_string(port) + "/" + name + "/api.php/provide/vod"}};
+    }
+
+    std::ofstream out(file);
+    out << nlohmann::json{{"api_site", sites}}.dump(2);
+    return static_cast<bool>(out);
+}
+
+} // namespace bench
@@ -0,0 +1,56 @@
+// bench_util.h
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <cstddef>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+#include "fake_provider.h"
+
+// 基准测试工具共用的命令行解析、延迟统计和临时目录
+namespace bench {
+
+// 解析 --key value 和 --flag 形式的参数
+class Options {
+public:
+    Options(int argc, char** argv);
+
+    bool has(const std::string& key) const;
+    std::string getString(const std::string& key, const std::string& fallback) const;
+    long long getInt(const std::string& key, long long fallback) const;
+    double getDouble(const std::string& key, double fallback) const;
+
+private:
+    std::map<std::string, std::string> values_;
+};
+
+struct LatencySummary {
+    std::size_t count = 0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// 按最近秩计算分位数
+LatencySummary summarize(std::vector<double> samplesMs);
+
+// 形如 "n=20 mean=12.3ms p50=... p95=... p99=... max=..." 的一行
+std::string formatSummary(const LatencySummary& summary);
+
+// 读取模拟站点的参数（--videos、--latency-ms、--error-rate、--encoding 等）
+FakeProviderConfig readProviderConfig(const Options& options, int defaultPort);
+
+// 在系统临时目录下创建唯一的工作目录
+std::filesystem::path makeTempDir(const std::string& prefix);
+
+// 写出指向模拟站点的 source.json，站点名为 p1..pN。
+// 每个站点使用不同的 127.0.0.x 地址，单主机并发限制按真实场景分别生效；singleHost 时都用 127.0.0.1
+bool writeSourceConfig(const std::filesystem::path& file, std::size_t providers, int port, bool singleHost);
+
+} // namespace bench
+
+#endif // BENCH_UTIL_H
@@ -0,0 +1,444 @@
+#include "fake_provider.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <random>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+constexpr const char* kLogModule = "FakeProvider";
+constexpr std::size_t kMaxRequestBytes = 16 * 1024;
+constexpr std::size_t kDripChunkBytes = 1024;
+// 标准正态分布的 0.99 分位数
+constexpr double kZ99 = 2.3263;
+
+template <typename... Args>
+void logInfo(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+
+std::string percentDecode(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        if (value[i] == '%' && i + 2 < value.size()) {
+            result.push_back(static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16)));
+            i += 2;
+        } else if (value[i] == '+') {
+            result.push_back(' ');
+        } else {
+            result.push_back(value[i]);
+        }
+    }
+    return result;
+}
+
+std::map<std::string, std::string> parseQuery(const std::string& query) {
+    std::map<std::string, std::string> params;
+    std::size_t start = 0;
+    while (start <= query.size()) {
+        const std::size_t end = std::min(query.find('&', start), query.size());
+        const std::string pair = query.substr(start, end - start);
+        const std::size_t equals = pair.find('=');
+        if (equals != std::string::npos) {
+            try {
+                params[pair.substr(0, equals)] = percentDecode(pair.substr(equals + 1));
+            } catch (const std::exception&) {
+                params[pair.substr(0, equals)] = pair.substr(equals + 1);
+            }
+        }
+        start = end + 1;
+    }
+    return params;
+}
+
+std::vector<std::size_t> parseIds(const std::string& value) {
+    std::vector<std::size_t> ids;
+    std::size_t start = 0;
+    while (start < value.size()) {
+        const std::size_t end = std::min(value.find(',', start), value.size());
+        try {
+            ids.push_back(static_cast<std::size_t>(std::stoul(value.substr(start, end - start))));
+        } catch (const std::exception&) {
+        }
+        start = end + 1;
+    }
+    return ids;
+}
+
+bool sendAll(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        size -= static_cast<std::size_t>(sent);
+    }
+    return true;
+}
+
+std::string makeHeader(int status, const char* reason, std::size_t contentLength, const std::string& contentEncoding = "") {
+    return "HTTP/1.1 " + std::to_string(status) + " " + reason + "\r\n"
+           "Content-Type: application/json; charset=utf-8\r\n" +
+           (contentEncoding.empty() ? std::string() : "Content-Encoding: " + contentEncoding + "\r\n") +
+           "Content-Length: " + std::to_string(contentLength) + "\r\n"
+           "Connection: close\r\n\r\n";
+}
+
+// 请求头中的 Accept-Encoding 是否包含 encoding（不区分大小写，忽略 q 值）
+bool acceptsEncoding(const std::string& request, const std::string& encoding) {
+    std::string lower(request.size(), '\0');
+    std::transform(request.begin(), request.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    const std::size_t header = lower.find("\r\naccept-encoding:");
+    if (header == std::string::npos) {
+        return false;
+    }
+    const std::size_t end = lower.find("\r\n", header + 2);
+    const std::string value = lower.substr(header, end == std::string::npos ? std::string::npos : end - header);
+    return value.find(encoding) != std::string::npos;
+}
+
+// 按 HTTP 的 gzip 或 deflate（zlib 格式）编码压缩响应体，失败时返回 false
+bool compressBody(const std::string& body, bool gzip, std::string& out) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+    out.resize(deflateBound(&stream, static_cast<uLong>(body.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+    stream.avail_in = static_cast<uInt>(body.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+    stream.avail_out = static_cast<uInt>(out.size());
+    const int result = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result == Z_STREAM_END;
+}
+
+// 重复的中文段落，模拟 vod_content 中带标签的长简介
+std::string makeContent(std::size_t bytes, std::size_t id) {
+    static const std::string kSentence = "<p>这是一段用于基准测试的剧情简介，包含&nbsp;实体和<b>标签</b>。</p>";
+    std::string content = "<p>编号 " + std::to_string(id) + "</p>";
+    while (content.size() < bytes) {
+        content += kSentence;
+    }
+    return content;
+}
+
+// 不同站点使用相同的标题，部分带季数或全角字符，用于覆盖目录合并
+std::string makeTitle(const std::string& keyword, std::size_t id) {
+    if (id % 5 == 0) {
+        return keyword + " " + std::to_string(id) + " 第" + std::to_string(id % 3 + 1) + "季";
+    }
+    if (id % 7 == 0) {
+        return keyword + "（" + std::to_string(id) + "）";
+    }
+    return keyword + " " + std::to_string(id);
+}
+
+// 完整条目对应 ac=videolist / ac=detail；摘要条目对应 ac=list，只有标题、备注和播放源名称
+json makeVideo(const FakeProviderConfig& config,
+               const std::string& provider,
+               const std::string& name,
+               std::size_t id,
+               bool detail) {
+    std::string playFrom;
+    std::string playUrl;
+    for (std::size_t source = 0; source < config.sourcesPerVideo; ++source) {
+        if (source > 0) {
+            playFrom += "$$$";
+            playUrl += "$$$";
+        }
+        playFrom += source == 0 ? "m3u8" : "src" + std::to_string(source);
+        for (std::size_t episode = 1; detail && episode <= config.episodesPerVideo; ++episode) {
+            if (episode > 1) {
+                playUrl += "#";
+            }
+            playUrl += "第" + std::to_string(episode) + "集$https://cdn.example.com/" + provider + "/" +
+                       std::to_string(id) + "/" + std::to_string(source) + "/" +
+                       std::to_string(episode) + "/index.m3u8";
+        }
+    }
+
+    json video = {
+        {"vod_id", static_cast<int>(id)},
+        {"vod_name", name},
+        {"type_name", "电视剧"},
+        {"vod_time", "2024-01-01 00:00:00"},
+        {"vod_remarks", "更新至第" + std::to_string(config.episodesPerVideo) + "集"},
+        {"vod_play_from", playFrom}};
+    if (detail) {
+        video["vod_sub"] = name + " 副标题";
+        video["vod_pic"] = "https://img.example.com/" + provider + "/" + std::to_string(id) + ".jpg";
+        video["vod_content"] = makeContent(config.contentBytes, id);
+        video["vod_play_url"] = playUrl;
+    }
+    return video;
+}
+}
+
+FakeProvider::FakeProvider(const FakeProviderConfig& config)
+    : config_(config)
+    , listenFd_(-1)
+    , port_(0)
+    , running_(false)
+    , requests_(0)
+    , errors_(0)
+    , drips_(0)
+    , compressed_(0)
+    , bytesSent_(0)
+    , activeConnections_(0) {
+}
+
+FakeProvider::~FakeProvider() {
+    stop();
+}
+
+std::string FakeProvider::makePayload(const FakeProviderConfig& config,
+                                      const std::string& provider,
+                                      const std::string& keyword,
+                                      std::size_t page,
+                                      bool summary) {
+    const std::size_t pageCount = std::max<std::size_t>(1, config.pageCount);
+    json list = json::array();
+    if (page >= 1 && page <= pageCount) {
+        for (std::size_t i = 0; i < config.videosPerPage; ++i) {
+            const std::size_t id = (page - 1) * config.videosPerPage + i + 1;
+            list.push_back(makeVideo(config, provider, makeTitle(keyword, id), id, !summary));
+        }
+    }
+
+    json payload = {
+        {"code", 1},
+        {"msg", "数据列表"},
+        {"page", page},
+        {"pagecount", pageCount},
+        {"limit", std::to_string(config.videosPerPage)},
+        {"total", pageCount * config.videosPerPage},
+        {"list", list}};
+    return payload.dump();
+}
+
+std::string FakeProvider::makeDetailPayload(const FakeProviderConfig& config,
+                                            const std::string& provider,
+                                            const std::vector<std::size_t>& ids) {
+    const std::size_t total = std::max<std::size_t>(1, config.pageCount) * config.videosPerPage;
+    json list = json::array();
+    for (const std::size_t id : ids) {
+        if (id >= 1 && id <= total) {
+            list.push_back(makeVideo(config, provider, makeTitle("视频", id), id, true));
+        }
+    }
+
+    json payload = {
+        {"code", 1},
+        {"msg", "数据列表"},
+        {"page", 1},
+        {"pagecount", 1},
+        {"limit", std::to_string(list.size())},
+        {"total", list.size()},
+        {"list", list}};
+    return payload.dump();
+}
+
+bool FakeProvider::start() {
+    listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd_ < 0) {
+        logError("无法创建监听套接字: ", std::strerror(errno));
+        return false;
+    }
+
+    const int reuse = 1;
+    ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    // 监听全部地址，127.0.0.x 都能访问，便于模拟不同主机
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(static_cast<uint16_t>(config_.port));
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd_, 512) != 0) {
+        logError("无法监听端口 ", config_.port, ": ", std::strerror(errno));
+        ::close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&address), &length);
+    port_ = ntohs(address.sin_port);
+
+    running_ = true;
+    acceptThread_ = std::thread(&FakeProvider::acceptLoop, this);
+    logInfo("模拟站点已启动，端口: ", port_);
+    return true;
+}
+
+void FakeProvider::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    ::shutdown(listenFd_, SHUT_RDWR);
+    ::close(listenFd_);
+    listenFd_ = -1;
+    if (acceptThread_.joinable()) {
+        acceptThread_.join();
+    }
+
+    std::unique_lock<std::mutex> lock(connectionsMutex_);
+    connectionsDone_.wait(lock, [this]() { return activeConnections_ == 0; });
+}
+
+int FakeProvider::port() const {
+    return port_;
+}
+
+FakeProvider::Counters FakeProvider::counters() const {
+    Counters counters;
+    counters.requests = requests_.load();
+    counters.errors = errors_.load();
+    counters.drips = drips_.load();
+    counters.compressed = compressed_.load();
+    counters.bytesSent = bytesSent_.load();
+    return counters;
+}
+
+void FakeProvider::acceptLoop() {
+    std::mt19937 seeds(config_.seed);
+    while (running_) {
+        const int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            if (!running_) {
+                break;
+            }
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            activeConnections_++;
+        }
+        std::thread(&FakeProvider::handleConnection, this, fd, static_cast<unsigned>(seeds())).detach();
+    }
+}
+
+void FakeProvider::handleConnection(int fd, unsigned seed) {
+    std::string request;
+    char buffer[4096];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        const ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(buffer, static_cast<std::size_t>(received));
+    }
+
+    // 请求行: GET /<站点>/api.php/provide/vod?ac=videolist&wd=...&pg=... HTTP/1.1
+    const std::size_t targetStart = request.find(' ');
+    const std::size_t targetEnd = targetStart == std::string::npos ? std::string::npos : request.find(' ', targetStart + 1);
+    if (targetEnd != std::string::npos) {
+        requests_++;
+        const std::string target = request.substr(targetStart + 1, targetEnd - targetStart - 1);
+        const std::size_t queryStart = target.find('?');
+        const std::string path = target.substr(0, queryStart);
+        const auto params = parseQuery(queryStart == std::string::npos ? std::string() : target.substr(queryStart + 1));
+
+        const std::size_t providerEnd = path.find('/', 1);
+        const std::string provider = path.substr(1, providerEnd == std::string::npos ? std::string::npos : providerEnd - 1);
+        const auto keyword = params.find("wd");
+        const auto page = params.find("pg");
+
+        std::mt19937 random(seed);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        std::normal_distribution<double> normal(0.0, 1.0);
+
+        const double median = std::max(0.0, config_.latencyMedianMs);
+        const double sigma = median > 0.0 && config_.latencyP99Ms > median ? std::log(config_.latencyP99Ms / median) / kZ99 : 0.0;
+        const double latencyMs = median * std::exp(sigma * normal(random));
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<long long>(latencyMs * 1000.0)));
+
+        if (uniform(random) < config_.errorRate) {
+            errors_++;
+            const std::string body = "{\"code\":0,\"msg\":\"服务器错误\"}";
+            const std::string response = makeHeader(500, "Internal Server Error", body.size()) + body;
+            sendAll(fd, response.data(), response.size());
+            bytesSent_ += response.size();
+        } else {
+            std::size_t pageNumber = 1;
+            if (page != params.end()) {
+                try {
+                    pageNumber = static_cast<std::size_t>(std::stoul(page->second));
+                } catch (const std::exception&) {
+                    pageNumber = 1;
+                }
+            }
+
+            // ac=list 返回摘要，ac=detail&ids=1,2 按编号返回完整条目，其余按 ac=videolist 处理
+            const auto action = params.find("ac");
+            const auto ids = params.find("ids");
+            std::string body;
+            if (action != params.end() && action->second == "detail" && ids != params.end()) {
+                body = makeDetailPayload(config_, provider, parseIds(ids->second));
+            } else {
+                const bool summary = action != params.end() && action->second == "list";
+                body = makePayload(config_, provider, keyword == params.end() ? std::string() : keyword->second, pageNumber, summary);
+            }
+            std::string contentEncoding;
+            if ((config_.encoding == "gzip" || config_.encoding == "deflate") && acceptsEncoding(request, config_.encoding)) {
+                std::string encoded;
+                if (compressBody(body, config_.encoding == "gzip", encoded)) {
+                    body = std::move(encoded);
+                    contentEncoding = config_.encoding;
+                    compressed_++;
+                }
+            }
+            const std::string header = makeHeader(200, "OK", body.size(), contentEncoding);
+            sendAll(fd, header.data(), header.size());
+
+            if (uniform(random) < config_.dripRate && config_.dripBytesPerSecond > 0) {
+                // 慢速发送：按固定速率分块写出，模拟拥塞或限速的上游
+                drips_++;
+                const auto chunkDelay = std::chrono::microseconds(
+                    static_cast<long long>(1e6 * static_cast<double>(kDripChunkBytes) / static_cast<double>(config_.dripBytesPerSecond)));
+                for (std::size_t offset = 0; offset < body.size() && running_; offset += kDripChunkBytes) {
+                    if (!sendAll(fd, body.data() + offset, std::min(kDripChunkBytes, body.size() - offset))) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(chunkDelay);
+                }
+            } else {
+                sendAll(fd, body.data(), body.size());
+            }
+            bytesSent_ += header.size() + body.size();
+        }
+    }
+
+    ::shutdown(fd, SHUT_WR);
+    ::close(fd);
+
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    if (--activeConnections_ == 0) {
+        connectionsDone_.notify_all();
+    }
+}
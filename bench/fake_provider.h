@@ -0,0 +1,93 @@
+// fake_provider.h
+#ifndef FAKE_PROVIDER_H
+#define FAKE_PROVIDER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 本地模拟的 MacCMS 站点，响应 /<站点>/api.php/provide/vod?ac=videolist&wd=<关键词>&pg=<页码>，
+// 以及 ac=list（摘要）和 ac=detail&ids=<编号列表>（按编号取完整条目）。
+// 一个进程可以模拟任意多个站点（路径第一段区分），响应内容由站点名、关键词和页码确定，
+// 延迟、错误率和慢速发送按配置随机产生，用于离线、可重复地测量搜索流程。
+// 配置 encoding 后按请求的 Accept-Encoding 返回 gzip 或 deflate 压缩的响应体，用于验证压缩传输。
+struct FakeProviderConfig {
+    int port = 18090;                      // 0 表示由系统分配
+    std::size_t videosPerPage = 20;
+    std::size_t pageCount = 1;
+    std::size_t episodesPerVideo = 40;
+    std::size_t sourcesPerVideo = 2;       // vod_play_from 中以 $$$ 分隔的播放源数量
+    std::size_t contentBytes = 2048;       // vod_content HTML 的大致长度
+    double latencyMedianMs = 80.0;         // 对数正态延迟的中位数和 p99
+    double latencyP99Ms = 600.0;
+    double errorRate = 0.0;                // 返回 500 的比例
+    double dripRate = 0.0;                 // 慢速发送响应体的比例
+    std::size_t dripBytesPerSecond = 32 * 1024;
+    // 200 响应的内容编码：identity、gzip 或 deflate（zlib 格式）；请求的 Accept-Encoding 不含该编码时不压缩
+    std::string encoding = "identity";
+    unsigned seed = 1;
+};
+
+class FakeProvider {
+public:
+    struct Counters {
+        std::size_t requests = 0;
+        std::size_t errors = 0;
+        std::size_t drips = 0;
+        std::size_t compressed = 0;   // 按 encoding 压缩发送的响应数
+        std::size_t bytesSent = 0;
+    };
+
+    explicit FakeProvider(const FakeProviderConfig& config);
+    ~FakeProvider();
+
+    // 禁用拷贝和赋值
+    FakeProvider(const FakeProvider&) = delete;
+    FakeProvider& operator=(const FakeProvider&) = delete;
+
+    // 监听端口并在后台线程处理请求
+    bool start();
+    void stop();
+
+    // 实际监听的端口
+    int port() const;
+    Counters counters() const;
+
+    // 生成一页 MacCMS 格式的响应体，summary 时为 ac=list 的摘要条目（没有播放地址、海报和简介）
+    static std::string makePayload(const FakeProviderConfig& config,
+                                   const std::string& provider,
+                                   const std::string& keyword,
+                                   std::size_t page,
+                                   bool summary = false);
+
+    // ac=detail&ids=... 的响应；请求中没有关键词，标题统一为 "视频 <编号>"
+    static std::string makeDetailPayload(const FakeProviderConfig& config,
+                                         const std::string& provider,
+                                         const std::vector<std::size_t>& ids);
+
+private:
+    void acceptLoop();
+    void handleConnection(int fd, unsigned seed);
+
+    FakeProviderConfig config_;
+    int listenFd_;
+    int port_;
+    std::atomic<bool> running_;
+    std::thread acceptThread_;
+
+    std::atomic<std::size_t> requests_;
+    std::atomic<std::size_t> errors_;
+    std::atomic<std::size_t> drips_;
+    std::atomic<std::size_t> compressed_;
+    std::atomic<std::size_t> bytesSent_;
+
+    std::size_t activeConnections_;
+    std::mutex connectionsMutex_;
+    std::condition_variable connectionsDone_;
+};
+
+#endif // FAKE_PROVIDER_H
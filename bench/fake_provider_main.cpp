@@ -0,0 +1,45 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include "bench_util.h"
+#include "fake_provider.h"
+
+namespace {
+std::atomic<bool> g_stop{false};
+
+void onSignal(int) {
+    g_stop = true;
+}
+}
+
+int main(int argc, char** argv) {
+    const bench::Options options(argc, argv);
+    if (options.has("help")) {
+        std::cout << "用法: mytv_fake_provider [--port 18090] [--videos 20] [--pages 1] [--episodes 40]\n"
+                     "                          [--sources 2] [--content-bytes 2048] [--latency-ms 80]\n"
+                     "                          [--latency-p99-ms 600] [--error-rate 0] [--drip-rate 0]\n"
+                     "                          [--drip-bytes-per-second 32768] [--encoding identity|gzip|deflate]\n"
+                     "                          [--seed 1]\n"
+                     "站点地址: http://127.0.0.1:<port>/<站点名>/api.php/provide/vod\n";
+        return 0;
+    }
+
+    FakeProvider provider(bench::readProviderConfig(options, 18090));
+    if (!provider.start()) {
+        return 1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    provider.stop();
+    const FakeProvider::Counters counters = provider.counters();
+    std::cout << "requests=" << counters.requests << " errors=" << counters.errors
+              << " drips=" << counters.drips << " compressed=" << counters.compressed << " bytes=" << counters.bytesSent << std::endl;
+    return 0;
+}
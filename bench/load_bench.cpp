@@ -0,0 +1,483 @@
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <curl/curl.h>
+#include <nlohmann/json.hpp>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "fake_provider.h"
+#include "logger.h"
+
+// HTTP 压测：多个线程各自持有一个 keep-alive 连接，按配置的比例请求 mytv 的各个接口，
+// 按接口输出 RPS、延迟分位数和错误率，同时采样服务进程的 CPU 和 RSS。
+// 指定 --server 时在临时目录启动 mytv，上游指向进程内的模拟站点，全程只访问本机。
+namespace {
+constexpr auto kReadyTimeout = std::chrono::seconds(15);
+constexpr auto kStopTimeout = std::chrono::seconds(5);
+
+struct Route {
+    std::string name;
+    std::string path;
+    std::string body;        // 非空时以 POST 发送
+    double weight = 0.0;
+};
+
+struct RouteStats {
+    std::vector<double> latenciesMs;
+    std::size_t errors = 0;
+    std::size_t bytes = 0;
+};
+
+struct WorkerResult {
+    std::vector<RouteStats> routes;
+    long connections = 0;
+};
+
+struct ProcessSample {
+    bool ok = false;
+    double cpuSeconds = 0.0;
+    std::size_t rssBytes = 0;
+    int threads = 0;
+};
+
+struct ServerUsage {
+    std::size_t samples = 0;
+    double cpuPercentSum = 0.0;
+    double cpuPercentMax = 0.0;
+    double rssSum = 0.0;
+    std::size_t rssMax = 0;
+    int threadsMax = 0;
+};
+
+std::size_t discardBody(char*, std::size_t size, std::size_t count, void* userdata) {
+    *static_cast<std::size_t*>(userdata) += size * count;
+    return size * count;
+}
+
+std::string escapeQuery(CURL* curl, const std::string& value) {
+    char* escaped = curl_easy_escape(curl, value.c_str(), static_cast<int>(value.size()));
+    const std::string result = escaped ? escaped : "";
+    curl_free(escaped);
+    return result;
+}
+
+// POST /api/search 的请求体，关键词中的引号、反斜杠和控制字符按 JSON 转义
+std::string searchBody(const std::string& keyword, bool wait) {
+    nlohmann::json body = {{"keyword", keyword}};
+    if (wait) {
+        body["wait"] = true;
+    }
+    return body.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+}
+
+// "videos=60,front=30,search=10"，未知的接口名会被忽略
+std::vector<Route> parseMix(const std::string& mix, const std::string& keyword, const std::string& frontPath) {
+    CURL* curl = curl_easy_init();
+    const std::string escapedKeyword = escapeQuery(curl, keyword);
+    curl_easy_cleanup(curl);
+
+    const std::map<std::string, Route> known = {
+        {"videos", {"videos", "/api/videos", "", 0.0}},
+        {"front", {"front", "/front/" + frontPath, "", 0.0}},
+        {"search", {"search", "/api/search", searchBody(keyword, false), 0.0}},
+        {"local-search", {"local-search", "/api/local-search?q=" + escapedKeyword, "", 0.0}},
+        {"suggest", {"suggest", "/api/suggest?prefix=" + escapedKeyword, "", 0.0}}};
+
+    std::vector<Route> routes;
+    std::istringstream input(mix);
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        const std::size_t equals = item.find('=');
+        const auto it = known.find(item.substr(0, equals));
+        if (it == known.end()) {
+            std::cerr << "忽略未知接口: " << item << std::endl;
+            continue;
+        }
+
+        Route route = it->second;
+        route.weight = equals == std::string::npos ? 1.0 : std::atof(item.c_str() + equals + 1);
+        if (route.weight > 0.0) {
+            routes.push_back(route);
+        }
+    }
+    return routes;
+}
+
+// 单次请求，返回是否得到 2xx/3xx 响应
+bool performRequest(CURL* curl, const std::string& baseUrl, const Route& route, long timeoutMs, std::size_t& bytes) {
+    const std::string url = baseUrl + route.path;
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeoutMs);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, discardBody);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &bytes);
+    if (route.body.empty()) {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, route.body.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(route.body.size()));
+    }
+
+    if (curl_easy_perform(curl) != CURLE_OK) {
+        return false;
+    }
+    long status = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+    return status >= 200 && status < 400;
+}
+
+void runWorker(const std::string& baseUrl,
+               const std::vector<Route>& routes,
+               long timeoutMs,
+               unsigned seed,
+               const std::atomic<bool>& recording,
+               const std::atomic<bool>& stopping,
+               WorkerResult& result) {
+    std::vector<double> weights;
+    for (const auto& route : routes) {
+        weights.push_back(route.weight);
+    }
+    std::mt19937 random(seed);
+    std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+    result.routes.assign(routes.size(), RouteStats());
+
+    // 同一个句柄复用连接，相当于浏览器的 keep-alive
+    CURL* curl = curl_easy_init();
+    struct curl_slist* headers = curl_slist_append(nullptr, "Content-Type: application/json");
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    while (!stopping) {
+        const std::size_t index = pick(random);
+        std::size_t bytes = 0;
+        const auto start = std::chrono::steady_clock::now();
+        const bool ok = performRequest(curl, baseUrl, routes[index], timeoutMs, bytes);
+        const double latencyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        // 新建连接数，keep-alive 生效时只在首次请求或服务端断开后增加
+        long connections = 0;
+        curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connections);
+        result.connections += connections;
+
+        if (recording) {
+            RouteStats& stats = result.routes[index];
+            stats.latenciesMs.push_back(latencyMs);
+            stats.bytes += bytes;
+            if (!ok) {
+                stats.errors++;
+            }
+        }
+    }
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+}
+
+// /proc/<pid>/stat 的 utime、stime 和 /proc/<pid>/status 的 VmRSS、Threads
+ProcessSample readProcess(pid_t pid) {
+    ProcessSample sample;
+    std::ifstream statFile("/proc/" + std::to_string(pid) + "/stat");
+    std::string stat((std::istreambuf_iterator<char>(statFile)), std::istreambuf_iterator<char>());
+    const std::size_t commEnd = stat.rfind(')');
+    if (commEnd == std::string::npos) {
+        return sample;
+    }
+
+    // ')' 之后第 1 个字段是 state（总第 3 个），utime 和 stime 是总第 14、15 个
+    std::istringstream fields(stat.substr(commEnd + 1));
+    std::string field;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    for (int index = 3; index <= 15 && fields >> field; ++index) {
+        if (index == 14) {
+            utime = std::stoull(field);
+        } else if (index == 15) {
+            stime = std::stoull(field);
+        }
+    }
+    sample.cpuSeconds = static_cast<double>(utime + stime) / static_cast<double>(sysconf(_SC_CLK_TCK));
+
+    std::ifstream statusFile("/proc/" + std::to_string(pid) + "/status");
+    std::string line;
+    while (std::getline(statusFile, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            sample.rssBytes = std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+        } else if (line.rfind("Threads:", 0) == 0) {
+            sample.threads = std::atoi(line.c_str() + 8);
+        }
+    }
+    sample.ok = true;
+    return sample;
+}
+
+void sampleServer(pid_t pid, std::chrono::milliseconds interval, const std::atomic<bool>& stopping, ServerUsage& usage) {
+    ProcessSample previous = readProcess(pid);
+    auto previousTime = std::chrono::steady_clock::now();
+    while (!stopping && previous.ok) {
+        std::this_thread::sleep_for(interval);
+        const ProcessSample current = readProcess(pid);
+        const auto now = std::chrono::steady_clock::now();
+        if (!current.ok) {
+            break;
+        }
+
+        const double wallSeconds = std::chrono::duration<double>(now - previousTime).count();
+        const double cpuPercent = wallSeconds > 0.0 ? (current.cpuSeconds - previous.cpuSeconds) / wallSeconds * 100.0 : 0.0;
+        usage.samples++;
+        usage.cpuPercentSum += cpuPercent;
+        usage.cpuPercentMax = std::max(usage.cpuPercentMax, cpuPercent);
+        usage.rssSum += static_cast<double>(current.rssBytes);
+        usage.rssMax = std::max(usage.rssMax, current.rssBytes);
+        usage.threadsMax = std::max(usage.threadsMax, current.threads);
+        previous = current;
+        previousTime = now;
+    }
+}
+
+// 在 workDir/build 下启动 mytv，目录结构与正式部署相同，输出写入 workDir/mytv.log
+pid_t spawnServer(const std::string& binary,
+                  const std::filesystem::path& workDir,
+                  const std::vector<std::pair<std::string, std::string>>& environment) {
+    const std::string logFile = (workDir / "mytv.log").string();
+    const std::string buildDir = (workDir / "build").string();
+    const pid_t pid = fork();
+    if (pid != 0) {
+        return pid;
+    }
+
+    const int fd = ::open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        ::close(fd);
+    }
+    for (const auto& [name, value] : environment) {
+        setenv(name.c_str(), value.c_str(), 1);
+    }
+    if (chdir(buildDir.c_str()) == 0) {
+        execl(binary.c_str(), binary.c_str(), static_cast<char*>(nullptr));
+    }
+    _exit(127);
+}
+
+void stopServer(pid_t pid) {
+    kill(pid, SIGTERM);
+    const auto deadline = std::chrono::steady_clock::now() + kStopTimeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (waitpid(pid, nullptr, WNOHANG) == pid) {
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, nullptr, 0);
+}
+
+bool waitUntilReady(const std::string& baseUrl, pid_t pid) {
+    const Route probe{"videos", "/api/videos", "", 1.0};
+    CURL* curl = curl_easy_init();
+    const auto deadline = std::chrono::steady_clock::now() + kReadyTimeout;
+    bool ready = false;
+    while (!ready && std::chrono::steady_clock::now() < deadline) {
+        if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid) {
+            break;
+        }
+        std::size_t bytes = 0;
+        ready = performRequest(curl, baseUrl, probe, 1000, bytes);
+        if (!ready) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    curl_easy_cleanup(curl);
+    return ready;
+}
+
+void printUsage() {
+    std::cout << "用法: mytv_load_bench [--server build/mytv] [--port 18080] [--url http://127.0.0.1:8080] [--pid <pid>]\n"
+                 "                       [--mix videos=60,front=30,search=10] [--concurrency 16]\n"
+                 "                       [--duration 10] [--warmup 2] [--timeout-ms 30000] [--keyword 测试]\n"
+                 "                       [--front-path index.html] [--sample-ms 250] [--prime] [--keep]\n"
+                 "可用接口: videos, front, search, local-search, suggest。\n"
+                 "--server 在临时目录启动 mytv 并提供模拟站点（参数与 mytv_fake_provider 相同，--providers 默认 10），\n"
+                 "压测前先搜索一次填充目录；否则压测 --url 指定的服务，--pid 用于采样 CPU 和 RSS，\n"
+                 "--prime 同样先搜索一次（会替换该服务当前的目录）。\n";
+}
+}
+
+int main(int argc, char** argv) {
+    const bench::Options options(argc, argv);
+    if (options.has("help")) {
+        printUsage();
+        return 0;
+    }
+
+    logger::setInfoEnabled(options.has("verbose"));
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    const std::string keyword = options.getString("keyword", "测试");
+    const std::vector<Route> routes = parseMix(options.getString("mix", "videos=60,front=30,search=10"),
+                                               keyword, options.getString("front-path", "index.html"));
+    if (routes.empty()) {
+        std::cerr << "--mix 中没有可用的接口" << std::endl;
+        return 1;
+    }
+
+    const std::size_t concurrency = static_cast<std::size_t>(std::max<long long>(1, options.getInt("concurrency", 16)));
+    const long timeoutMs = static_cast<long>(options.getInt("timeout-ms", 30000));
+    const bool spawn = options.has("server");
+
+    FakeProvider provider(bench::readProviderConfig(options, 0));
+    std::filesystem::path workDir;
+    std::string baseUrl = options.getString("url", "http://127.0.0.1:8080");
+    pid_t serverPid = static_cast<pid_t>(options.getInt("pid", 0));
+
+    if (spawn) {
+        workDir = bench::makeTempDir("mytv-load-bench");
+        for (const char* dir : {"build", "input", "output", "cache"}) {
+            std::filesystem::create_directories(workDir / dir);
+        }
+
+        std::error_code ec;
+        std::filesystem::create_directory_symlink(std::filesystem::absolute(options.getString("front", MYTV_FRONT_DIR)), workDir / "front", ec);
+        const std::size_t providers = static_cast<std::size_t>(options.getInt("providers", 10));
+        if (ec || !provider.start() ||
+            !bench::writeSourceConfig(workDir / "input" / "source.json", providers, provider.port(), options.has("single-host"))) {
+            std::cerr << "无法准备 mytv 工作目录或启动模拟站点" << std::endl;
+            return 1;
+        }
+
+        const std::string port = std::to_string(options.getInt("port", 18080));
+        baseUrl = "http://127.0.0.1:" + port;
+        serverPid = spawnServer(std::filesystem::absolute(options.getString("server", "")).string(), workDir, {
+            {"MYTV_PORT", port},
+            {"MYTV_PROVIDER_REQUESTS_PER_MINUTE", options.getString("rate-per-minute", "600000")},
+            {"MYTV_PROVIDER_BURST", options.getString("burst", "1000")}});
+        if (serverPid < 0) {
+            std::cerr << "无法启动 mytv" << std::endl;
+            return 1;
+        }
+    }
+
+    int exitCode = 0;
+    if (!waitUntilReady(baseUrl, serverPid)) {
+        std::cerr << "服务未就绪: " << baseUrl << std::endl;
+        exitCode = 1;
+    } else {
+        // 先搜索一次，/api/videos 和本地检索才有数据
+        if (spawn || options.has("prime")) {
+            CURL* curl = curl_easy_init();
+            std::size_t bytes = 0;
+            const Route prime{"search", "/api/search", searchBody(keyword, true), 1.0};
+            if (!performRequest(curl, baseUrl, prime, timeoutMs, bytes)) {
+                std::cerr << "预热搜索失败，/api/videos 可能为空" << std::endl;
+            }
+            curl_easy_cleanup(curl);
+        }
+
+        std::atomic<bool> recording{false};
+        std::atomic<bool> stopping{false};
+        std::vector<WorkerResult> results(concurrency);
+        std::vector<std::thread> workers;
+        for (std::size_t i = 0; i < concurrency; ++i) {
+            workers.emplace_back(runWorker, std::cref(baseUrl), std::cref(routes), timeoutMs,
+                                 static_cast<unsigned>(i + 1), std::cref(recording), std::cref(stopping), std::ref(results[i]));
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(options.getDouble("warmup", 2.0) * 1000.0)));
+
+        std::atomic<bool> samplingDone{false};
+        ServerUsage usage;
+        std::thread sampler;
+        if (serverPid > 0) {
+            sampler = std::thread(sampleServer, serverPid, std::chrono::milliseconds(options.getInt("sample-ms", 250)),
+                                  std::cref(samplingDone), std::ref(usage));
+        }
+
+        recording = true;
+        const auto start = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<long long>(options.getDouble("duration", 10.0) * 1000.0)));
+        recording = false;
+        const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        samplingDone = true;
+        stopping = true;
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (sampler.joinable()) {
+            sampler.join();
+        }
+
+        std::cout << std::left << std::setw(14) << "route"
+                  << std::right << std::setw(10) << "requests" << std::setw(8) << "errors" << std::setw(8) << "err%"
+                  << std::setw(10) << "rps" << std::setw(10) << "p50ms" << std::setw(10) << "p95ms"
+                  << std::setw(10) << "p99ms" << std::setw(10) << "maxms" << std::setw(10) << "MB" << "\n";
+
+        std::size_t totalRequests = 0;
+        std::size_t totalErrors = 0;
+        long connections = 0;
+        for (std::size_t r = 0; r < routes.size(); ++r) {
+            RouteStats merged;
+            for (const auto& result : results) {
+                const RouteStats& stats = result.routes[r];
+                merged.latenciesMs.insert(merged.latenciesMs.end(), stats.latenciesMs.begin(), stats.latenciesMs.end());
+                merged.errors += stats.errors;
+                merged.bytes += stats.bytes;
+            }
+
+            const bench::LatencySummary summary = bench::summarize(merged.latenciesMs);
+            totalRequests += summary.count;
+            totalErrors += merged.errors;
+            std::cout << std::left << std::setw(14) << routes[r].name << std::right << std::fixed
+                      << std::setw(10) << summary.count
+                      << std::setw(8) << merged.errors
+                      << std::setprecision(2) << std::setw(8)
+                      << (summary.count > 0 ? 100.0 * static_cast<double>(merged.errors) / static_cast<double>(summary.count) : 0.0)
+                      << std::setprecision(1) << std::setw(10) << static_cast<double>(summary.count) / elapsedSeconds
+                      << std::setprecision(2) << std::setw(10) << summary.p50Ms << std::setw(10) << summary.p95Ms
+                      << std::setw(10) << summary.p99Ms << std::setw(10) << summary.maxMs
+                      << std::setprecision(1) << std::setw(10) << static_cast<double>(merged.bytes) / (1024.0 * 1024.0) << "\n";
+        }
+        for (const auto& result : results) {
+            connections += result.connections;
+        }
+
+        std::cout << std::setprecision(1)
+                  << "total: requests=" << totalRequests << " errors=" << totalErrors
+                  << " rps=" << static_cast<double>(totalRequests) / elapsedSeconds
+                  << " duration=" << elapsedSeconds << "s concurrency=" << concurrency
+                  << " connections=" << connections << "\n";
+        if (usage.samples > 0) {
+            std::cout << "server: cpu avg=" << usage.cpuPercentSum / static_cast<double>(usage.samples)
+                      << "% max=" << usage.cpuPercentMax
+                      << "% rss avg=" << usage.rssSum / static_cast<double>(usage.samples) / (1024.0 * 1024.0)
+                      << "MB max=" << static_cast<double>(usage.rssMax) / (1024.0 * 1024.0)
+                      << "MB threads=" << usage.threadsMax << " samples=" << usage.samples << "\n";
+        }
+        if (totalRequests > 0 && totalErrors == totalRequests) {
+            exitCode = 1;
+        }
+    }
+
+    if (spawn) {
+        stopServer(serverPid);
+        provider.stop();
+        if (options.has("keep")) {
+            std::cout << "工作目录: " << workDir << std::endl;
+        } else {
+            std::error_code ec;
+            std::filesystem::remove_all(workDir, ec);
+        }
+    }
+    curl_global_cleanup();
+    return exitCode;
+}
@@ -0,0 +1,321 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "fake_provider.h"
+#include "gzip_stream.h"
+#include "json_parser.h"
+#include "logger.h"
+#include "video_catalog.h"
+
+// 解析与目录构建的微基准：用模拟站点的响应生成不同规模的语料，
+// 对缓存文件解析、播放地址拆分、目录合并和 JSON 序列化分别计时，
+// 输出每次操作的耗时、吞吐量和内存分配次数。
+namespace {
+std::atomic<std::size_t> gAllocations{0};
+std::atomic<std::size_t> gAllocatedBytes{0};
+
+void* countedAlloc(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+}
+
+// 替换全局分配函数，统计被测代码的分配次数和字节数
+void* operator new(std::size_t size) {
+    return countedAlloc(size);
+}
+
+void* operator new[](std::size_t size) {
+    return countedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+using catalog::kTitleMergeThreshold;
+using catalog::VideoCatalog;
+
+struct Corpus {
+    std::string label;
+    std::size_t videos = 0;
+    std::filesystem::path jsonFile;
+    std::filesystem::path gzipFile;
+    std::size_t jsonBytes = 0;
+    std::vector<std::string> playUrls;       // 单个播放源的 "第1集$url#..." 字符串
+    std::vector<std::string> playUrlGroups;  // 以 $$$ 分隔的完整 vod_play_url
+    std::size_t playUrlBytes = 0;
+    std::size_t playUrlGroupBytes = 0;
+    VideoCatalog unmerged;                   // 多个站点按原始标题分组
+    VideoCatalog merged;
+};
+
+struct BenchResult {
+    std::size_t iterations = 0;
+    double nsPerOp = 0.0;
+    double mbPerSecond = 0.0;
+    double allocationsPerOp = 0.0;
+    double allocatedBytesPerOp = 0.0;
+};
+
+// 反复执行直到累计耗时达到 minTime；setup 不计入耗时和分配统计
+BenchResult runBench(std::chrono::nanoseconds minTime,
+                     std::size_t bytesPerOp,
+                     const std::function<void()>& setup,
+                     const std::function<void()>& operation) {
+    std::chrono::nanoseconds elapsed{0};
+    std::size_t iterations = 0;
+    std::size_t allocations = 0;
+    std::size_t allocatedBytes = 0;
+
+    while (elapsed < minTime || iterations == 0) {
+        if (setup) {
+            setup();
+        }
+        const std::size_t allocationsBefore = gAllocations.load(std::memory_order_relaxed);
+        const std::size_t bytesBefore = gAllocatedBytes.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        operation();
+        elapsed += std::chrono::steady_clock::now() - start;
+        allocations += gAllocations.load(std::memory_order_relaxed) - allocationsBefore;
+        allocatedBytes += gAllocatedBytes.load(std::memory_order_relaxed) - bytesBefore;
+        iterations++;
+    }
+
+    BenchResult result;
+    result.iterations = iterations;
+    result.nsPerOp = static_cast<double>(elapsed.count()) / static_cast<double>(iterations);
+    result.mbPerSecond = result.nsPerOp > 0.0 ? static_cast<double>(bytesPerOp) * 1000.0 / result.nsPerOp : 0.0;
+    result.allocationsPerOp = static_cast<double>(allocations) / static_cast<double>(iterations);
+    result.allocatedBytesPerOp = static_cast<double>(allocatedBytes) / static_cast<double>(iterations);
+    return result;
+}
+
+std::size_t totalVideos(const VideoCatalog& videoCatalog) {
+    std::size_t count = 0;
+    for (const auto& [name, videos] : videoCatalog) {
+        count += videos.size();
+    }
+    return count;
+}
+
+// 每个规模生成一个站点的缓存文件（明文和 gzip 各一份），以及多个站点的未合并目录
+bool buildCorpus(const FakeProviderConfig& base,
+                 std::size_t videos,
+                 std::size_t providers,
+                 const std::filesystem::path& dir,
+                 Corpus& corpus) {
+    FakeProviderConfig config = base;
+    config.videosPerPage = videos;
+    config.pageCount = 1;
+
+    corpus.label = std::to_string(videos);
+    corpus.videos = videos;
+    corpus.jsonFile = dir / ("corpus_" + corpus.label + ".json");
+    corpus.gzipFile = dir / ("corpus_" + corpus.label + ".json.gz");
+
+    JsonParser parser;
+    for (std::size_t p = 0; p < providers; ++p) {
+        const std::string provider = "p" + std::to_string(p + 1);
+        const std::string payload = FakeProvider::makePayload(config, provider, "测试", 1);
+        const std::filesystem::path file = p == 0 ? corpus.jsonFile : dir / (provider + "_" + corpus.label + ".json");
+        std::ofstream(file, std::ios::binary) << payload;
+
+        if (p == 0) {
+            std::string compressed;
+            if (!gzip::compress(payload, compressed)) {
+                return false;
+            }
+            std::ofstream(corpus.gzipFile, std::ios::binary) << compressed;
+            corpus.jsonBytes = payload.size();
+
+            const json data = json::parse(payload);
+            for (const auto& item : data.at("list")) {
+                const std::string playUrl = item.value("vod_play_url", "");
+                corpus.playUrlGroups.push_back(playUrl);
+                corpus.playUrlGroupBytes += playUrl.size();
+                for (auto& group : JsonParser::splitString(playUrl, "$$$")) {
+                    corpus.playUrlBytes += group.size();
+                    corpus.playUrls.push_back(std::move(group));
+                }
+            }
+        }
+
+        if (!parser.parseFromFile(file.string())) {
+            return false;
+        }
+        for (auto& video : parser.getVideoListWithStats().videos) {
+            corpus.unmerged[video.vod_name].push_back(std::move(video));
+        }
+    }
+
+    corpus.merged = corpus.unmerged;
+    catalog::mergeEquivalentTitles(corpus.merged, kTitleMergeThreshold);
+    return true;
+}
+
+void printHeader() {
+    std::cout << std::left << std::setw(24) << "benchmark"
+              << std::right << std::setw(8) << "videos"
+              << std::setw(10) << "iters"
+              << std::setw(16) << "ns/op"
+              << std::setw(12) << "MB/s"
+              << std::setw(14) << "allocs/op"
+              << std::setw(16) << "alloc B/op" << "\n";
+}
+
+void printResult(const std::string& name, const std::string& label, const BenchResult& result) {
+    std::cout << std::left << std::setw(24) << name
+              << std::right << std::setw(8) << label
+              << std::setw(10) << result.iterations
+              << std::fixed << std::setprecision(0) << std::setw(16) << result.nsPerOp
+              << std::setprecision(1) << std::setw(12);
+    // 没有对应输入字节数的基准不输出吞吐量
+    if (result.mbPerSecond > 0.0) {
+        std::cout << result.mbPerSecond;
+    } else {
+        std::cout << "-";
+    }
+    std::cout << std::setw(14) << result.allocationsPerOp
+              << std::setprecision(0) << std::setw(16) << result.allocatedBytesPerOp << "\n";
+}
+
+std::vector<std::size_t> parseSizes(const std::string& value) {
+    std::vector<std::size_t> sizes;
+    std::istringstream input(value);
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        try {
+            const unsigned long size = std::stoul(item);
+            if (size > 0) {
+                sizes.push_back(size);
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    return sizes;
+}
+
+void printUsage() {
+    std::cout << "用法: mytv_bench [--sizes 20,200,2000] [--providers 8] [--min-time-ms 500] [--filter 名称]\n"
+                 "                  [--episodes 40] [--sources 2] [--content-bytes 2048] [--keep]\n"
+                 "--sizes 为每个语料中单个站点的视频数，--providers 为构建目录时模拟的站点数，\n"
+                 "--filter 只运行名称包含该子串的基准。\n";
+}
+}
+
+int main(int argc, char** argv) {
+    const bench::Options options(argc, argv);
+    if (options.has("help")) {
+        printUsage();
+        return 0;
+    }
+
+    logger::setInfoEnabled(options.has("verbose"));
+    const std::vector<std::size_t> sizes = parseSizes(options.getString("sizes", "20,200,2000"));
+    const std::size_t providers = static_cast<std::size_t>(std::max<long long>(1, options.getInt("providers", 8)));
+    const std::chrono::nanoseconds minTime = std::chrono::milliseconds(options.getInt("min-time-ms", 500));
+    const std::string filter = options.getString("filter", "");
+    const FakeProviderConfig base = bench::readProviderConfig(options, 0);
+    const std::filesystem::path workDir = bench::makeTempDir("mytv-bench");
+
+    printHeader();
+    for (const std::size_t size : sizes) {
+        Corpus corpus;
+        if (!buildCorpus(base, size, providers, workDir, corpus)) {
+            std::cerr << "无法生成语料: videos=" << size << std::endl;
+            return 1;
+        }
+
+        const auto run = [&](const std::string& name,
+                             std::size_t bytesPerOp,
+                             const std::function<void()>& setup,
+                             const std::function<void()>& operation) {
+            if (!filter.empty() && name.find(filter) == std::string::npos) {
+                return;
+            }
+            printResult(name, corpus.label, runBench(minTime, bytesPerOp, setup, operation));
+        };
+
+        JsonParser parser;
+        run("parseFromFile", corpus.jsonBytes, nullptr, [&]() {
+            parser.parseFromFile(corpus.jsonFile.string());
+        });
+        run("parseFromFile.gz", corpus.jsonBytes, nullptr, [&]() {
+            parser.parseFromFile(corpus.gzipFile.string());
+        });
+
+        parser.parseFromFile(corpus.jsonFile.string());
+        run("getVideoListWithStats", corpus.jsonBytes, nullptr, [&]() {
+            const VideoParseResult result = parser.getVideoListWithStats();
+            (void)result;
+        });
+
+        run("parsePlayUrls", corpus.playUrlBytes, nullptr, [&]() {
+            for (const auto& playUrl : corpus.playUrls) {
+                const auto urls = JsonParser::parsePlayUrls(playUrl);
+                (void)urls;
+            }
+        });
+        run("splitString", corpus.playUrlGroupBytes, nullptr, [&]() {
+            for (const auto& playUrl : corpus.playUrlGroups) {
+                const auto groups = JsonParser::splitString(playUrl, "$$$");
+                (void)groups;
+            }
+        });
+
+        // 合并会移动视频数据，每次在计时外复制一份未合并的目录
+        VideoCatalog working;
+        run("mergeEquivalentTitles", 0, [&]() { working = corpus.unmerged; }, [&]() {
+            catalog::mergeEquivalentTitles(working, kTitleMergeThreshold);
+        });
+
+        const std::string catalogJson = catalog::toCatalogJson(corpus.merged).dump();
+        run("toCatalogJson", catalogJson.size(), nullptr, [&]() {
+            const crow::json::wvalue value = catalog::toCatalogJson(corpus.merged);
+            (void)value;
+        });
+        run("toCatalogJson+dump", catalogJson.size(), nullptr, [&]() {
+            const std::string body = catalog::toCatalogJson(corpus.merged).dump();
+            (void)body;
+        });
+
+        std::cout << "  corpus " << corpus.label << ": file=" << corpus.jsonBytes << "B"
+                  << " catalog=" << corpus.merged.size() << " titles/" << totalVideos(corpus.merged) << " videos"
+                  << " from " << providers << " providers, json=" << catalogJson.size() << "B\n";
+    }
+
+    if (options.has("keep")) {
+        std::cout << "工作目录: " << workDir << std::endl;
+    } else {
+        std::error_code ec;
+        std::filesystem::remove_all(workDir, ec);
+    }
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bench_util.h"
+#include "fake_provider.h"
+#include "http_trace.h"
+#include "logger.h"
+#include "web_server.h"
+
+// 端到端搜索基准：启动本地模拟站点，生成 source.json，在进程内重复调用 WebServer::search，
+// 输出搜索延迟分位数和吞吐量。也可以录制上游响应，之后不访问网络按原始耗时回放。
+namespace {
+void printUsage() {
+    std::cout << "用法: mytv_search_bench [--providers 35] [--searches 20] [--warmup 2] [--keyword 测试]\n"
+                 "                         [--rate-per-minute 6000] [--burst 100] [--retries 3]\n"
+                 "                         [--max-concurrency 32] [--per-host 2] [--single-host]\n"
+                 "                         [--source source.json] [--record trace.jsonl]\n"
+                 "                         [--replay trace.jsonl] [--trace-speed 1.0] [--videolist] [--keep] [--verbose]\n"
+                 "                         [--check]\n"
+                 "模拟站点参数与 mytv_fake_provider 相同（--videos、--latency-ms、--error-rate、--encoding 等），\n"
+                 "--port 默认 0（自动分配）。指定 --source 时使用该站点配置而不启动模拟站点。\n"
+                 "--videolist 关闭两阶段搜索，直接请求 ac=videolist 的完整结果，用于对比传输量。\n"
+                 "--record 同时把站点配置保存为 <文件>.source.json，--replay 默认读取它；\n"
+                 "回放 MYTV_HTTP_TRACE=record:<文件> 录制的真实流量时用 --source 指定当时的 source.json。\n"
+                 "--check 在结束时校验：目录非空（响应体已解码并解析），每个站点都记录了传输量，\n"
+                 "且内容编码与 --encoding 一致、网络字节数小于解码后字节数；不满足时返回 1。\n";
+}
+
+// 校验压缩传输的完整链路：模拟站点按 encoding 压缩，客户端解码后解析进目录并记录传输量
+bool checkTransfers(WebServer& server, const FakeProvider::Counters& counters, const std::string& encoding, std::size_t providers) {
+    bool ok = true;
+    const auto fail = [&ok](const std::string& message) {
+        std::cerr << "check failed: " << message << std::endl;
+        ok = false;
+    };
+
+    std::size_t titles = 0;
+    std::size_t sources = 0;
+    for (const auto& [title, videos] : server.getVideoList()) {
+        titles++;
+        sources += videos.size();
+    }
+    if (titles == 0) {
+        fail("catalog is empty, responses were not decoded or parsed");
+    }
+
+    const bool compressed = encoding == "gzip" || encoding == "deflate";
+    if (compressed && counters.compressed == 0) {
+        fail("provider sent no " + encoding + " responses");
+    }
+
+    const auto transfers = server.getTransferStats();
+    if (transfers.size() != providers) {
+        fail("transfer stats recorded for " + std::to_string(transfers.size()) + " of " + std::to_string(providers) + " providers");
+    }
+    for (const auto& [domain, transfer] : transfers) {
+        if (transfer.responses == 0 || transfer.wireBytes == 0 || transfer.bodyBytes == 0) {
+            fail(domain + ": byte counters not recorded");
+            continue;
+        }
+        if (compressed) {
+            if (transfer.compressedResponses != transfer.responses || transfer.lastEncoding != encoding) {
+                fail(domain + ": expected every response encoded as " + encoding + ", got " +
+                     std::to_string(transfer.compressedResponses) + "/" + std::to_string(transfer.responses) +
+                     " (last " + (transfer.lastEncoding.empty() ? "identity" : transfer.lastEncoding) + ")");
+            }
+            if (transfer.wireBytes >= transfer.bodyBytes) {
+                fail(domain + ": wire bytes " + std::to_string(transfer.wireBytes) + " not below decoded bytes " + std::to_string(transfer.bodyBytes));
+            }
+        } else if (transfer.compressedResponses != 0 || transfer.wireBytes != transfer.bodyBytes) {
+            fail(domain + ": identity responses should have equal wire and decoded bytes");
+        }
+    }
+
+    std::cout << "check: titles=" << titles << " sources=" << sources
+              << " providers=" << transfers.size() << " encoding=" << encoding
+              << (ok ? " ok" : " FAILED") << std::endl;
+    return ok;
+}
+}
+
+int main(int argc, char** argv) {
+    const bench::Options options(argc, argv);
+    if (options.has("help")) {
+        printUsage();
+        return 0;
+    }
+
+    const std::size_t providers = static_cast<std::size_t>(options.getInt("providers", 35));
+    const int searches = static_cast<int>(options.getInt("searches", 20));
+    const int warmup = static_cast<int>(options.getInt("warmup", 2));
+    const std::string keyword = options.getString("keyword", "测试");
+    const bool singleHost = options.has("single-host");
+    logger::setInfoEnabled(options.has("verbose"));
+
+    const std::filesystem::path workDir = bench::makeTempDir("mytv-search-bench");
+    const std::filesystem::path inputDir = workDir / "input";
+    std::filesystem::create_directories(inputDir);
+
+    // 回放文件旁边保存了录制时的站点配置，回放时默认使用它，保证 URL 一致
+    std::string sourceFile = options.getString("source", "");
+    if (sourceFile.empty() && options.has("replay")) {
+        sourceFile = options.getString("replay", "") + ".source.json";
+    }
+
+    // 未指定站点配置时启动模拟站点
+    const bool useFakeProvider = sourceFile.empty();
+    FakeProvider provider(bench::readProviderConfig(options, 0));
+    if (useFakeProvider) {
+        if (!provider.start() || !bench::writeSourceConfig(inputDir / "source.json", providers, provider.port(), singleHost)) {
+            std::cerr << "无法启动模拟站点或写入站点配置" << std::endl;
+            return 1;
+        }
+    } else {
+        std::error_code ec;
+        std::filesystem::copy_file(sourceFile, inputDir / "source.json", ec);
+        if (ec) {
+            std::cerr << "无法复制站点配置: " << ec.message() << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.has("record")) {
+        const std::string traceFile = options.getString("record", "");
+        std::error_code ec;
+        std::filesystem::copy_file(inputDir / "source.json", traceFile + ".source.json",
+                                   std::filesystem::copy_options::overwrite_existing, ec);
+        if (ec || !HttpTrace::instance().open(HttpTrace::Mode::Record, traceFile)) {
+            std::cerr << "无法创建录制文件: " << traceFile << std::endl;
+            return 1;
+        }
+    } else if (options.has("replay") &&
+               !HttpTrace::instance().open(HttpTrace::Mode::Replay, options.getString("replay", ""), options.getDouble("trace-speed", 1.0))) {
+        return 1;
+    }
+
+    WebServer server;
+    server.setDataPaths(inputDir.string() + "/", (workDir / "output").string() + "/", (workDir / "cache").string() + "/");
+    server.setProviderRateLimit(options.getDouble("rate-per-minute", 6000.0) / 60.0, options.getDouble("burst", 100.0));
+    server.setSearchRetryAttempts(static_cast<int>(options.getInt("retries", 3)));
+    server.setTwoPhaseSearch(!options.has("videolist"));
+    server.setSearchConcurrency(static_cast<std::size_t>(options.getInt("max-concurrency", 32)),
+                                static_cast<std::size_t>(options.getInt("per-host", 2)));
+
+    for (int i = 0; i < warmup; ++i) {
+        server.search(keyword);
+    }
+
+    const FakeProvider::Counters before = provider.counters();
+    std::vector<double> latencies;
+    int failures = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < searches; ++i) {
+        const auto searchStart = std::chrono::steady_clock::now();
+        if (!server.search(keyword)) {
+            failures++;
+        }
+        latencies.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - searchStart).count());
+    }
+    const double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const FakeProvider::Counters after = provider.counters();
+    provider.stop();
+
+    bool checked = true;
+    if (options.has("check")) {
+        if (!useFakeProvider) {
+            std::cerr << "--check 需要使用模拟站点" << std::endl;
+            checked = false;
+        } else {
+            checked = checkTransfers(server, after, options.getString("encoding", "identity"), providers);
+        }
+    }
+
+    HttpTrace::instance().close();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "searches=" << searches << " failures=" << failures << "\n"
+              << "search latency: " << bench::formatSummary(bench::summarize(latencies)) << "\n"
+              << "throughput: " << (elapsedSeconds > 0.0 ? searches / elapsedSeconds : 0.0) << " searches/s\n";
+    if (useFakeProvider) {
+        const std::size_t requests = after.requests - before.requests;
+        std::cout << "provider: sites=" << providers
+                  << " requests=" << requests
+                  << " (" << (elapsedSeconds > 0.0 ? requests / elapsedSeconds : 0.0) << "/s)"
+                  << " errors=" << (after.errors - before.errors)
+                  << " drips=" << (after.drips - before.drips)
+                  << " compressed=" << (after.compressed - before.compressed)
+                  << " bytes=" << (after.bytesSent - before.bytesSent) << std::endl;
+    }
+
+    if (options.has("keep")) {
+        std::cout << "工作目录: " << workDir << std::endl;
+    } else {
+        std::error_code ec;
+        std::filesystem::remove_all(workDir, ec);
+    }
+    return failures == searches || !checked ? 1 : 0;
+}
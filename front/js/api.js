@@ -2,8 +2,12 @@
 const api = (function() {
     const PATHS = {
         videos: '/api/videos',
+        detail: '/api/detail',
         search: '/api/search',
-        update: '/api/update'
+        localSearch: '/api/local-search',
+        suggest: '/api/suggest',
+        update: '/api/update',
+        prefetch: '/proxy/hls/prefetch'
     };
 
     async function fetchVideoCatalog() {
@@ -17,23 +21,84 @@ const api = (function() {
         }
     }
 
-    async function searchByKeyword(keyword) {
+    // Search results only carry summaries; play URLs are filled in when a title is opened
+    async function fetchTitleDetail(title) {
+        const params = new URLSearchParams({ title });
+        const res = await fetch(`${PATHS.detail}?${params.toString()}`);
+        const data = await res.json();
+        if (!res.ok) throw new Error(data.message || 'Failed to load detail: ' + res.status);
+        return data.videos || [];
+    }
+
+    const SEARCH_POLL_MS = 600;
+
+    // Searches run as server-side jobs: start one, then poll its progress until it finishes
+    async function searchByKeyword(keyword, onProgress) {
         try {
             const res = await fetch(PATHS.search, {
                 method: 'POST',
                 headers: { 'Content-Type': 'application/json' },
                 body: JSON.stringify({ keyword })
             });
-            // Expect JSON response (backend updated to return JSON)
+            let job = await res.json();
+            if (!res.ok) throw new Error(job.message || 'Search failed');
+
+            while (job.state === 'queued' || job.state === 'running') {
+                if (onProgress) onProgress(job);
+                await new Promise(resolve => setTimeout(resolve, SEARCH_POLL_MS));
+                const poll = await fetch(`${PATHS.search}/${encodeURIComponent(job.id)}`);
+                job = await poll.json();
+                if (!poll.ok) throw new Error(job.message || 'Search status unavailable');
+            }
+            if (job.state !== 'completed') throw new Error(job.message || 'Search ' + job.state);
+            return job;
+        } catch (err) {
+            console.error('searchByKeyword error', err);
+            throw err;
+        }
+    }
+
+    // keepalive lets the request outlive a closing tab
+    function cancelSearch(id) {
+        return fetch(`${PATHS.search}/${encodeURIComponent(id)}`, { method: 'DELETE', keepalive: true })
+            .catch(err => console.warn('cancelSearch error', err));
+    }
+
+    async function localSearch(keyword, limit) {
+        try {
+            const params = new URLSearchParams({ q: keyword });
+            if (limit) params.set('limit', String(limit));
+            const res = await fetch(`${PATHS.localSearch}?${params.toString()}`);
             const data = await res.json();
-            if (!res.ok) throw new Error(data.message || 'Search failed');
+            if (!res.ok) throw new Error(data.message || 'Local search failed');
             return data;
         } catch (err) {
-            console.error('searchByKeyword error', err);
+            console.error('localSearch error', err);
             throw err;
         }
     }
 
+    async function fetchSuggestions(prefix) {
+        const params = new URLSearchParams({ prefix });
+        const res = await fetch(`${PATHS.suggest}?${params.toString()}`);
+        if (!res.ok) throw new Error('Failed to fetch suggestions: ' + res.status);
+        const data = await res.json();
+        return data.suggestions || [];
+    }
+
+    // Fire-and-forget: ask the server to warm the HLS cache for an upcoming episode
+    async function prefetchEpisode(url) {
+        try {
+            await fetch(PATHS.prefetch, {
+                method: 'POST',
+                headers: { 'Content-Type': 'application/json' },
+                body: JSON.stringify({ url })
+            });
+        } catch (err) {
+            console.warn('prefetchEpisode error', err);
+        }
+    }
+
     async function updateSites() {
         try {
             const res = await fetch(PATHS.update, {
@@ -50,7 +115,12 @@ const api = (function() {
 
     return {
         fetchVideoCatalog,
+        fetchTitleDetail,
         searchByKeyword,
+        cancelSearch,
+        localSearch,
+        fetchSuggestions,
+        prefetchEpisode,
         updateSites
     };
 })();
@@ -10,6 +10,7 @@
         playerInstance: null,
         currentSourceLabel: '',
         isSearching: false,
+        searchJobId: null,
         isUpdatingSites: false
     };
 
@@ -30,10 +31,41 @@
         }
     }
 
-    function openTitle(title) {
+    function showLocalResults(keyword, hits) {
+        views.showTitleListView();
+        views.renderTitleList(state.catalog, openTitle, hits.map(hit => hit.title));
+        views.updateStatus(`本地缓存中找到 ${hits.length} 个与“${keyword}”相关的影片。`, 'success');
+    }
+
+    async function findLocalHits(keyword) {
+        try {
+            const res = await api.localSearch(keyword);
+            return res.hits || [];
+        } catch (err) {
+            console.warn('local search unavailable', err);
+            return [];
+        }
+    }
+
+    async function openTitle(title) {
         state.currentTitle = title;
         state.currentSources = state.catalog[title] || [];
-        views.updateStatus(`已打开 ${title}，可切换不同资源站。`, 'info');
+        let detailFailed = false;
+        if (state.currentSources.some(source => source.detail_loaded === false)) {
+            views.showSearchStatus(`正在加载 ${title} 的播放地址...`, 'info', { loading: true });
+            try {
+                state.catalog[title] = await api.fetchTitleDetail(title);
+                state.currentSources = state.catalog[title];
+                views.hideSearchStatus();
+            } catch (err) {
+                console.warn('fetchTitleDetail error', err);
+                detailFailed = true;
+                views.updateStatus(`加载播放地址失败: ${err.message || err}`, 'warning');
+            }
+            // ignore the result if another title was opened meanwhile
+            if (state.currentTitle !== title) return;
+        }
+        if (!detailFailed) views.updateStatus(`已打开 ${title}，可切换不同资源站。`, 'info');
         // show view
         views.showSourceView();
         // render tabs and default content
@@ -97,9 +129,43 @@
         );
         views.updateStatus(`开始播放：${title || state.currentTitle || '未命名剧集'}`, 'success');
         playerModule.setDocumentTitle(title || (state.currentTitle || ''));
+        prefetchNextEpisode(idx);
+    }
+
+    function prefetchNextEpisode(idx) {
+        const next = state.currentPlaylist[idx + 1];
+        if (!next || !next.url) return;
+        if (playerModule.detectVideoType(next.url) !== 'm3u8') return;
+        api.prefetchEpisode(next.url);
+    }
+
+    let suggestTimer = null;
+    let suggestRequestId = 0;
+
+    function scheduleSuggestions(prefix) {
+        if (suggestTimer) window.clearTimeout(suggestTimer);
+        suggestTimer = window.setTimeout(async () => {
+            suggestTimer = null;
+            const requestId = ++suggestRequestId;
+            if (!prefix) {
+                views.renderSuggestions([]);
+                return;
+            }
+            try {
+                const suggestions = await api.fetchSuggestions(prefix);
+                // ignore responses that arrive after a newer keystroke
+                if (requestId === suggestRequestId) views.renderSuggestions(suggestions);
+            } catch (err) {
+                console.warn('suggest error', err);
+            }
+        }, 120);
     }
 
     function bindUIEvents() {
+        document.getElementById('searchInput').addEventListener('input', (event) => {
+            scheduleSuggestions(event.target.value.trim());
+        });
+
         document.getElementById('backButton').addEventListener('click', () => {
             views.showTitleListView();
             views.updateStatus('已返回影片目录。', 'info');
@@ -114,8 +180,21 @@
                 await views.showAlert('请输入搜索关键词', '请先输入要搜索的影片、剧集或关键字。', 'warning');
                 return;
             }
-            const isConfirmed = await views.showConfirm('开始搜索', `确定要搜索“${keyword}”吗？\n这会刷新当前本地缓存结果。`, 'info');
-            if (!isConfirmed) return;
+            const localHits = await findLocalHits(keyword);
+            if (localHits.length > 0) {
+                const shouldRefresh = await views.showConfirm(
+                    '本地已有结果',
+                    `本地缓存中找到 ${localHits.length} 个与“${keyword}”相关的影片。\n继续将联网搜索并刷新缓存，取消则直接查看本地结果。`,
+                    'info'
+                );
+                if (!shouldRefresh) {
+                    showLocalResults(keyword, localHits);
+                    return;
+                }
+            } else {
+                const isConfirmed = await views.showConfirm('开始搜索', `确定要搜索“${keyword}”吗？\n这会刷新当前本地缓存结果。`, 'info');
+                if (!isConfirmed) return;
+            }
             try {
                 state.isSearching = true;
                 searchButton.disabled = true;
@@ -123,7 +202,12 @@
                 searchButton.textContent = '搜索中...';
                 views.updateStatus(`正在搜索“${keyword}”，这会刷新本地缓存。`, 'info');
                 views.showSearchStatus(`正在搜索“${keyword}”，正在刷新资源缓存...`, 'info', { loading: true });
-                const res = await api.searchByKeyword(keyword);
+                const res = await api.searchByKeyword(keyword, job => {
+                    state.searchJobId = job.id;
+                    if (job.sites_total > 0) {
+                        views.showSearchStatus(`正在搜索“${keyword}”，已完成 ${job.sites_done}/${job.sites_total} 个站点...`, 'info', { loading: true });
+                    }
+                });
                 views.hideSearchStatus();
                 views.updateStatus(res.message || '搜索成功，正在刷新目录。', 'success');
                 await refreshCatalog();
@@ -134,6 +218,7 @@
                 await views.showAlert('搜索失败', err.message || String(err), 'error');
             } finally {
                 state.isSearching = false;
+                state.searchJobId = null;
                 searchButton.disabled = false;
                 updateSitesButton.disabled = state.isUpdatingSites;
                 searchButton.textContent = '搜索视频';
@@ -171,6 +256,11 @@
         });
     }
 
+    // Closing or leaving the page stops the upstream requests of a running search
+    window.addEventListener('pagehide', () => {
+        if (state.searchJobId) api.cancelSearch(state.searchJobId);
+    });
+
     document.addEventListener('DOMContentLoaded', () => {
         views.togglePlayerEmpty(true);
         views.updatePlayerMeta();
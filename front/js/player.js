@@ -10,6 +10,13 @@ const playerModule = (function() {
         return 'unknown';
     }
 
+    // Route provider m3u8 playlists through the backend HLS proxy so segments
+    // are cached server-side and shared between viewers (also avoids CORS issues)
+    function toPlaybackUrl(url) {
+        if (!url || !url.includes('.m3u8') || !/^https?:\/\//i.test(url)) return url;
+        return `/proxy/hls?url=${encodeURIComponent(url)}`;
+    }
+
     function createPlayer(containerSelector, url, options = {}) {
         // destroy existing
         if (artPlayerInstance) {
@@ -27,7 +34,7 @@ const playerModule = (function() {
 
         artPlayerInstance = new Artplayer({
             container: containerSelector,
-            url: url,
+            url: toPlaybackUrl(url),
             type: detectVideoType(url),
             autoplay: true,
             volume: 0.7,
@@ -90,7 +97,8 @@ const playerModule = (function() {
         createPlayer,
         destroyPlayer,
         setDocumentTitle,
-        detectVideoType
+        detectVideoType,
+        toPlaybackUrl
     };
 })();
 
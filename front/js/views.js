@@ -22,11 +22,19 @@ const views = (function() {
             .trim();
     }
 
-    function renderTitleList(data, onSelect) {
+    // Posters go through the backend image cache as small thumbnails
+    function posterUrl(sources) {
+        const withPic = (sources || []).find(s => /^https?:\/\//i.test(s.vod_pic || ''));
+        if (!withPic) return '';
+        return `/img?src=${encodeURIComponent(withPic.vod_pic)}&w=320`;
+    }
+
+    function renderTitleList(data, onSelect, orderedTitles) {
         const videoList = document.getElementById('videoList');
         videoList.innerHTML = '';
 
-        const titles = Object.keys(data).sort();
+        // orderedTitles keeps ranking order from local search results
+        const titles = orderedTitles ? orderedTitles.filter(title => data[title]) : Object.keys(data).sort();
         if (titles.length === 0) {
             videoList.innerHTML = `
                 <div class="empty-state">
@@ -40,7 +48,9 @@ const views = (function() {
         titles.forEach(title => {
             const categoryItem = document.createElement('div');
             categoryItem.className = 'video-item';
+            const poster = posterUrl(data[title]);
             categoryItem.innerHTML = `
+                ${poster ? `<img class="video-poster" loading="lazy" alt="" src="${escapeHtml(poster)}">` : ''}
                 <div class="video-title">${escapeHtml(title)}</div>
                 <div class="video-info">包含 ${data[title].length} 个视频源</div>
                 <div class="video-badge">资源已缓存</div>
@@ -50,6 +60,17 @@ const views = (function() {
         });
     }
 
+    function renderSuggestions(suggestions) {
+        const list = document.getElementById('searchSuggestions');
+        if (!list) return;
+        list.innerHTML = '';
+        suggestions.forEach(text => {
+            const option = document.createElement('option');
+            option.value = text;
+            list.appendChild(option);
+        });
+    }
+
     function renderSourceTabs(sources, onChange) {
         const tabsContainer = document.getElementById('sourceTabs');
         tabsContainer.innerHTML = '';
@@ -57,6 +78,14 @@ const views = (function() {
             const tabButton = document.createElement('button');
             tabButton.className = 'tab-button' + (i === 0 ? ' active' : '');
             tabButton.textContent = s.source;
+            // health_score: -1 not probed yet, 0 probe failed, otherwise 1-100
+            const score = typeof s.health_score === 'number' ? s.health_score : -1;
+            if (score === 0) {
+                tabButton.classList.add('tab-button-unhealthy');
+                tabButton.title = '探测失败，可能无法播放';
+            } else if (score > 0) {
+                tabButton.title = `可用性评分 ${Math.round(score)}`;
+            }
             tabButton.onclick = () => {
                 tabsContainer.querySelectorAll('.tab-button').forEach(btn => btn.classList.remove('active'));
                 tabButton.classList.add('active');
@@ -301,6 +330,7 @@ const views = (function() {
 
     return {
         renderTitleList,
+        renderSuggestions,
         renderSourceTabs,
         renderSourceDetail,
         showTitleListView,
@@ -0,0 +1,224 @@
+#include "atomic_file_writer.h"
+#include <atomic>
+#include <cstdio>
+#include <utility>
+#include "logger.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr const char* kLogModule = "AtomicFileWriter";
+
+std::atomic<unsigned long long> g_tempFileSequence{0};
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+
+int currentProcessId() {
+#ifdef _WIN32
+    return _getpid();
+#else
+    return static_cast<int>(getpid());
+#endif
+}
+
+bool syncFileDescriptor(int fd) {
+#ifdef _WIN32
+    return _commit(fd) == 0;
+#else
+    return fsync(fd) == 0;
+#endif
+}
+
+// 对已存在的文件或目录执行 fsync；Windows 下目录无法同步，直接视为成功
+bool syncPath(const std::filesystem::path& path, bool isDirectory) {
+#ifdef _WIN32
+    if (isDirectory) {
+        return true;
+    }
+    std::FILE* file = std::fopen(path.string().c_str(), "rb+");
+    if (!file) {
+        return false;
+    }
+    const bool ok = syncFileDescriptor(_fileno(file));
+    std::fclose(file);
+    return ok;
+#else
+    const int flags = O_RDONLY | (isDirectory ? O_DIRECTORY : 0);
+    const int fd = open(path.c_str(), flags);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = syncFileDescriptor(fd);
+    close(fd);
+    return ok;
+#endif
+}
+
+std::filesystem::path directoryOf(const std::filesystem::path& target) {
+    const std::filesystem::path parent = target.parent_path();
+    return parent.empty() ? std::filesystem::path(".") : parent;
+}
+}
+
+AtomicFileWriter::AtomicFileWriter(SyncMode mode) : syncMode_(mode) {}
+
+AtomicFileWriter::~AtomicFileWriter() {
+    flush();
+}
+
+void AtomicFileWriter::setSyncMode(SyncMode mode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    syncMode_ = mode;
+}
+
+AtomicFileWriter::SyncMode AtomicFileWriter::getSyncMode() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return syncMode_;
+}
+
+std::filesystem::path AtomicFileWriter::makeTempPath(const std::filesystem::path& target) {
+    // 以 "." 开头且扩展名不是 .json，目录扫描时不会被当成缓存文件
+    const std::string tempName = "." + target.filename().string() + ".tmp." +
+                                 std::to_string(currentProcessId()) + "." +
+                                 std::to_string(g_tempFileSequence.fetch_add(1));
+    return directoryOf(target) / tempName;
+}
+
+bool AtomicFileWriter::write(const std::filesystem::path& target, const std::string& content) {
+    const SyncMode mode = getSyncMode();
+    const std::filesystem::path tempPath = makeTempPath(target);
+
+    std::FILE* file = std::fopen(tempPath.string().c_str(), "wb");
+    if (!file) {
+        logError("无法创建临时文件: ", tempPath);
+        return false;
+    }
+
+    bool ok = content.empty() || std::fwrite(content.data(), 1, content.size(), file) == content.size();
+    ok = std::fflush(file) == 0 && ok;
+    if (ok && mode == SyncMode::Immediate) {
+#ifdef _WIN32
+        ok = syncFileDescriptor(_fileno(file));
+#else
+        ok = syncFileDescriptor(fileno(file));
+#endif
+    }
+    ok = std::fclose(file) == 0 && ok;
+
+    std::error_code ec;
+    if (!ok) {
+        logError("写入临时文件失败: ", tempPath);
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    std::filesystem::rename(tempPath, target, ec);
+    if (ec) {
+        logError("替换目标文件失败: ", target, ", 错误: ", ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+
+    const std::filesystem::path dir = directoryOf(target);
+    if (mode == SyncMode::Immediate) {
+        if (!syncPath(dir, true)) {
+            logError("目录同步失败: ", dir);
+        }
+    } else if (mode == SyncMode::Batched) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingFiles_.insert(target);
+        pendingDirs_.insert(dir);
+    }
+
+    return true;
+}
+
+bool AtomicFileWriter::move(const std::filesystem::path& source, const std::filesystem::path& target) {
+    std::error_code ec;
+    std::filesystem::rename(source, target, ec);
+    if (ec) {
+        logError("移动文件失败: ", source, " -> ", target, ", 错误: ", ec.message());
+        return false;
+    }
+
+    const std::filesystem::path dir = directoryOf(target);
+    const SyncMode mode = getSyncMode();
+    if (mode == SyncMode::Immediate) {
+        if (!syncPath(dir, true)) {
+            logError("目录同步失败: ", dir);
+        }
+    } else if (mode == SyncMode::Batched) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pendingDirs_.insert(dir);
+    }
+    return true;
+}
+
+bool AtomicFileWriter::flush() {
+    std::set<std::filesystem::path> files;
+    std::set<std::filesystem::path> dirs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        files.swap(pendingFiles_);
+        dirs.swap(pendingDirs_);
+    }
+
+    bool ok = true;
+    for (const auto& file : files) {
+        // 文件可能已被后续清理删除，这种情况无需同步
+        std::error_code ec;
+        if (!std::filesystem::exists(file, ec)) {
+            continue;
+        }
+        if (!syncPath(file, false)) {
+            logError("文件同步失败: ", file);
+            ok = false;
+        }
+    }
+
+    for (const auto& dir : dirs) {
+        if (!syncPath(dir, true)) {
+            logError("目录同步失败: ", dir);
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+bool AtomicFileWriter::flushFile(const std::filesystem::path& target) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (pendingFiles_.erase(target) == 0) {
+            return true;
+        }
+    }
+
+    bool ok = true;
+    if (!syncPath(target, false)) {
+        logError("文件同步失败: ", target);
+        ok = false;
+    }
+    const std::filesystem::path dir = directoryOf(target);
+    if (!syncPath(dir, true)) {
+        logError("目录同步失败: ", dir);
+        ok = false;
+    }
+    return ok;
+}
+
+AtomicFileWriter::SyncMode AtomicFileWriter::parseSyncMode(const std::string& value, SyncMode fallback) {
+    if (value == "none") return SyncMode::None;
+    if (value == "always") return SyncMode::Immediate;
+    if (value == "batch") return SyncMode::Batched;
+    return fallback;
+}
@@ -0,0 +1,56 @@
+// atomic_file_writer.h
+#ifndef ATOMIC_FILE_WRITER_H
+#define ATOMIC_FILE_WRITER_H
+
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+
+// 原子文件写入：先写同目录下的临时文件，再 rename 覆盖目标文件，
+// 读取方只会看到旧文件或完整的新文件，不会读到写了一半的内容。
+class AtomicFileWriter {
+public:
+    enum class SyncMode {
+        None,       // 不调用 fsync，仅保证原子可见
+        Immediate,  // 每次写入后立即 fsync 文件和所在目录
+        Batched     // 记录待同步文件，调用 flush() 时统一 fsync
+    };
+
+    explicit AtomicFileWriter(SyncMode mode = SyncMode::None);
+    // 析构时会同步尚未 flush 的文件
+    ~AtomicFileWriter();
+
+    // 禁用拷贝和赋值
+    AtomicFileWriter(const AtomicFileWriter&) = delete;
+    AtomicFileWriter& operator=(const AtomicFileWriter&) = delete;
+
+    void setSyncMode(SyncMode mode);
+    SyncMode getSyncMode() const;
+
+    // 原子写入文件内容，可被多个线程并发调用
+    bool write(const std::filesystem::path& target, const std::string& content);
+
+    // 把已写好的文件 rename 到同一文件系统内的目标位置，目标所在目录按同步模式处理
+    bool move(const std::filesystem::path& source, const std::filesystem::path& target);
+
+    // 同步 Batched 模式下累积的文件和目录，返回是否全部成功
+    bool flush();
+
+    // 只同步指定文件及其所在目录（Batched 模式下尚未同步时），不影响其他待同步文件
+    bool flushFile(const std::filesystem::path& target);
+
+    // 解析 "none" / "always" / "batch"，无法识别时返回 fallback
+    static SyncMode parseSyncMode(const std::string& value, SyncMode fallback);
+
+private:
+    // 生成与目标文件同目录的唯一临时文件路径
+    std::filesystem::path makeTempPath(const std::filesystem::path& target);
+
+    std::set<std::filesystem::path> pendingFiles_;
+    std::set<std::filesystem::path> pendingDirs_;
+    mutable std::mutex mutex_;
+    SyncMode syncMode_;
+};
+
+#endif // ATOMIC_FILE_WRITER_H
@@ -0,0 +1,247 @@
+#include "catalog_search_index.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include "text_util.h"
+
+namespace {
+constexpr float kNameWeight = 3.0f;
+constexpr float kSubWeight = 2.0f;
+constexpr float kContentWeight = 1.0f;
+// 简介只索引开头部分，避免超长 HTML 简介撑大倒排表
+constexpr std::size_t kMaxContentCodePoints = 2000;
+constexpr std::size_t kMaxNameCodePoints = 256;
+// 标题中连续包含完整查询词时的加权系数
+constexpr double kExactTitleBonus = 1.5;
+
+std::string foldText(const std::string& value) {
+    return text::encodeUtf8(text::foldWidth(text::decodeUtf8(value)));
+}
+
+// 全角折叠后按空白和标点切段，对每段内相邻字符生成 bigram；
+// 只有一个字符的段落生成单字键，保证单字查询也能命中
+template <typename Callback>
+void forEachGram(const std::string& value, std::size_t maxCodePoints, bool withUnigrams, Callback&& callback) {
+    std::u32string folded = text::foldWidth(text::decodeUtf8(value));
+    if (folded.size() > maxCodePoints) {
+        folded.resize(maxCodePoints);
+    }
+
+    std::size_t segmentStart = 0;
+    for (std::size_t i = 0; i <= folded.size(); ++i) {
+        if (i < folded.size() && !text::isSpaceOrPunctuation(folded[i])) {
+            continue;
+        }
+
+        const std::size_t length = i - segmentStart;
+        if (length == 1) {
+            callback(text::makeBigram(folded[segmentStart], 0));
+        } else {
+            for (std::size_t k = segmentStart; k + 1 < i; ++k) {
+                callback(text::makeBigram(folded[k], folded[k + 1]));
+                if (withUnigrams) {
+                    callback(text::makeBigram(folded[k], 0));
+                }
+            }
+            if (withUnigrams && length > 1) {
+                callback(text::makeBigram(folded[i - 1], 0));
+            }
+        }
+        segmentStart = i + 1;
+    }
+}
+}
+
+void CatalogSearchIndex::addField(const std::string& value, float weight, std::size_t maxCodePoints,
+                                  std::unordered_map<std::uint64_t, float>& terms) {
+    // 标题字段额外收录单字，便于单字查询
+    const bool withUnigrams = weight >= kNameWeight;
+    forEachGram(value, maxCodePoints, withUnigrams, [&](std::uint64_t gram) {
+        float& current = terms[gram];
+        current = std::max(current, weight);
+    });
+}
+
+void CatalogSearchIndex::addDocument(const std::string& title, const std::vector<VideoInfo>& videos,
+                                     std::unordered_map<std::uint64_t, float>& terms) {
+    const auto doc = static_cast<std::uint32_t>(titles_.size());
+    titles_.push_back(title);
+    foldedTitles_.push_back(foldText(title));
+    sourceCounts_.push_back(videos.size());
+    removed_.push_back(false);
+    docIds_[title] = doc;
+
+    terms.clear();
+    addField(title, kNameWeight, kMaxNameCodePoints, terms);
+    for (const auto& video : videos) {
+        addField(video.vod_name, kNameWeight, kMaxNameCodePoints, terms);
+        addField(video.vod_sub, kSubWeight, kMaxNameCodePoints, terms);
+        addField(text::stripHtml(video.vod_content), kContentWeight, kMaxContentCodePoints, terms);
+    }
+
+    for (const auto& [gram, weight] : terms) {
+        postings_[gram].push_back(Posting{doc, weight});
+    }
+}
+
+void CatalogSearchIndex::build(const std::map<std::string, std::vector<VideoInfo>>& catalog) {
+    titles_.clear();
+    foldedTitles_.clear();
+    sourceCounts_.clear();
+    postings_.clear();
+    docIds_.clear();
+    removed_.clear();
+    removedCount_ = 0;
+    titles_.reserve(catalog.size());
+    foldedTitles_.reserve(catalog.size());
+    sourceCounts_.reserve(catalog.size());
+    removed_.reserve(catalog.size());
+
+    std::unordered_map<std::uint64_t, float> terms;
+    for (const auto& [title, videos] : catalog) {
+        addDocument(title, videos, terms);
+    }
+}
+
+void CatalogSearchIndex::update(const std::set<std::string>& changed,
+                                const std::map<std::string, std::vector<VideoInfo>>& entries) {
+    std::unordered_map<std::uint64_t, float> terms;
+    for (const auto& title : changed) {
+        const auto it = docIds_.find(title);
+        if (it != docIds_.end()) {
+            removed_[it->second] = true;
+            removedCount_++;
+            docIds_.erase(it);
+        }
+        const auto entry = entries.find(title);
+        if (entry != entries.end()) {
+            addDocument(title, entry->second, terms);
+        }
+    }
+
+    if (removedCount_ > documentCount()) {
+        compact();
+    }
+}
+
+void CatalogSearchIndex::compact() {
+    std::vector<std::uint32_t> remap(titles_.size(), 0);
+    std::size_t next = 0;
+    for (std::size_t doc = 0; doc < titles_.size(); ++doc) {
+        if (removed_[doc]) {
+            continue;
+        }
+        remap[doc] = static_cast<std::uint32_t>(next);
+        titles_[next] = std::move(titles_[doc]);
+        foldedTitles_[next] = std::move(foldedTitles_[doc]);
+        sourceCounts_[next] = sourceCounts_[doc];
+        next++;
+    }
+    titles_.resize(next);
+    foldedTitles_.resize(next);
+    sourceCounts_.resize(next);
+
+    for (auto it = postings_.begin(); it != postings_.end();) {
+        auto& postings = it->second;
+        postings.erase(std::remove_if(postings.begin(), postings.end(), [this](const Posting& posting) {
+            return removed_[posting.doc];
+        }), postings.end());
+        if (postings.empty()) {
+            it = postings_.erase(it);
+            continue;
+        }
+        for (auto& posting : postings) {
+            posting.doc = remap[posting.doc];
+        }
+        ++it;
+    }
+
+    removed_.assign(next, false);
+    removedCount_ = 0;
+    docIds_.clear();
+    for (std::size_t doc = 0; doc < next; ++doc) {
+        docIds_[titles_[doc]] = static_cast<std::uint32_t>(doc);
+    }
+}
+
+std::vector<LocalSearchHit> CatalogSearchIndex::search(const std::string& query, std::size_t limit) const {
+    std::vector<std::uint64_t> queryGrams;
+    forEachGram(query, kMaxNameCodePoints, false, [&](std::uint64_t gram) {
+        queryGrams.push_back(gram);
+    });
+    std::sort(queryGrams.begin(), queryGrams.end());
+    queryGrams.erase(std::unique(queryGrams.begin(), queryGrams.end()), queryGrams.end());
+
+    std::vector<LocalSearchHit> hits;
+    if (queryGrams.empty() || documentCount() == 0 || limit == 0) {
+        return hits;
+    }
+
+    struct Accumulator {
+        double score = 0.0;
+        std::size_t matched = 0;
+    };
+    std::unordered_map<std::uint32_t, Accumulator> accumulators;
+
+    // 已删除文档的倒排项在压缩前仍留在表中，计算 IDF 时按表长近似
+    const double documentCount = static_cast<double>(this->documentCount());
+    for (std::uint64_t gram : queryGrams) {
+        const auto it = postings_.find(gram);
+        if (it == postings_.end()) {
+            continue;
+        }
+
+        const double idf = std::log(1.0 + documentCount / static_cast<double>(it->second.size()));
+        for (const Posting& posting : it->second) {
+            if (removed_[posting.doc]) {
+                continue;
+            }
+            Accumulator& acc = accumulators[posting.doc];
+            acc.score += posting.weight * idf;
+            acc.matched++;
+        }
+    }
+
+    // 至少命中一半的查询 bigram 才算相关
+    const std::string foldedQuery = foldText(query);
+    std::vector<std::pair<std::uint32_t, Accumulator>> ranked;
+    ranked.reserve(accumulators.size());
+    for (auto& [doc, acc] : accumulators) {
+        if (acc.matched * 2 < queryGrams.size()) {
+            continue;
+        }
+        if (acc.matched == queryGrams.size() && foldedTitles_[doc].find(foldedQuery) != std::string::npos) {
+            acc.score *= kExactTitleBonus;
+        }
+        ranked.emplace_back(doc, acc);
+    }
+
+    const auto better = [this](const auto& a, const auto& b) {
+        if (a.second.matched != b.second.matched) {
+            return a.second.matched > b.second.matched;
+        }
+        if (a.second.score != b.second.score) {
+            return a.second.score > b.second.score;
+        }
+        return titles_[a.first].size() < titles_[b.first].size();
+    };
+    const std::size_t count = std::min(limit, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(count), ranked.end(), better);
+
+    hits.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint32_t doc = ranked[i].first;
+        LocalSearchHit hit;
+        hit.title = titles_[doc];
+        hit.score = ranked[i].second.score * static_cast<double>(ranked[i].second.matched) /
+                    static_cast<double>(queryGrams.size());
+        hit.sourceCount = sourceCounts_[doc];
+        hits.push_back(std::move(hit));
+    }
+
+    return hits;
+}
+
+std::size_t CatalogSearchIndex::documentCount() const {
+    return titles_.size() - removedCount_;
+}
@@ -0,0 +1,63 @@
+// catalog_search_index.h
+#ifndef CATALOG_SEARCH_INDEX_H
+#define CATALOG_SEARCH_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "json_parser.h"
+
+struct LocalSearchHit {
+    std::string title;
+    double score = 0.0;
+    std::size_t sourceCount = 0;
+};
+
+// 本地目录全文索引：以标题分组为文档，对 vod_name / vod_sub / vod_content
+// 建立字符 bigram 倒排表（适用于不分词的中文），查询时按命中比例和 IDF 加权排序
+class CatalogSearchIndex {
+public:
+    CatalogSearchIndex() = default;
+
+    // 基于完整目录重建索引
+    void build(const std::map<std::string, std::vector<VideoInfo>>& catalog);
+
+    // 只更新 changed 中的标题：旧文档标记删除，仍在目录中的按 entries 重新建立，其余文档不变。
+    // 已删除的文档过多时压缩倒排表
+    void update(const std::set<std::string>& changed, const std::map<std::string, std::vector<VideoInfo>>& entries);
+
+    // 查询最相关的标题，最多返回 limit 条
+    std::vector<LocalSearchHit> search(const std::string& query, std::size_t limit) const;
+
+    std::size_t documentCount() const;
+
+private:
+    struct Posting {
+        std::uint32_t doc;
+        float weight;
+    };
+
+    // 将文本中的 bigram 以给定权重累加到文档词表
+    static void addField(const std::string& value, float weight, std::size_t maxCodePoints,
+                         std::unordered_map<std::uint64_t, float>& terms);
+    void addDocument(const std::string& title, const std::vector<VideoInfo>& videos,
+                     std::unordered_map<std::uint64_t, float>& terms);
+    // 去掉已删除文档的倒排项并重新编号
+    void compact();
+
+    std::vector<std::string> titles_;
+    // 全角折叠后的标题，用于整词命中加权
+    std::vector<std::string> foldedTitles_;
+    std::vector<std::size_t> sourceCounts_;
+    std::unordered_map<std::uint64_t, std::vector<Posting>> postings_;
+    // 标题对应的有效文档；增量更新时被替换的旧文档只做删除标记
+    std::unordered_map<std::string, std::uint32_t> docIds_;
+    std::vector<bool> removed_;
+    std::size_t removedCount_ = 0;
+};
+
+#endif // CATALOG_SEARCH_INDEX_H
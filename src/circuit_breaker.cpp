@@ -0,0 +1,192 @@
+#include "circuit_breaker.h"
+#include <algorithm>
+#include <fstream>
+#include <utility>
+#include <nlohmann/json.hpp>
+#include "logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+constexpr const char* kLogModule = "CircuitBreaker";
+// 探测请求超过该时间仍未返回结果时，允许再次探测
+constexpr std::int64_t kProbeTimeoutSeconds = 120;
+
+template <typename... Args>
+void logInfo(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+
+std::int64_t nowSeconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+CircuitBreaker::State parseState(const std::string& value) {
+    if (value == "open") {
+        return CircuitBreaker::State::Open;
+    }
+    if (value == "half_open") {
+        return CircuitBreaker::State::HalfOpen;
+    }
+    return CircuitBreaker::State::Closed;
+}
+}
+
+CircuitBreaker::CircuitBreaker(const std::filesystem::path& stateFile, const Config& config)
+    : stateFile_(stateFile)
+    , config_(config) {
+    load();
+}
+
+const char* CircuitBreaker::stateName(State state) {
+    switch (state) {
+    case State::Open:
+        return "open";
+    case State::HalfOpen:
+        return "half_open";
+    case State::Closed:
+        break;
+    }
+    return "closed";
+}
+
+std::chrono::seconds CircuitBreaker::cooldownFor(int trips) const {
+    // 第 n 次连续熔断的冷却时间为 base * 2^(n-1)，不超过上限
+    std::chrono::seconds cooldown = config_.baseCooldown;
+    for (int i = 1; i < trips && cooldown < config_.maxCooldown; ++i) {
+        cooldown *= 2;
+    }
+    return std::min(cooldown, config_.maxCooldown);
+}
+
+bool CircuitBreaker::allowRequest(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = statuses_.find(key);
+    if (it == statuses_.end()) {
+        return true;
+    }
+
+    Status& status = it->second;
+    const std::int64_t now = nowSeconds();
+    switch (status.state) {
+    case State::Closed:
+        return true;
+    case State::Open:
+        if (now < status.openUntil) {
+            return false;
+        }
+        status.state = State::HalfOpen;
+        status.probeStartedAt = now;
+        dirty_ = true;
+        logInfo("冷却结束，放行探测请求: ", key);
+        return true;
+    case State::HalfOpen:
+        if (now - status.probeStartedAt < kProbeTimeoutSeconds) {
+            return false;
+        }
+        status.probeStartedAt = now;
+        logInfo("探测请求未返回，重新探测: ", key);
+        return true;
+    }
+    return true;
+}
+
+CircuitBreaker::Status CircuitBreaker::recordResult(const std::string& key, bool success) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Status& status = statuses_[key];
+
+    if (success) {
+        if (status.state != State::Closed || status.consecutiveFailures > 0) {
+            if (status.state != State::Closed) {
+                logInfo("站点恢复，熔断关闭: ", key);
+            }
+            status = Status();
+            dirty_ = true;
+        }
+        return status;
+    }
+
+    dirty_ = true;
+    status.consecutiveFailures++;
+    const bool probeFailed = status.state == State::HalfOpen;
+    if (probeFailed || status.consecutiveFailures >= config_.failureThreshold) {
+        status.trips++;
+        const std::chrono::seconds cooldown = cooldownFor(status.trips);
+        status.state = State::Open;
+        status.openUntil = nowSeconds() + cooldown.count();
+        status.probeStartedAt = 0;
+        logInfo(probeFailed ? "探测失败，重新熔断: " : "连续失败，熔断站点: ", key,
+                ", failures=", status.consecutiveFailures, ", trips=", status.trips, ", cooldown=", cooldown.count(), "s");
+    }
+    return status;
+}
+
+CircuitBreaker::Status CircuitBreaker::getStatus(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = statuses_.find(key);
+    return it == statuses_.end() ? Status() : it->second;
+}
+
+void CircuitBreaker::load() {
+    std::ifstream file(stateFile_);
+    if (!file) {
+        return;
+    }
+
+    try {
+        const json data = json::parse(file);
+        for (const auto& [key, value] : data.items()) {
+            Status status;
+            status.state = parseState(value.value("state", "closed"));
+            status.consecutiveFailures = value.value("failures", 0);
+            status.trips = value.value("trips", 0);
+            status.openUntil = value.value("open_until", static_cast<std::int64_t>(0));
+            // 重启前未完成的探测视为冷却已结束，下次搜索重新探测
+            if (status.state == State::HalfOpen) {
+                status.state = State::Open;
+                status.openUntil = 0;
+            }
+            statuses_[key] = status;
+        }
+        logInfo("熔断状态已加载: ", stateFile_, ", 站点数=", statuses_.size());
+    } catch (const std::exception& e) {
+        logError("熔断状态文件解析失败，忽略: ", stateFile_, ", error=", e.what());
+        statuses_.clear();
+    }
+}
+
+bool CircuitBreaker::save() {
+    json data = json::object();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!dirty_) {
+            return true;
+        }
+        for (const auto& [key, status] : statuses_) {
+            if (status.state == State::Closed && status.consecutiveFailures == 0) {
+                continue;
+            }
+            data[key] = {
+                {"state", stateName(status.state)},
+                {"failures", status.consecutiveFailures},
+                {"trips", status.trips},
+                {"open_until", status.openUntil}};
+        }
+        dirty_ = false;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(stateFile_.parent_path(), ec);
+    if (!writer_.write(stateFile_, data.dump(2))) {
+        logError("熔断状态写入失败: ", stateFile_);
+        std::lock_guard<std::mutex> lock(mutex_);
+        dirty_ = true;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,71 @@
+// circuit_breaker.h
+#ifndef CIRCUIT_BREAKER_H
+#define CIRCUIT_BREAKER_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include "atomic_file_writer.h"
+
+// 按站点的熔断器：
+//   Closed   正常请求，连续失败达到阈值后进入 Open
+//   Open     冷却期内跳过请求，冷却时间随连续熔断次数指数增长
+//   HalfOpen 冷却结束后只放行一个探测请求，成功则恢复 Closed，失败则重新 Open
+// 状态保存到文件，重启后继续生效。
+class CircuitBreaker {
+public:
+    enum class State {
+        Closed,
+        Open,
+        HalfOpen
+    };
+
+    struct Config {
+        int failureThreshold = 5;
+        std::chrono::seconds baseCooldown{60};
+        std::chrono::seconds maxCooldown{6 * 3600};
+    };
+
+    struct Status {
+        State state = State::Closed;
+        int consecutiveFailures = 0;
+        int trips = 0;                 // 连续熔断次数，决定冷却时间
+        std::int64_t openUntil = 0;    // 冷却结束时间（Unix 秒）
+        std::int64_t probeStartedAt = 0;
+    };
+
+    CircuitBreaker(const std::filesystem::path& stateFile, const Config& config);
+
+    // 禁用拷贝和赋值
+    CircuitBreaker(const CircuitBreaker&) = delete;
+    CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+
+    // 是否允许向该站点发起请求；冷却结束时会转为 HalfOpen 并放行唯一的探测请求
+    bool allowRequest(const std::string& key);
+
+    // 提交请求结果，返回更新后的状态
+    Status recordResult(const std::string& key, bool success);
+
+    Status getStatus(const std::string& key) const;
+
+    // 有变化时写回状态文件
+    bool save();
+
+    static const char* stateName(State state);
+
+private:
+    void load();
+    std::chrono::seconds cooldownFor(int trips) const;
+
+    std::filesystem::path stateFile_;
+    Config config_;
+    std::map<std::string, Status> statuses_;
+    bool dirty_ = false;
+    AtomicFileWriter writer_;
+    mutable std::mutex mutex_;
+};
+
+#endif // CIRCUIT_BREAKER_H
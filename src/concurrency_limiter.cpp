@@ -0,0 +1,161 @@
+#include "concurrency_limiter.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 平滑系数：近期延迟跟随较快，基线只缓慢上浮以适应网络变化
+constexpr double kRecentWeight = 0.2;
+constexpr double kBaselineDrift = 0.01;
+// 一批请求同时超时只收缩一次
+constexpr auto kDecreaseCooldown = std::chrono::seconds(1);
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(const Config& config, std::size_t initialLimit)
+    : config_(config)
+    , limit_(static_cast<double>(initialLimit)) {
+    config_.minLimit = std::max<std::size_t>(1, config_.minLimit);
+    config_.maxLimit = std::max(config_.minLimit, config_.maxLimit);
+    config_.perHostLimit = std::max<std::size_t>(1, config_.perHostLimit);
+    limit_ = std::clamp(limit_, static_cast<double>(config_.minLimit), static_cast<double>(config_.maxLimit));
+}
+
+std::size_t ConcurrencyLimiter::currentLimit() const {
+    return std::max<std::size_t>(config_.minLimit, static_cast<std::size_t>(std::floor(limit_)));
+}
+
+std::size_t ConcurrencyLimiter::acquireAny(const std::vector<std::string>& hosts) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    std::size_t index = 0;
+    while (!tryAcquireLocked(hosts, index)) {
+        released_.wait(lock);
+    }
+    return index;
+}
+
+bool ConcurrencyLimiter::tryAcquireAny(const std::vector<std::string>& hosts, std::size_t& index,
+                                       std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!tryAcquireLocked(hosts, index)) {
+        if (released_.wait_until(lock, deadline) == std::cv_status::timeout) {
+            return tryAcquireLocked(hosts, index);
+        }
+    }
+    return true;
+}
+
+bool ConcurrencyLimiter::tryAcquireLocked(const std::vector<std::string>& hosts, std::size_t& index) {
+    if (inFlight_ >= currentLimit()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < hosts.size(); ++i) {
+        const auto it = hostsInFlight_.find(hosts[i]);
+        if (it == hostsInFlight_.end() || it->second < config_.perHostLimit) {
+            hostsInFlight_[hosts[i]]++;
+            inFlight_++;
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ConcurrencyLimiter::release(const std::string& host, std::chrono::milliseconds latency, Outcome outcome) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 归还前的占用达到限制的一半才算用满，空闲时不继续放大限制
+        const bool saturated = inFlight_ * 2 >= currentLimit();
+
+        const auto it = hostsInFlight_.find(host);
+        if (it != hostsInFlight_.end()) {
+            if (--it->second == 0) {
+                hostsInFlight_.erase(it);
+            }
+        }
+        if (inFlight_ > 0) {
+            inFlight_--;
+        }
+
+        // 毫秒精度下本机请求可能为 0，按 1ms 计，避免基线为 0
+        onSample(hostLatency_[host], std::max(1.0, static_cast<double>(latency.count())), outcome, saturated);
+    }
+    released_.notify_all();
+}
+
+void ConcurrencyLimiter::onSample(HostLatency& host, double latencyMs, Outcome outcome, bool saturated) {
+    const auto now = std::chrono::steady_clock::now();
+    if (outcome == Outcome::Timeout) {
+        decrease(host, now);
+        return;
+    }
+    if (outcome != Outcome::Success) {
+        return;
+    }
+
+    // 每个主机只和自己的基线比较，慢站点的正常延迟不会被当成快站点的排队
+    host.recentMs = host.recentMs <= 0.0 ? latencyMs : host.recentMs + kRecentWeight * (latencyMs - host.recentMs);
+    if (host.baselineMs <= 0.0 || latencyMs < host.baselineMs) {
+        host.baselineMs = latencyMs;
+    } else {
+        host.baselineMs += kBaselineDrift * (latencyMs - host.baselineMs);
+    }
+
+    if (host.recentMs > host.baselineMs * config_.latencyTolerance) {
+        decrease(host, now);
+        return;
+    }
+
+    // 加性增长：每完成约一个窗口（limit 个请求）限制加一
+    if (saturated && limit_ < static_cast<double>(config_.maxLimit)) {
+        const std::size_t before = currentLimit();
+        limit_ = std::min(static_cast<double>(config_.maxLimit), limit_ + 1.0 / limit_);
+        if (currentLimit() > before) {
+            increases_++;
+        }
+    }
+}
+
+void ConcurrencyLimiter::decrease(HostLatency& host, std::chrono::steady_clock::time_point now) {
+    if (now - lastDecrease_ < kDecreaseCooldown) {
+        return;
+    }
+    lastDecrease_ = now;
+
+    const double reduced = std::max(static_cast<double>(config_.minLimit), std::floor(limit_ * config_.backoffRatio));
+    if (reduced < limit_) {
+        limit_ = reduced;
+        decreases_++;
+    }
+    // 收缩后重置该主机的近期延迟，避免同一批慢请求连续触发收缩
+    host.recentMs = host.baselineMs;
+}
+
+void ConcurrencyLimiter::setConfig(const Config& config) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+        config_.minLimit = std::max<std::size_t>(1, config_.minLimit);
+        config_.maxLimit = std::max(config_.minLimit, config_.maxLimit);
+        config_.perHostLimit = std::max<std::size_t>(1, config_.perHostLimit);
+        limit_ = std::clamp(limit_, static_cast<double>(config_.minLimit), static_cast<double>(config_.maxLimit));
+    }
+    released_.notify_all();
+}
+
+ConcurrencyLimiter::Config ConcurrencyLimiter::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+ConcurrencyLimiter::Snapshot ConcurrencyLimiter::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snapshot;
+    snapshot.config = config_;
+    snapshot.limit = currentLimit();
+    snapshot.inFlight = inFlight_;
+    snapshot.increases = increases_;
+    snapshot.decreases = decreases_;
+    snapshot.hostsInFlight.insert(hostsInFlight_.begin(), hostsInFlight_.end());
+    snapshot.hostLatency.insert(hostLatency_.begin(), hostLatency_.end());
+    return snapshot;
+}
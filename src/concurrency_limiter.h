@@ -0,0 +1,89 @@
+// concurrency_limiter.h
+#ifndef CONCURRENCY_LIMITER_H
+#define CONCURRENCY_LIMITER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 自适应并发限制（AIMD）：延迟平稳且并发被用满时逐步加一，
+// 出现超时或某个主机的延迟明显高于它自己的基线时按比例收缩；同时限制单个主机的并发连接数。
+// 基线和近期延迟按主机分别统计，慢站点和快站点的样本不会互相拉偏。
+class ConcurrencyLimiter {
+public:
+    enum class Outcome {
+        Success,
+        Failure,   // 非拥塞类失败（HTTP 错误、连接被拒等），不调整并发
+        Timeout,
+        Throttled  // 本地限速或截止时间导致请求没有发出，不计入延迟和并发调整
+    };
+
+    struct Config {
+        std::size_t minLimit = 1;
+        std::size_t maxLimit = 32;
+        std::size_t perHostLimit = 2;
+        double latencyTolerance = 2.0;   // 近期延迟超过基线的倍数时视为开始排队
+        double backoffRatio = 0.5;       // 收缩时保留的比例
+    };
+
+    struct HostLatency {
+        double baselineMs = 0.0;
+        double recentMs = 0.0;
+    };
+
+    struct Snapshot {
+        Config config;
+        std::size_t limit = 0;
+        std::size_t inFlight = 0;
+        std::size_t increases = 0;
+        std::size_t decreases = 0;
+        std::map<std::string, std::size_t> hostsInFlight;
+        std::map<std::string, HostLatency> hostLatency;
+    };
+
+    ConcurrencyLimiter(const Config& config, std::size_t initialLimit);
+
+    // 禁用拷贝和赋值
+    ConcurrencyLimiter(const ConcurrencyLimiter&) = delete;
+    ConcurrencyLimiter& operator=(const ConcurrencyLimiter&) = delete;
+
+    // 阻塞直到 hosts 中某个主机可以获得名额，返回其下标（hosts 不能为空）
+    std::size_t acquireAny(const std::vector<std::string>& hosts);
+
+    // 最多等待 timeout：获得名额时把下标写入 index，超时返回 false（timeout 为 0 时不等待）
+    bool tryAcquireAny(const std::vector<std::string>& hosts, std::size_t& index,
+                       std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    // 归还名额并提交本次请求的耗时和结果
+    void release(const std::string& host, std::chrono::milliseconds latency, Outcome outcome);
+
+    // 运行时修改配置，当前限制会被夹到新的上下限之间
+    void setConfig(const Config& config);
+    Config getConfig() const;
+
+    Snapshot getSnapshot() const;
+
+private:
+    std::size_t currentLimit() const;
+    bool tryAcquireLocked(const std::vector<std::string>& hosts, std::size_t& index);
+    void onSample(HostLatency& host, double latencyMs, Outcome outcome, bool saturated);
+    void decrease(HostLatency& host, std::chrono::steady_clock::time_point now);
+
+    Config config_;
+    double limit_;
+    std::size_t inFlight_ = 0;
+    std::unordered_map<std::string, std::size_t> hostsInFlight_;
+    std::unordered_map<std::string, HostLatency> hostLatency_;
+    std::size_t increases_ = 0;
+    std::size_t decreases_ = 0;
+    std::chrono::steady_clock::time_point lastDecrease_;
+    mutable std::mutex mutex_;
+    std::condition_variable released_;
+};
+
+#endif // CONCURRENCY_LIMITER_H
@@ -0,0 +1,143 @@
+#include "gzip_stream.h"
+#include <fstream>
+
+GzipInputStreamBuf::GzipInputStreamBuf(const std::string& filePath, std::size_t bufferSize)
+    : file_(gzopen(filePath.c_str(), "rb"))
+    , buffer_(bufferSize)
+    , error_(false) {
+    if (file_) {
+        gzbuffer(file_, static_cast<unsigned>(bufferSize));
+    }
+    setg(buffer_.data(), buffer_.data(), buffer_.data());
+}
+
+GzipInputStreamBuf::~GzipInputStreamBuf() {
+    if (file_) {
+        gzclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool GzipInputStreamBuf::isOpen() const {
+    return file_ != nullptr;
+}
+
+bool GzipInputStreamBuf::hasError() const {
+    return error_;
+}
+
+GzipInputStreamBuf::int_type GzipInputStreamBuf::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    if (!file_ || error_) {
+        return traits_type::eof();
+    }
+
+    const int bytesRead = gzread(file_, buffer_.data(), static_cast<unsigned>(buffer_.size()));
+    if (bytesRead <= 0) {
+        int errorCode = Z_OK;
+        gzerror(file_, &errorCode);
+        error_ = bytesRead < 0 || (errorCode != Z_OK && errorCode != Z_STREAM_END);
+        return traits_type::eof();
+    }
+
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + bytesRead);
+    return traits_type::to_int_type(*gptr());
+}
+
+GzipCompressor::GzipCompressor(int level)
+    : stream_{}
+    , inputBytes_(0)
+    , initialized_(false)
+    , finished_(false) {
+    // windowBits 加 16 表示输出 gzip 头和尾
+    initialized_ = deflateInit2(&stream_, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+}
+
+GzipCompressor::~GzipCompressor() {
+    if (initialized_) {
+        deflateEnd(&stream_);
+    }
+}
+
+bool GzipCompressor::deflateChunk(const char* data, std::size_t size, int flush) {
+    stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream_.avail_in = static_cast<uInt>(size);
+
+    char buffer[16 * 1024];
+    int result = Z_OK;
+    do {
+        stream_.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream_.avail_out = sizeof(buffer);
+        result = deflate(&stream_, flush);
+        if (result == Z_STREAM_ERROR) {
+            return false;
+        }
+        output_.append(buffer, sizeof(buffer) - stream_.avail_out);
+    } while (stream_.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+    return true;
+}
+
+bool GzipCompressor::write(const char* data, std::size_t size) {
+    if (!initialized_ || finished_) {
+        return false;
+    }
+    inputBytes_ += size;
+    return size == 0 || deflateChunk(data, size, Z_NO_FLUSH);
+}
+
+bool GzipCompressor::finish() {
+    if (!initialized_ || finished_) {
+        return false;
+    }
+    finished_ = true;
+    return deflateChunk(nullptr, 0, Z_FINISH);
+}
+
+const std::string& GzipCompressor::output() const {
+    return output_;
+}
+
+std::size_t GzipCompressor::inputBytes() const {
+    return inputBytes_;
+}
+
+namespace gzip {
+
+bool isGzipFile(const std::string& filePath) {
+    std::ifstream file(filePath, std::ios::binary);
+    unsigned char magic[2] = {0, 0};
+    if (!file.read(reinterpret_cast<char*>(magic), sizeof(magic))) {
+        return false;
+    }
+    return magic[0] == 0x1f && magic[1] == 0x8b;
+}
+
+bool compress(const std::string& input, std::string& output, int level) {
+    z_stream stream{};
+    // windowBits 加 16 表示输出 gzip 头和尾
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return false;
+    }
+
+    output.resize(deflateBound(&stream, static_cast<uLong>(input.size())) + 32);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+    stream.avail_out = static_cast<uInt>(output.size());
+
+    const int result = deflate(&stream, Z_FINISH);
+    const uLong totalOut = stream.total_out;
+    deflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        output.clear();
+        return false;
+    }
+
+    output.resize(totalOut);
+    return true;
+}
+
+} // namespace gzip
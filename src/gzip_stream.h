@@ -0,0 +1,72 @@
+// gzip_stream.h
+#ifndef GZIP_STREAM_H
+#define GZIP_STREAM_H
+
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// 读取 gzip 文件的流缓冲区，配合 std::istream 边解压边解析，无需先解压到内存
+class GzipInputStreamBuf : public std::streambuf {
+public:
+    explicit GzipInputStreamBuf(const std::string& filePath, std::size_t bufferSize = 64 * 1024);
+    ~GzipInputStreamBuf() override;
+
+    // 禁用拷贝和赋值
+    GzipInputStreamBuf(const GzipInputStreamBuf&) = delete;
+    GzipInputStreamBuf& operator=(const GzipInputStreamBuf&) = delete;
+
+    bool isOpen() const;
+
+    // 解压过程中是否发生错误（数据损坏或截断）
+    bool hasError() const;
+
+protected:
+    int_type underflow() override;
+
+private:
+    gzFile file_;
+    std::vector<char> buffer_;
+    bool error_;
+};
+
+// 增量 gzip 压缩：数据分块写入，边接收边压缩，不需要先拼出完整的原始数据
+class GzipCompressor {
+public:
+    explicit GzipCompressor(int level = Z_DEFAULT_COMPRESSION);
+    ~GzipCompressor();
+
+    // 禁用拷贝和赋值
+    GzipCompressor(const GzipCompressor&) = delete;
+    GzipCompressor& operator=(const GzipCompressor&) = delete;
+
+    bool write(const char* data, std::size_t size);
+
+    // 写入 gzip 尾部，之后 output 为完整的 gzip 数据
+    bool finish();
+
+    const std::string& output() const;
+    std::size_t inputBytes() const;
+
+private:
+    bool deflateChunk(const char* data, std::size_t size, int flush);
+
+    z_stream stream_;
+    std::string output_;
+    std::size_t inputBytes_;
+    bool initialized_;
+    bool finished_;
+};
+
+namespace gzip {
+
+// 判断文件开头是否为 gzip 魔数
+bool isGzipFile(const std::string& filePath);
+
+// 将内存数据压缩为 gzip 格式
+bool compress(const std::string& input, std::string& output, int level = Z_DEFAULT_COMPRESSION);
+
+} // namespace gzip
+
+#endif // GZIP_STREAM_H
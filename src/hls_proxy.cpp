@@ -0,0 +1,486 @@
+#include "hls_proxy.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+#include "https_json_client.h"
+#include "logger.h"
+#include "text_util.h"
+
+namespace {
+constexpr const char* kLogModule = "HlsProxy";
+// 点播列表（含 ENDLIST）内容不会变化，直播列表只短暂缓存
+constexpr auto kStaticPlaylistTtl = std::chrono::minutes(10);
+constexpr auto kLivePlaylistTtl = std::chrono::seconds(2);
+constexpr std::size_t kMaxCachedPlaylists = 256;
+// 记录分片顺序的播放列表数量上限
+constexpr std::size_t kMaxTrackedPlaylists = 64;
+constexpr std::size_t kPrefetchWorkers = 2;
+constexpr std::size_t kMaxQueuedPrefetches = 64;
+constexpr std::size_t kDefaultSegmentsAhead = 3;
+constexpr std::size_t kDefaultNextEpisodeSegments = 2;
+constexpr const char* kSigningKeyFile = "url_signing.key";
+constexpr std::size_t kSigningKeyBytes = 32;
+// 签名取 HMAC-SHA256 的前 128 位（32 位十六进制），控制改写后播放列表的体积
+constexpr std::size_t kSignatureLength = 32;
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+
+bool startsWith(const std::string& value, const char* prefix) {
+    return value.rfind(prefix, 0) == 0;
+}
+
+// 每个线程复用一个客户端，同一 CDN 的连续分片请求可以复用连接
+HTTPSJsonClient& mediaClient() {
+    thread_local HTTPSJsonClient client;
+    thread_local bool configured = false;
+    if (!configured) {
+        client.setUserAgent("Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/122.0.0.0 Safari/537.36");
+        client.setAccept("*/*");
+        client.setConnectTimeout(5);
+        client.setRequestTimeout(30);
+        client.setVerifySSL(true);
+        client.setBlockPrivateAddresses(true);
+        configured = true;
+    }
+    return client;
+}
+
+std::string percentEncode(const std::string& value) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string output;
+    output.reserve(value.size() * 3);
+    for (unsigned char c : value) {
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+            c == '-' || c == '_' || c == '.' || c == '~') {
+            output.push_back(static_cast<char>(c));
+        } else {
+            output.push_back('%');
+            output.push_back(digits[c >> 4]);
+            output.push_back(digits[c & 0x0F]);
+        }
+    }
+    return output;
+}
+
+// 读取已有的签名密钥，不存在或长度不对时生成新的随机密钥并保存
+std::string loadSigningKey(const std::filesystem::path& file) {
+    std::ifstream input(file, std::ios::binary);
+    std::string key((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (key.size() == kSigningKeyBytes) {
+        return key;
+    }
+
+    std::random_device device;
+    key.clear();
+    for (std::size_t i = 0; i < kSigningKeyBytes; ++i) {
+        key.push_back(static_cast<char>(device() & 0xFF));
+    }
+    std::ofstream output(file, std::ios::binary | std::ios::trunc);
+    output.write(key.data(), static_cast<std::streamsize>(key.size()));
+    output.close();
+    std::error_code ec;
+    std::filesystem::permissions(file, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write, ec);
+    if (!output || ec) {
+        logError("无法保存签名密钥，重启后已下发的代理地址将失效: ", file);
+    }
+    return key;
+}
+
+// 去掉路径中的 "." 和 ".." 段
+std::string removeDotSegments(const std::string& path) {
+    std::vector<std::string> segments;
+    std::size_t start = 0;
+    while (start <= path.size()) {
+        std::size_t end = path.find('/', start);
+        if (end == std::string::npos) {
+            end = path.size();
+        }
+        const std::string segment = path.substr(start, end - start);
+        if (segment == "..") {
+            if (segments.size() > 1) {
+                segments.pop_back();
+            }
+        } else if (segment != ".") {
+            segments.push_back(segment);
+        }
+        start = end + 1;
+    }
+
+    std::string output;
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        if (i > 0) {
+            output.push_back('/');
+        }
+        output += segments[i];
+    }
+    // 以 "." 或 ".." 结尾时保留目录语义
+    if ((path.size() >= 2 && path.compare(path.size() - 2, 2, "/.") == 0) ||
+        (path.size() >= 3 && path.compare(path.size() - 3, 3, "/..") == 0)) {
+        output.push_back('/');
+    }
+    return output;
+}
+
+bool looksLikePlaylist(const std::string& url) {
+    const std::size_t queryPos = url.find('?');
+    const std::string path = url.substr(0, queryPos);
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".m3u8") == 0;
+}
+
+SegmentCache::Data fetchUpstream(const std::string& url) {
+    HTTPSJsonClient& client = mediaClient();
+    std::string response = client.get(url);
+    const long status = client.getLastStatusCode();
+    if (status != 200 || response.empty()) {
+        logError("分片请求失败: url=", url, ", error=", client.getLastError(), ", status=", status);
+        return nullptr;
+    }
+    return std::make_shared<const std::string>(std::move(response));
+}
+
+bool isPlaylistBody(const std::string& body) {
+    std::size_t offset = 0;
+    if (startsWith(body, "\xEF\xBB\xBF")) {
+        offset = 3;
+    }
+    while (offset < body.size() && (body[offset] == ' ' || body[offset] == '\r' || body[offset] == '\n')) {
+        ++offset;
+    }
+    return body.compare(offset, 7, "#EXTM3U") == 0;
+}
+}
+
+HlsProxy::HlsProxy(const std::filesystem::path& cacheDir, std::size_t memoryBudget, std::size_t diskBudget)
+    : cache_(cacheDir, memoryBudget, diskBudget)
+    , segmentsAhead_(kDefaultSegmentsAhead)
+    , nextEpisodeSegments_(kDefaultNextEpisodeSegments)
+    , prefetcher_(kPrefetchWorkers, kMaxQueuedPrefetches) {
+    signingKey_ = loadSigningKey(cacheDir / kSigningKeyFile);
+}
+
+void HlsProxy::setPrefetchDepth(std::size_t segmentsAhead, std::size_t nextEpisodeSegments) {
+    std::lock_guard<std::mutex> lock(playlistInfosMutex_);
+    segmentsAhead_ = segmentsAhead;
+    nextEpisodeSegments_ = nextEpisodeSegments;
+}
+
+bool HlsProxy::isProxyableUrl(const std::string& url) {
+    return startsWith(url, "http://") || startsWith(url, "https://");
+}
+
+std::string HlsProxy::signUrl(const std::string& url) const {
+    return text::hmacSha256Hex(signingKey_, url).substr(0, kSignatureLength);
+}
+
+bool HlsProxy::isSignedUrl(const std::string& url, const std::string& signature) const {
+    return isProxyableUrl(url) && text::constantTimeEquals(signUrl(url), signature);
+}
+
+std::string HlsProxy::proxyUrl(const char* route, const std::string& absoluteUrl) const {
+    return std::string(route) + "?url=" + percentEncode(absoluteUrl) + "&sig=" + signUrl(absoluteUrl);
+}
+
+std::string HlsProxy::rewriteUriAttribute(const std::string& line, const std::string& playlistUrl, bool isPlaylist) const {
+    const std::string marker = "URI=\"";
+    const std::size_t start = line.find(marker);
+    if (start == std::string::npos) {
+        return line;
+    }
+
+    const std::size_t valueStart = start + marker.size();
+    const std::size_t valueEnd = line.find('"', valueStart);
+    if (valueEnd == std::string::npos) {
+        return line;
+    }
+
+    const std::string absolute = resolveUrl(playlistUrl, line.substr(valueStart, valueEnd - valueStart));
+    const char* route = isPlaylist ? kPlaylistRoute : kSegmentRoute;
+    return line.substr(0, valueStart) + proxyUrl(route, absolute) + line.substr(valueEnd);
+}
+
+std::string HlsProxy::resolveUrl(const std::string& baseUrl, const std::string& reference) {
+    if (reference.find("://") != std::string::npos) {
+        return reference;
+    }
+
+    const std::size_t schemeEnd = baseUrl.find("://");
+    if (schemeEnd == std::string::npos) {
+        return reference;
+    }
+    if (startsWith(reference, "//")) {
+        return baseUrl.substr(0, schemeEnd + 1) + reference;
+    }
+
+    const std::size_t hostEnd = baseUrl.find_first_of("/?#", schemeEnd + 3);
+    const std::string origin = baseUrl.substr(0, hostEnd);
+
+    std::string path = reference;
+    std::string query;
+    const std::size_t queryPos = reference.find_first_of("?#");
+    if (queryPos != std::string::npos) {
+        path = reference.substr(0, queryPos);
+        query = reference.substr(queryPos);
+    }
+
+    if (path.empty()) {
+        // 只有查询串时沿用基础地址的路径
+        const std::size_t baseQueryPos = baseUrl.find_first_of("?#", schemeEnd + 3);
+        return baseUrl.substr(0, baseQueryPos) + query;
+    }
+
+    if (path[0] != '/') {
+        std::string basePath = "/";
+        if (hostEnd != std::string::npos && baseUrl[hostEnd] == '/') {
+            const std::size_t basePathEnd = baseUrl.find_first_of("?#", hostEnd);
+            basePath = baseUrl.substr(hostEnd, basePathEnd == std::string::npos ? std::string::npos : basePathEnd - hostEnd);
+        }
+        path = basePath.substr(0, basePath.rfind('/') + 1) + path;
+    }
+
+    return origin + removeDotSegments(path) + query;
+}
+
+const char* HlsProxy::contentTypeForSegment(const std::string& url) {
+    const std::string path = url.substr(0, url.find('?'));
+    const std::size_t dot = path.rfind('.');
+    const std::string extension = dot == std::string::npos ? "" : path.substr(dot);
+    if (extension == ".ts") return "video/mp2t";
+    if (extension == ".m4s" || extension == ".mp4") return "video/mp4";
+    if (extension == ".aac") return "audio/aac";
+    if (extension == ".vtt") return "text/vtt";
+    return "application/octet-stream";
+}
+
+std::string HlsProxy::rewritePlaylist(const std::string& body, const std::string& playlistUrl, PlaylistInfo& info) const {
+    std::istringstream input(body);
+    std::string output;
+    output.reserve(body.size() * 2);
+
+    std::string line;
+    bool nextIsPlaylist = false;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        if (line.empty()) {
+            output.push_back('\n');
+            continue;
+        }
+
+        if (line[0] == '#') {
+            if (startsWith(line, "#EXT-X-STREAM-INF")) {
+                nextIsPlaylist = true;
+            }
+            const bool attributeIsPlaylist = startsWith(line, "#EXT-X-MEDIA") ||
+                                             startsWith(line, "#EXT-X-I-FRAME-STREAM-INF");
+            output += rewriteUriAttribute(line, playlistUrl, attributeIsPlaylist);
+            output.push_back('\n');
+            continue;
+        }
+
+        const std::string absolute = resolveUrl(playlistUrl, line);
+        const bool isPlaylist = nextIsPlaylist || looksLikePlaylist(absolute);
+        (isPlaylist ? info.variants : info.segments).push_back(absolute);
+        output += proxyUrl(isPlaylist ? kPlaylistRoute : kSegmentRoute, absolute);
+        output.push_back('\n');
+        nextIsPlaylist = false;
+    }
+
+    return output;
+}
+
+bool HlsProxy::lookupPlaylist(const std::string& url, std::string& body) {
+    std::lock_guard<std::mutex> lock(playlistsMutex_);
+    const auto it = playlists_.find(url);
+    if (it == playlists_.end()) {
+        return false;
+    }
+    if (it->second.expiresAt < std::chrono::steady_clock::now()) {
+        playlists_.erase(it);
+        return false;
+    }
+    body = it->second.body;
+    return true;
+}
+
+void HlsProxy::storePlaylist(const std::string& url, const std::string& body, bool isStatic) {
+    const auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(playlistsMutex_);
+
+    if (playlists_.size() >= kMaxCachedPlaylists) {
+        for (auto it = playlists_.begin(); it != playlists_.end();) {
+            it = it->second.expiresAt < now ? playlists_.erase(it) : std::next(it);
+        }
+        if (playlists_.size() >= kMaxCachedPlaylists) {
+            playlists_.erase(playlists_.begin());
+        }
+    }
+
+    playlists_[url] = CachedPlaylist{body, now + (isStatic ? std::chrono::steady_clock::duration(kStaticPlaylistTtl)
+                                                           : std::chrono::steady_clock::duration(kLivePlaylistTtl))};
+}
+
+bool HlsProxy::fetchPlaylist(const std::string& url, std::string& body) {
+    if (lookupPlaylist(url, body)) {
+        return true;
+    }
+
+    HTTPSJsonClient& client = mediaClient();
+    const std::string response = client.get(url);
+    if (response.empty() || client.getLastStatusCode() != 200) {
+        logError("播放列表请求失败: url=", url, ", error=", client.getLastError(), ", status=", client.getLastStatusCode());
+        return false;
+    }
+    if (!isPlaylistBody(response)) {
+        logError("返回内容不是 m3u8 播放列表: url=", url);
+        return false;
+    }
+
+    PlaylistInfo info;
+    body = rewritePlaylist(response, url, info);
+    recordPlaylistInfo(url, std::move(info));
+    const bool isStatic = response.find("#EXT-X-ENDLIST") != std::string::npos ||
+                          response.find("#EXT-X-STREAM-INF") != std::string::npos;
+    storePlaylist(url, body, isStatic);
+    return true;
+}
+
+void HlsProxy::recordPlaylistInfo(const std::string& url, PlaylistInfo info) {
+    auto shared = std::make_shared<const PlaylistInfo>(std::move(info));
+    std::lock_guard<std::mutex> lock(playlistInfosMutex_);
+
+    if (playlistInfos_.find(url) == playlistInfos_.end()) {
+        playlistInfoOrder_.push_back(url);
+    }
+    playlistInfos_[url] = shared;
+    for (std::size_t i = 0; i < shared->segments.size(); ++i) {
+        segmentPositions_[shared->segments[i]] = {url, i};
+    }
+
+    while (playlistInfoOrder_.size() > kMaxTrackedPlaylists) {
+        const std::string oldest = playlistInfoOrder_.front();
+        playlistInfoOrder_.pop_front();
+        const auto it = playlistInfos_.find(oldest);
+        if (it == playlistInfos_.end()) {
+            continue;
+        }
+        for (const auto& segment : it->second->segments) {
+            const auto position = segmentPositions_.find(segment);
+            if (position != segmentPositions_.end() && position->second.first == oldest) {
+                segmentPositions_.erase(position);
+            }
+        }
+        playlistInfos_.erase(it);
+    }
+}
+
+std::shared_ptr<const HlsProxy::PlaylistInfo> HlsProxy::findPlaylistInfo(const std::string& url) {
+    std::lock_guard<std::mutex> lock(playlistInfosMutex_);
+    const auto it = playlistInfos_.find(url);
+    return it == playlistInfos_.end() ? nullptr : it->second;
+}
+
+void HlsProxy::schedulePrefetch(const std::vector<std::string>& urls) {
+    for (const auto& url : urls) {
+        if (cache_.contains(url)) {
+            continue;
+        }
+        prefetcher_.schedule(url, [this, url]() {
+            cache_.getOrFetch(url, fetchUpstream);
+        });
+    }
+}
+
+void HlsProxy::scheduleReadAhead(const std::string& segmentUrl) {
+    std::vector<std::string> upcoming;
+    {
+        std::lock_guard<std::mutex> lock(playlistInfosMutex_);
+        const auto position = segmentPositions_.find(segmentUrl);
+        if (position == segmentPositions_.end()) {
+            return;
+        }
+        const auto info = playlistInfos_.find(position->second.first);
+        if (info == playlistInfos_.end()) {
+            return;
+        }
+
+        const auto& segments = info->second->segments;
+        const std::size_t first = position->second.second + 1;
+        for (std::size_t i = first; i < segments.size() && i < first + segmentsAhead_; ++i) {
+            upcoming.push_back(segments[i]);
+        }
+    }
+
+    schedulePrefetch(upcoming);
+}
+
+bool HlsProxy::lookupSegment(const std::string& url, SegmentCache::Data& data, std::filesystem::path& file) {
+    std::error_code ec;
+    if (!cache_.lookup(url, data, file) || (!data && !std::filesystem::is_regular_file(file, ec))) {
+        data = nullptr;
+        file.clear();
+        return false;
+    }
+    scheduleReadAhead(url);
+    return true;
+}
+
+bool HlsProxy::openSegment(const std::string& url, SegmentCache::Data& data, std::filesystem::path& file) {
+    if (lookupSegment(url, data, file)) {
+        return true;
+    }
+
+    // 未命中或磁盘文件刚被淘汰，回退到常规获取流程
+    data = cache_.getOrFetch(url, fetchUpstream);
+    if (!data) {
+        return false;
+    }
+    scheduleReadAhead(url);
+    return true;
+}
+
+bool HlsProxy::fetchSegment(const std::string& url, SegmentCache::Data& data) {
+    data = cache_.getOrFetch(url, fetchUpstream);
+    return data != nullptr;
+}
+
+bool HlsProxy::prefetchPlaylist(const std::string& url) {
+    return prefetcher_.schedule("playlist:" + url, [this, url]() {
+        std::string body;
+        if (!fetchPlaylist(url, body)) {
+            return;
+        }
+
+        std::shared_ptr<const PlaylistInfo> info = findPlaylistInfo(url);
+        // 主播放列表没有分片，取第一个码率的子列表
+        if (info && info->segments.empty() && !info->variants.empty()) {
+            const std::string variant = info->variants.front();
+            if (!fetchPlaylist(variant, body)) {
+                return;
+            }
+            info = findPlaylistInfo(variant);
+        }
+        if (!info) {
+            return;
+        }
+
+        std::size_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(playlistInfosMutex_);
+            count = std::min(nextEpisodeSegments_, info->segments.size());
+        }
+        schedulePrefetch(std::vector<std::string>(info->segments.begin(), info->segments.begin() + static_cast<std::ptrdiff_t>(count)));
+    });
+}
+
+SegmentCache::Stats HlsProxy::getCacheStats() const {
+    return cache_.getStats();
+}
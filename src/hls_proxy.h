@@ -0,0 +1,114 @@
+// hls_proxy.h
+#ifndef HLS_PROXY_H
+#define HLS_PROXY_H
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "segment_cache.h"
+#include "segment_prefetcher.h"
+
+// HLS 代理：下载 m3u8 播放列表并改写其中的地址，使子播放列表、分片和密钥
+// 都经由本服务获取；分片通过 SegmentCache 在多个观看者之间共享。
+// 每次请求分片后会在后台预取同一播放列表中随后的若干分片。
+// 改写出的地址带有 HMAC 签名，代理只接受本服务签发过的地址，不能被用来访问任意网址。
+class HlsProxy {
+public:
+    static constexpr const char* kPlaylistRoute = "/proxy/hls";
+    static constexpr const char* kSegmentRoute = "/proxy/hls/segment";
+    static constexpr const char* kPrefetchRoute = "/proxy/hls/prefetch";
+
+    HlsProxy(const std::filesystem::path& cacheDir, std::size_t memoryBudget, std::size_t diskBudget);
+
+    // 禁用拷贝和赋值
+    HlsProxy(const HlsProxy&) = delete;
+    HlsProxy& operator=(const HlsProxy&) = delete;
+
+    // 获取并改写播放列表，失败时返回 false
+    bool fetchPlaylist(const std::string& url, std::string& body);
+
+    // 只查询已改写的播放列表缓存，不访问上游
+    bool lookupPlaylist(const std::string& url, std::string& body);
+
+    // 获取分片、密钥或初始化片段，并触发后续分片预取。
+    // 磁盘缓存命中时只返回文件路径（file），其余情况返回内容（data）
+    bool openSegment(const std::string& url, SegmentCache::Data& data, std::filesystem::path& file);
+
+    // 只查询分片缓存，不访问上游；命中时与 openSegment 一样触发后续分片预取
+    bool lookupSegment(const std::string& url, SegmentCache::Data& data, std::filesystem::path& file);
+
+    // 获取分片内容（不返回磁盘文件路径），用于磁盘文件在发送前被淘汰的情况
+    bool fetchSegment(const std::string& url, SegmentCache::Data& data);
+
+    // 后台预取播放列表（主列表取第一个码率）及其开头的分片，用于下一集
+    bool prefetchPlaylist(const std::string& url);
+
+    // 设置分片预读数量和下一集预取的分片数量
+    void setPrefetchDepth(std::size_t segmentsAhead, std::size_t nextEpisodeSegments);
+
+    SegmentCache::Stats getCacheStats() const;
+
+    // 只代理 http/https 地址
+    static bool isProxyableUrl(const std::string& url);
+
+    // 地址是否带有本服务在改写播放列表时签发的签名（sig 参数）
+    bool isSignedUrl(const std::string& url, const std::string& signature) const;
+
+    // 按 RFC 3986 将播放列表中的相对地址解析为绝对地址
+    static std::string resolveUrl(const std::string& baseUrl, const std::string& reference);
+
+    static const char* contentTypeForSegment(const std::string& url);
+
+private:
+    struct CachedPlaylist {
+        std::string body;
+        std::chrono::steady_clock::time_point expiresAt;
+    };
+
+    // 播放列表中按顺序出现的分片和子播放列表地址（均为绝对地址）
+    struct PlaylistInfo {
+        std::vector<std::string> segments;
+        std::vector<std::string> variants;
+    };
+
+    std::string signUrl(const std::string& url) const;
+    // 指向本服务的代理地址，附带签名
+    std::string proxyUrl(const char* route, const std::string& absoluteUrl) const;
+    // 改写标签中的 URI="..." 属性
+    std::string rewriteUriAttribute(const std::string& line, const std::string& playlistUrl, bool isPlaylist) const;
+    std::string rewritePlaylist(const std::string& body, const std::string& playlistUrl, PlaylistInfo& info) const;
+    void storePlaylist(const std::string& url, const std::string& body, bool isStatic);
+
+    void recordPlaylistInfo(const std::string& url, PlaylistInfo info);
+    std::shared_ptr<const PlaylistInfo> findPlaylistInfo(const std::string& url);
+
+    // 把尚未缓存的分片加入预取队列
+    void schedulePrefetch(const std::vector<std::string>& urls);
+    void scheduleReadAhead(const std::string& segmentUrl);
+
+    SegmentCache cache_;
+    // 签名密钥保存在缓存目录，重启后已下发的播放列表仍然有效
+    std::string signingKey_;
+    std::map<std::string, CachedPlaylist> playlists_;
+    std::mutex playlistsMutex_;
+
+    std::map<std::string, std::shared_ptr<const PlaylistInfo>> playlistInfos_;
+    std::deque<std::string> playlistInfoOrder_;
+    std::unordered_map<std::string, std::pair<std::string, std::size_t>> segmentPositions_;
+    std::mutex playlistInfosMutex_;
+    std::size_t segmentsAhead_;
+    std::size_t nextEpisodeSegments_;
+
+    // 最后声明，析构时先停止预取线程，再释放缓存
+    SegmentPrefetcher prefetcher_;
+};
+
+#endif // HLS_PROXY_H
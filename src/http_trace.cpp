@@ -0,0 +1,213 @@
+#include "http_trace.h"
+#include <nlohmann/json.hpp>
+#include "logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+constexpr const char* kLogModule = "HttpTrace";
+constexpr const char* kBase64Chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+template <typename... Args>
+void logInfo(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+
+// 响应体可能不是合法的 UTF-8，统一以 base64 保存
+std::string encodeBase64(const std::string& input) {
+    std::string output;
+    output.reserve((input.size() + 2) / 3 * 4);
+    std::size_t i = 0;
+    for (; i + 2 < input.size(); i += 3) {
+        const unsigned value = (static_cast<unsigned char>(input[i]) << 16) |
+                               (static_cast<unsigned char>(input[i + 1]) << 8) |
+                               static_cast<unsigned char>(input[i + 2]);
+        output.push_back(kBase64Chars[(value >> 18) & 0x3f]);
+        output.push_back(kBase64Chars[(value >> 12) & 0x3f]);
+        output.push_back(kBase64Chars[(value >> 6) & 0x3f]);
+        output.push_back(kBase64Chars[value & 0x3f]);
+    }
+    if (i < input.size()) {
+        unsigned value = static_cast<unsigned char>(input[i]) << 16;
+        if (i + 1 < input.size()) {
+            value |= static_cast<unsigned char>(input[i + 1]) << 8;
+        }
+        output.push_back(kBase64Chars[(value >> 18) & 0x3f]);
+        output.push_back(kBase64Chars[(value >> 12) & 0x3f]);
+        output.push_back(i + 1 < input.size() ? kBase64Chars[(value >> 6) & 0x3f] : '=');
+        output.push_back('=');
+    }
+    return output;
+}
+
+std::string decodeBase64(const std::string& input) {
+    std::string output;
+    output.reserve(input.size() / 4 * 3);
+    unsigned value = 0;
+    int bits = 0;
+    for (char c : input) {
+        int digit = -1;
+        if (c >= 'A' && c <= 'Z') {
+            digit = c - 'A';
+        } else if (c >= 'a' && c <= 'z') {
+            digit = c - 'a' + 26;
+        } else if (c >= '0' && c <= '9') {
+            digit = c - '0' + 52;
+        } else if (c == '+') {
+            digit = 62;
+        } else if (c == '/') {
+            digit = 63;
+        } else {
+            continue;
+        }
+        value = (value << 6) | static_cast<unsigned>(digit);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            output.push_back(static_cast<char>((value >> bits) & 0xff));
+        }
+    }
+    return output;
+}
+}
+
+HttpTrace& HttpTrace::instance() {
+    static HttpTrace trace;
+    return trace;
+}
+
+bool HttpTrace::parseSpec(const std::string& spec, Mode& mode, std::filesystem::path& file) {
+    const std::size_t colon = spec.find(':');
+    if (colon == std::string::npos || colon + 1 >= spec.size()) {
+        return false;
+    }
+
+    const std::string name = spec.substr(0, colon);
+    if (name == "record") {
+        mode = Mode::Record;
+    } else if (name == "replay") {
+        mode = Mode::Replay;
+    } else {
+        return false;
+    }
+    file = spec.substr(colon + 1);
+    return true;
+}
+
+bool HttpTrace::open(Mode mode, const std::filesystem::path& file, double speed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mode_ = Mode::Off;
+    output_.close();
+    entries_.clear();
+    speed_ = speed < 0.0 ? 0.0 : speed;
+
+    if (mode == Mode::Record) {
+        output_.open(file, std::ios::binary | std::ios::app);
+        if (!output_) {
+            logError("无法打开录制文件: ", file);
+            return false;
+        }
+        mode_ = mode;
+        logInfo("开始录制上游请求: ", file);
+        return true;
+    }
+
+    if (mode == Mode::Replay) {
+        std::ifstream input(file, std::ios::binary);
+        if (!input) {
+            logError("无法打开回放文件: ", file);
+            return false;
+        }
+
+        std::size_t loaded = 0;
+        std::string line;
+        while (std::getline(input, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            try {
+                const json value = json::parse(line);
+                Entry entry;
+                entry.url = value.at("url").get<std::string>();
+                entry.status = value.value("status", 0L);
+                entry.errorCode = value.value("error_code", 0);
+                entry.error = value.value("error", "");
+                entry.startTransferSeconds = value.value("start_transfer_ms", 0.0) / 1000.0;
+                entry.totalSeconds = value.value("total_ms", 0.0) / 1000.0;
+                entry.contentEncoding = value.value("content_encoding", "");
+                entry.wireBytes = value.value("wire_bytes", static_cast<std::size_t>(0));
+                entry.retryAfterMs = value.value("retry_after_ms", 0LL);
+                entry.body = decodeBase64(value.value("body", ""));
+                entries_[entry.url].push_back(std::move(entry));
+                loaded++;
+            } catch (const std::exception& e) {
+                logError("回放文件中有无法解析的行，已跳过: ", e.what());
+            }
+        }
+        mode_ = mode;
+        logInfo("已加载回放文件: ", file, ", 请求数=", loaded, ", URL 数=", entries_.size());
+        return true;
+    }
+    return true;
+}
+
+void HttpTrace::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    mode_ = Mode::Off;
+    output_.close();
+    entries_.clear();
+}
+
+HttpTrace::Mode HttpTrace::mode() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return mode_;
+}
+
+double HttpTrace::speed() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return speed_;
+}
+
+void HttpTrace::record(const Entry& entry) {
+    const json value = {
+        {"url", entry.url},
+        {"status", entry.status},
+        {"error_code", entry.errorCode},
+        {"error", entry.error},
+        {"start_transfer_ms", entry.startTransferSeconds * 1000.0},
+        {"total_ms", entry.totalSeconds * 1000.0},
+        {"content_encoding", entry.contentEncoding},
+        {"wire_bytes", entry.wireBytes},
+        {"retry_after_ms", entry.retryAfterMs},
+        {"body", encodeBase64(entry.body)}};
+    // URL 和错误信息中可能含非法 UTF-8，替换掉而不是抛异常
+    const std::string line = value.dump(-1, ' ', false, json::error_handler_t::replace);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (mode_ != Mode::Record) {
+        return;
+    }
+    output_ << line << '\n';
+    output_.flush();
+}
+
+bool HttpTrace::lookup(const std::string& url, Entry& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = entries_.find(url);
+    if (mode_ != Mode::Replay || it == entries_.end() || it->second.empty()) {
+        return false;
+    }
+
+    // 轮转：取出队首后放回队尾
+    entry = it->second.front();
+    if (it->second.size() > 1) {
+        it->second.push_back(std::move(it->second.front()));
+        it->second.pop_front();
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+// http_trace.h
+#ifndef HTTP_TRACE_H
+#define HTTP_TRACE_H
+
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+
+// 上游请求的录制与回放。
+// 录制模式下，开启了追踪的 HTTPSJsonClient 把每次尝试（含重试）的 URL、耗时和响应体追加到 JSON Lines 文件；
+// 回放模式下这些客户端不再访问网络，按 URL 返回录制的响应，并按原始耗时（乘以 speed）等待。
+// 回放仍经过客户端的限速、截止时间和重试逻辑，录制的 Retry-After 同样生效。
+class HttpTrace {
+public:
+    enum class Mode {
+        Off,
+        Record,
+        Replay
+    };
+
+    struct Entry {
+        std::string url;
+        long status = 0;
+        int errorCode = 0;               // CURLcode
+        std::string error;
+        double startTransferSeconds = 0.0;
+        double totalSeconds = 0.0;
+        std::string contentEncoding;
+        std::size_t wireBytes = 0;
+        long long retryAfterMs = 0;
+        std::string body;
+    };
+
+    static HttpTrace& instance();
+
+    // 禁用拷贝和赋值
+    HttpTrace(const HttpTrace&) = delete;
+    HttpTrace& operator=(const HttpTrace&) = delete;
+
+    // 切换模式；回放时一次性读入整个文件。speed 为回放等待时间的倍数，0 表示不等待
+    bool open(Mode mode, const std::filesystem::path& file, double speed = 1.0);
+    void close();
+
+    Mode mode() const;
+    double speed() const;
+
+    void record(const Entry& entry);
+
+    // 同一 URL 录制了多次时按录制顺序轮流返回
+    bool lookup(const std::string& url, Entry& entry);
+
+    // 解析 "record:<文件>" 或 "replay:<文件>"
+    static bool parseSpec(const std::string& spec, Mode& mode, std::filesystem::path& file);
+
+private:
+    HttpTrace() = default;
+
+    Mode mode_ = Mode::Off;
+    double speed_ = 1.0;
+    std::ofstream output_;
+    std::map<std::string, std::deque<Entry>> entries_;
+    mutable std::mutex mutex_;
+};
+
+#endif // HTTP_TRACE_H
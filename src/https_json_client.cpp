@@ -1,18 +1,105 @@
 #include "https_json_client.h"
+#include <algorithm>
+#include <cstring>
 #include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "http_trace.h"
+#include "rate_limiter.h"
 
 namespace {
 std::once_flag g_curlInitFlag;
+constexpr std::size_t kDefaultMaxBodySize = 64u * 1024 * 1024;
+
+// 退避时间在 [0, min(maxDelay, baseDelay * 2^(attempt-1))] 内均匀随机
+std::chrono::milliseconds backoffDelay(const HTTPSJsonClient::RetryPolicy& policy, int attempt) {
+    std::chrono::milliseconds cap = policy.baseDelay;
+    for (int i = 1; i < attempt && cap < policy.maxDelay; ++i) {
+        cap *= 2;
+    }
+    cap = std::min(cap, policy.maxDelay);
+    if (cap.count() <= 0) {
+        return std::chrono::milliseconds(0);
+    }
+
+    thread_local std::mt19937 generator{std::random_device{}()};
+    std::uniform_int_distribution<long long> distribution(0, cap.count());
+    return std::chrono::milliseconds(distribution(generator));
+}
+
+// 连接被重置、响应不完整之类的瞬时错误；超时不重试，避免放大尾延迟
+bool isTransientError(CURLcode code) {
+    return code == CURLE_GOT_NOTHING || code == CURLE_SEND_ERROR ||
+           code == CURLE_RECV_ERROR || code == CURLE_PARTIAL_FILE;
+}
+
+bool isRetryableStatus(long status) {
+    return status == 429 || status == 502 || status == 503 || status == 504;
+}
+
+// 本机、私有网段、链路本地、运营商 NAT、组播和保留地址（主机字节序）
+bool isPrivateIpv4(std::uint32_t address) {
+    const auto inRange = [address](std::uint32_t network, int prefix) {
+        const std::uint32_t mask = prefix == 0 ? 0 : ~std::uint32_t(0) << (32 - prefix);
+        return (address & mask) == network;
+    };
+    return inRange(0x00000000, 8) || inRange(0x0A000000, 8) || inRange(0x64400000, 10) ||
+           inRange(0x7F000000, 8) || inRange(0xA9FE0000, 16) || inRange(0xAC100000, 12) ||
+           inRange(0xC0000000, 24) || inRange(0xC0A80000, 16) || inRange(0xC6120000, 15) ||
+           inRange(0xE0000000, 4) || inRange(0xF0000000, 4);
+}
+
+bool isPrivateAddress(const struct sockaddr* address) {
+    if (address->sa_family == AF_INET) {
+        const auto* ipv4 = reinterpret_cast<const struct sockaddr_in*>(address);
+        return isPrivateIpv4(ntohl(ipv4->sin_addr.s_addr));
+    }
+    if (address->sa_family == AF_INET6) {
+        const unsigned char* bytes = reinterpret_cast<const struct sockaddr_in6*>(address)->sin6_addr.s6_addr;
+        static const unsigned char kMappedPrefix[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+        if (std::memcmp(bytes, kMappedPrefix, sizeof(kMappedPrefix)) == 0) {
+            const std::uint32_t ipv4 = (static_cast<std::uint32_t>(bytes[12]) << 24) | (static_cast<std::uint32_t>(bytes[13]) << 16) |
+                                       (static_cast<std::uint32_t>(bytes[14]) << 8) | static_cast<std::uint32_t>(bytes[15]);
+            return isPrivateIpv4(ipv4);
+        }
+        static const unsigned char kZero[15] = {};
+        const bool unspecifiedOrLoopback = std::memcmp(bytes, kZero, sizeof(kZero)) == 0 && bytes[15] <= 1;
+        const bool uniqueLocal = (bytes[0] & 0xFE) == 0xFC;
+        const bool linkLocal = bytes[0] == 0xFE && (bytes[1] & 0xC0) == 0x80;
+        const bool multicast = bytes[0] == 0xFF;
+        return unspecifiedOrLoopback || uniqueLocal || linkLocal || multicast;
+    }
+    // 其他协议族（如 Unix 套接字）一律拒绝
+    return true;
+}
 }
 
 HTTPSJsonClient::HTTPSJsonClient()
     : curl_(nullptr)
+    , lastErrorCode_(CURLE_OK)
     , headers_(nullptr)
     , lastStatusCode_(0)
     , connectTimeout_(10L)
     , requestTimeout_(30L)
     , verifySSL_(true)
-    , userAgent_("HTTPSJsonClient/1.0") {
+    , userAgent_("HTTPSJsonClient/1.0")
+    , accept_("application/json")
+    , compression_(true)
+    , maxBodySize_(kDefaultMaxBodySize)
+    , lastDeliveredChunks_(false)
+    , traced_(false)
+    , rateLimiter_(nullptr)
+    , deadline_(std::chrono::steady_clock::time_point::max())
+    , cancelFlag_(nullptr)
+    , lastRetryAfter_(0)
+    , lastAttempts_(0)
+    , lastThrottled_(false)
+    , blockPrivateAddresses_(false)
+    , blockedAddress_(false) {
     std::call_once(g_curlInitFlag, []() {
         curl_global_init(CURL_GLOBAL_DEFAULT);
     });
@@ -45,9 +132,118 @@ void HTTPSJsonClient::setUserAgent(const std::string& ua) {
     userAgent_ = ua;
 }
 
-size_t HTTPSJsonClient::writeCallback(void* contents, size_t size, size_t nmemb, std::string* output) {
-    size_t totalSize = size * nmemb;
-    output->append(static_cast<char*>(contents), totalSize);
+void HTTPSJsonClient::setAccept(const std::string& accept) {
+    accept_ = accept;
+}
+
+void HTTPSJsonClient::setRange(const std::string& range) {
+    range_ = range;
+}
+
+void HTTPSJsonClient::setCompression(bool enabled) {
+    compression_ = enabled;
+}
+
+void HTTPSJsonClient::setMaxBodySize(std::size_t bytes) {
+    maxBodySize_ = bytes;
+}
+
+void HTTPSJsonClient::setChunkCallback(ChunkCallback callback) {
+    chunkCallback_ = std::move(callback);
+}
+
+void HTTPSJsonClient::setRetryWaitCallbacks(BeforeRetryWait before, AfterRetryWait after) {
+    beforeRetryWait_ = std::move(before);
+    afterRetryWait_ = std::move(after);
+}
+
+void HTTPSJsonClient::setTraced(bool traced) {
+    traced_ = traced;
+}
+
+void HTTPSJsonClient::setBlockPrivateAddresses(bool block) {
+    blockPrivateAddresses_ = block;
+}
+
+void HTTPSJsonClient::setRetryPolicy(const RetryPolicy& policy) {
+    retryPolicy_ = policy;
+}
+
+void HTTPSJsonClient::setRateLimiter(TokenBucketLimiter* limiter) {
+    rateLimiter_ = limiter;
+}
+
+void HTTPSJsonClient::setDeadline(std::chrono::steady_clock::time_point deadline) {
+    deadline_ = deadline;
+}
+
+void HTTPSJsonClient::setCancelFlag(const std::atomic<bool>* cancelled) {
+    cancelFlag_ = cancelled;
+}
+
+bool HTTPSJsonClient::isCancelled() const {
+    return cancelFlag_ && cancelFlag_->load(std::memory_order_relaxed);
+}
+
+// libcurl 在传输期间（包括等待响应时）至少每秒调用一次，返回非 0 中止传输
+int HTTPSJsonClient::progressCallback(void* userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+    return static_cast<const HTTPSJsonClient*>(userdata)->isCancelled() ? 1 : 0;
+}
+
+// libcurl 在 DNS 解析之后、建立每个连接之前调用，拒绝内网地址时返回 CURL_SOCKET_BAD 使连接失败
+curl_socket_t HTTPSJsonClient::openSocketCallback(void* userdata, curlsocktype, struct curl_sockaddr* address) {
+    auto* client = static_cast<HTTPSJsonClient*>(userdata);
+    if (isPrivateAddress(&address->addr)) {
+        client->blockedAddress_ = true;
+        return CURL_SOCKET_BAD;
+    }
+    return socket(address->family, address->socktype, address->protocol);
+}
+
+size_t HTTPSJsonClient::writeCallback(void* contents, size_t size, size_t nmemb, void* userdata) {
+    WriteState& state = *static_cast<WriteState*>(userdata);
+    const size_t totalSize = size * nmemb;
+    const std::size_t maxBodySize = state.client->maxBodySize_;
+
+    // 收到第一块数据时响应头已经完整：按 Content-Length 预分配，超过上限的直接拒绝
+    if (!state.started) {
+        state.started = true;
+        long status = 0;
+        curl_easy_getinfo(state.curl, CURLINFO_RESPONSE_CODE, &status);
+        state.streaming = state.client->chunkCallback_ && status >= 200 && status < 300;
+
+        curl_off_t contentLength = -1;
+        curl_easy_getinfo(state.curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &contentLength);
+        if (contentLength > 0) {
+            if (maxBodySize > 0 && static_cast<std::size_t>(contentLength) > maxBodySize) {
+                state.tooLarge = true;
+                return 0;
+            }
+            if (!state.streaming) {
+                state.body->reserve(static_cast<std::size_t>(contentLength));
+            }
+        }
+    }
+
+    state.received += totalSize;
+    if (maxBodySize > 0 && state.received > maxBodySize) {
+        state.tooLarge = true;
+        return 0;
+    }
+
+    if (state.streaming) {
+        state.client->lastDeliveredChunks_ = true;
+        if (state.capture) {
+            state.capture->append(static_cast<const char*>(contents), totalSize);
+        }
+        if (!state.client->chunkCallback_(static_cast<const char*>(contents), totalSize)) {
+            state.aborted = true;
+            return 0;
+        }
+        return totalSize;
+    }
+
+    state.body->append(static_cast<const char*>(contents), totalSize);
     return totalSize;
 }
 
@@ -66,6 +262,10 @@ void HTTPSJsonClient::setCommonOptions(CURL* curl, const std::string& url) {
     curl_easy_setopt(curl, CURLOPT_USERAGENT, userAgent_.c_str());
     curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, connectTimeout_);
     curl_easy_setopt(curl, CURLOPT_TIMEOUT, requestTimeout_);
+    curl_easy_setopt(curl, CURLOPT_RANGE, range_.empty() ? nullptr : range_.c_str());
+    // 空字符串表示声明 libcurl 支持的全部编码（gzip、br 等）并自动解压；
+    // Range 请求的区间针对编码后的数据，因此不压缩
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, compression_ && range_.empty() ? "" : nullptr);
 
     // SSL选项
     if (verifySSL_) {
@@ -82,31 +282,112 @@ void HTTPSJsonClient::setCommonOptions(CURL* curl, const std::string& url) {
         headers_ = nullptr;
     }
 
-    // 添加Accept头（表示期望接收JSON）
-    headers_ = curl_slist_append(headers_, "Accept: application/json");
+    // 添加Accept头（默认表示期望接收JSON）
+    const std::string acceptHeader = "Accept: " + accept_;
+    headers_ = curl_slist_append(headers_, acceptHeader.c_str());
 
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers_);
+
+    if (blockPrivateAddresses_) {
+        curl_easy_setopt(curl, CURLOPT_OPENSOCKETFUNCTION, openSocketCallback);
+        curl_easy_setopt(curl, CURLOPT_OPENSOCKETDATA, this);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_OPENSOCKETFUNCTION, nullptr);
+    }
+
+    // 只有可取消的请求才需要进度回调
+    if (cancelFlag_) {
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, progressCallback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, this);
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 1L);
+    }
 }
 
 std::string HTTPSJsonClient::performRequest(CURL* curl) {
     std::string response;
     lastError_.clear();
+    lastErrorCode_ = CURLE_OK;
     lastStatusCode_ = 0;
+    lastTiming_ = RequestTiming();
+    lastTransferSize_ = TransferSize();
+    lastDeliveredChunks_ = false;
+    lastRetryAfter_ = std::chrono::milliseconds(0);
+    blockedAddress_ = false;
 
+    WriteState state;
+    state.client = this;
+    state.curl = curl;
+    state.body = &response;
+    capturedBody_.clear();
+    if (traced_ && HttpTrace::instance().mode() == HttpTrace::Mode::Record) {
+        state.capture = &capturedBody_;
+    }
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &state);
 
     CURLcode res = curl_easy_perform(curl);
 
     if (res != CURLE_OK) {
-        lastError_ = curl_easy_strerror(res);
+        lastErrorCode_ = res;
+        if (state.tooLarge) {
+            lastError_ = "Response body exceeds " + std::to_string(maxBodySize_) + " bytes";
+        } else if (state.aborted) {
+            lastError_ = "Aborted by chunk callback";
+        } else if (res == CURLE_ABORTED_BY_CALLBACK) {
+            lastError_ = "Cancelled";
+        } else if (blockedAddress_) {
+            lastError_ = "Blocked private network address";
+        } else {
+            lastError_ = curl_easy_strerror(res);
+        }
         return "";
     }
 
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &lastStatusCode_);
+    curl_off_t retryAfterSeconds = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_RETRY_AFTER, &retryAfterSeconds) == CURLE_OK && retryAfterSeconds > 0) {
+        lastRetryAfter_ = std::chrono::seconds(retryAfterSeconds);
+    }
+
+    curl_off_t startTransferUs = 0;
+    curl_off_t totalUs = 0;
+    curl_off_t bytesPerSecond = 0;
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransferUs);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &totalUs);
+    curl_easy_getinfo(curl, CURLINFO_SPEED_DOWNLOAD_T, &bytesPerSecond);
+    lastTiming_.startTransferSeconds = static_cast<double>(startTransferUs) / 1e6;
+    lastTiming_.totalSeconds = static_cast<double>(totalUs) / 1e6;
+    lastTiming_.downloadBytesPerSecond = static_cast<double>(bytesPerSecond);
+
+    curl_off_t wireBytes = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &wireBytes);
+    lastTransferSize_.wireBytes = static_cast<std::size_t>(wireBytes);
+    lastTransferSize_.bodyBytes = state.received;
+    struct curl_header* encoding = nullptr;
+    if (curl_easy_header(curl, "Content-Encoding", 0, CURLH_HEADER, -1, &encoding) == CURLHE_OK && encoding) {
+        lastTransferSize_.contentEncoding = encoding->value;
+    }
     return response;
 }
 
+bool HTTPSJsonClient::shouldRetry(std::chrono::milliseconds& retryAfter) const {
+    retryAfter = std::chrono::milliseconds(0);
+    // 已经交给回调的数据无法撤回，不能重试
+    if (lastDeliveredChunks_) {
+        return false;
+    }
+    if (lastErrorCode_ != CURLE_OK) {
+        return isTransientError(lastErrorCode_);
+    }
+    if (!isRetryableStatus(lastStatusCode_)) {
+        return false;
+    }
+    retryAfter = lastRetryAfter_;
+    return true;
+}
+
 // URL编码
 std::string HTTPSJsonClient::urlEncode(const std::string& str) {
     CURL* curl = curl_easy_init();
@@ -124,18 +405,199 @@ std::string HTTPSJsonClient::urlEncode(const std::string& str) {
 }
 
 std::string HTTPSJsonClient::get(const std::string& url) {
-    initCurl();
-    setCommonOptions(curl_, url);
-    curl_easy_setopt(curl_, CURLOPT_HTTPGET, 1L);
-    curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, nullptr);
-    curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, 0L);
-    return performRequest(curl_);
+    const HttpTrace::Mode traceMode = traced_ ? HttpTrace::instance().mode() : HttpTrace::Mode::Off;
+    // 回放同样经过限速、截止时间和重试，只是把网络请求换成录制的响应
+    const bool replay = traceMode == HttpTrace::Mode::Replay;
+    if (!replay) {
+        initCurl();
+        setCommonOptions(curl_, url);
+        // 先清空请求体再设置 HTTPGET：设置 POSTFIELDS 会把请求方法切换为 POST
+        curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, nullptr);
+        curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, 0L);
+        curl_easy_setopt(curl_, CURLOPT_HTTPGET, 1L);
+    }
+
+    const bool hasDeadline = deadline_ != std::chrono::steady_clock::time_point::max();
+    const std::string host = rateLimiter_ ? hostOf(url) : std::string();
+    const int maxAttempts = std::max(1, retryPolicy_.maxAttempts);
+    std::string response;
+    lastAttempts_ = 0;
+    lastThrottled_ = false;
+
+    for (int attempt = 1; attempt <= maxAttempts; ++attempt) {
+        if (isCancelled()) {
+            if (attempt == 1) {
+                lastErrorCode_ = CURLE_ABORTED_BY_CALLBACK;
+                lastStatusCode_ = 0;
+                lastTiming_ = RequestTiming();
+                lastError_ = "Cancelled";
+            }
+            break;
+        }
+
+        // 先检查截止时间再取令牌，已经超时的请求不消耗该主机的令牌
+        const bool expired = hasDeadline && std::chrono::steady_clock::now() >= deadline_;
+        const bool admitted = !expired && (!rateLimiter_ || rateLimiter_->acquire(host, deadline_));
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline_ - std::chrono::steady_clock::now());
+        if (!admitted || (hasDeadline && remaining.count() <= 0)) {
+            // 重试时保留上一次的结果；首次请求没有发出，标记为本地限流，调用方不应计为上游失败
+            if (attempt == 1) {
+                lastErrorCode_ = CURLE_OK;
+                lastStatusCode_ = 0;
+                lastTiming_ = RequestTiming();
+                lastError_ = admitted || expired ? "Deadline exceeded" : "Rate limit wait exceeds deadline";
+                lastThrottled_ = true;
+            }
+            break;
+        }
+
+        long timeoutMs = requestTimeout_ * 1000;
+        if (hasDeadline) {
+            timeoutMs = std::min<long>(timeoutMs, static_cast<long>(remaining.count()));
+        }
+        lastAttempts_ = attempt;
+        if (replay) {
+            response = replayRequest(url, std::chrono::milliseconds(timeoutMs));
+        } else {
+            curl_easy_setopt(curl_, CURLOPT_TIMEOUT_MS, timeoutMs);
+            response = performRequest(curl_);
+        }
+        // 每次尝试分别录制，回放时同一 URL 的多条记录按顺序返回，重试过程得以复现
+        if (traceMode == HttpTrace::Mode::Record) {
+            recordRequest(url, lastDeliveredChunks_ ? capturedBody_ : response);
+        }
+
+        std::chrono::milliseconds retryAfter(0);
+        if (attempt == maxAttempts || isCancelled() || !shouldRetry(retryAfter)) {
+            break;
+        }
+        if (rateLimiter_ && retryAfter.count() > 0) {
+            rateLimiter_->pause(host, retryAfter);
+        }
+
+        const std::chrono::milliseconds delay = std::max(retryAfter, backoffDelay(retryPolicy_, attempt));
+        if (hasDeadline && std::chrono::steady_clock::now() + delay >= deadline_) {
+            break;
+        }
+        if (beforeRetryWait_) {
+            beforeRetryWait_();
+        }
+        std::this_thread::sleep_for(delay);
+        if (afterRetryWait_ && !afterRetryWait_()) {
+            break;
+        }
+    }
+    return response;
+}
+
+void HTTPSJsonClient::recordRequest(const std::string& url, const std::string& body) {
+    HttpTrace::Entry entry;
+    entry.url = url;
+    entry.status = lastStatusCode_;
+    entry.errorCode = static_cast<int>(lastErrorCode_);
+    entry.error = lastError_;
+    entry.startTransferSeconds = lastTiming_.startTransferSeconds;
+    entry.totalSeconds = lastTiming_.totalSeconds;
+    entry.contentEncoding = lastTransferSize_.contentEncoding;
+    entry.wireBytes = lastTransferSize_.wireBytes;
+    entry.retryAfterMs = lastRetryAfter_.count();
+    entry.body = body;
+    HttpTrace::instance().record(entry);
+}
+
+std::string HTTPSJsonClient::replayRequest(const std::string& url, std::chrono::milliseconds timeout) {
+    lastError_.clear();
+    lastErrorCode_ = CURLE_OK;
+    lastStatusCode_ = 0;
+    lastTiming_ = RequestTiming();
+    lastTransferSize_ = TransferSize();
+    lastDeliveredChunks_ = false;
+    lastRetryAfter_ = std::chrono::milliseconds(0);
+
+    HttpTrace::Entry entry;
+    if (!HttpTrace::instance().lookup(url, entry)) {
+        lastErrorCode_ = CURLE_COULDNT_CONNECT;
+        lastError_ = "No recorded response for URL";
+        return "";
+    }
+
+    // 按录制时的耗时等待，同样受本次尝试的超时（已按截止时间收紧）约束
+    const auto limit = std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+    const auto delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(entry.totalSeconds * HttpTrace::instance().speed()));
+    if (delay > limit) {
+        std::this_thread::sleep_for(limit);
+        lastErrorCode_ = CURLE_OPERATION_TIMEDOUT;
+        lastError_ = curl_easy_strerror(lastErrorCode_);
+        return "";
+    }
+    std::this_thread::sleep_for(delay);
+
+    lastErrorCode_ = static_cast<CURLcode>(entry.errorCode);
+    lastError_ = entry.error;
+    lastStatusCode_ = entry.status;
+    lastTiming_.startTransferSeconds = entry.startTransferSeconds;
+    lastTiming_.totalSeconds = entry.totalSeconds;
+    lastTiming_.downloadBytesPerSecond = entry.totalSeconds > 0.0 ? static_cast<double>(entry.wireBytes) / entry.totalSeconds : 0.0;
+    lastTransferSize_.contentEncoding = entry.contentEncoding;
+    lastTransferSize_.wireBytes = entry.wireBytes;
+    lastTransferSize_.bodyBytes = entry.body.size();
+    lastRetryAfter_ = std::chrono::milliseconds(entry.retryAfterMs);
+    if (lastErrorCode_ != CURLE_OK) {
+        return "";
+    }
+    if (maxBodySize_ > 0 && entry.body.size() > maxBodySize_) {
+        lastErrorCode_ = CURLE_WRITE_ERROR;
+        lastError_ = "Response body exceeds " + std::to_string(maxBodySize_) + " bytes";
+        return "";
+    }
+
+    if (chunkCallback_ && lastStatusCode_ >= 200 && lastStatusCode_ < 300) {
+        constexpr std::size_t kChunkBytes = 16 * 1024;
+        lastDeliveredChunks_ = true;
+        for (std::size_t offset = 0; offset < entry.body.size(); offset += kChunkBytes) {
+            if (!chunkCallback_(entry.body.data() + offset, std::min(kChunkBytes, entry.body.size() - offset))) {
+                lastErrorCode_ = CURLE_WRITE_ERROR;
+                lastError_ = "Aborted by chunk callback";
+                break;
+            }
+        }
+        return "";
+    }
+    return entry.body;
 }
 
 std::string HTTPSJsonClient::getLastError() const {
     return lastError_;
 }
 
+CURLcode HTTPSJsonClient::getLastErrorCode() const {
+    return lastErrorCode_;
+}
+
 long HTTPSJsonClient::getLastStatusCode() const {
     return lastStatusCode_;
 }
+
+HTTPSJsonClient::RequestTiming HTTPSJsonClient::getLastTiming() const {
+    return lastTiming_;
+}
+
+HTTPSJsonClient::TransferSize HTTPSJsonClient::getLastTransferSize() const {
+    return lastTransferSize_;
+}
+
+int HTTPSJsonClient::getLastAttempts() const {
+    return lastAttempts_;
+}
+
+bool HTTPSJsonClient::wasThrottled() const {
+    return lastThrottled_;
+}
+
+std::string HTTPSJsonClient::hostOf(const std::string& url) {
+    const std::size_t schemeEnd = url.find("://");
+    const std::size_t hostStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+    const std::size_t hostEnd = url.find_first_of("/?#", hostStart);
+    return url.substr(hostStart, hostEnd == std::string::npos ? std::string::npos : hostEnd - hostStart);
+}
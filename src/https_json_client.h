@@ -2,11 +2,46 @@
 #ifndef HTTPS_JSON_CLIENT_H
 #define HTTPS_JSON_CLIENT_H
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <curl/curl.h>
 
+class TokenBucketLimiter;
+
 class HTTPSJsonClient {
 public:
+    // 最近一次请求的耗时统计
+    struct RequestTiming {
+        double startTransferSeconds = 0.0;   // 首字节到达时间
+        double totalSeconds = 0.0;
+        double downloadBytesPerSecond = 0.0;
+    };
+
+    // 最近一次请求的传输量：wireBytes 为网络上收到的响应体字节数（压缩后），bodyBytes 为解码后的字节数
+    struct TransferSize {
+        std::string contentEncoding;   // 为空表示未压缩
+        std::size_t wireBytes = 0;
+        std::size_t bodyBytes = 0;
+    };
+
+    // GET 请求的重试策略：退避时间在 [0, min(maxDelay, baseDelay * 2^n)] 内随机，
+    // 上游给出 Retry-After 时至少等待该时间
+    struct RetryPolicy {
+        int maxAttempts = 1;
+        std::chrono::milliseconds baseDelay{250};
+        std::chrono::milliseconds maxDelay{4000};
+    };
+
+    // 2xx 响应体的分块回调，返回 false 中止传输
+    using ChunkCallback = std::function<bool(const char* data, std::size_t size)>;
+    // 重试退避的回调：BeforeWait 在退避等待前调用，此时 getLast* 反映刚失败的那次请求；
+    // AfterWait 在等待结束、发出下一次请求前调用，返回 false 时放弃重试
+    using BeforeRetryWait = std::function<void()>;
+    using AfterRetryWait = std::function<bool()>;
+
     // 构造函数
     HTTPSJsonClient();
     // 析构函数
@@ -21,21 +56,74 @@ public:
     void setRequestTimeout(long timeout);      // 请求超时（秒）
     void setVerifySSL(bool verify);            // 是否验证SSL
     void setUserAgent(const std::string& ua);  // 设置User-Agent
+    void setAccept(const std::string& accept); // 设置Accept头（默认application/json）
+    void setRange(const std::string& range);   // 设置Range（如"0-65535"，空字符串表示完整下载）
+    void setCompression(bool enabled);         // 是否协商压缩传输（默认开启，Range 请求始终不压缩）
+    void setMaxBodySize(std::size_t bytes);    // 响应体上限（字节，0 表示不限制），超过时中止请求
+    // 设置后 2xx 响应体交给回调处理，get 不再返回响应体；已交付数据的请求不会重试
+    void setChunkCallback(ChunkCallback callback);
+    void setRetryPolicy(const RetryPolicy& policy);
+    void setRateLimiter(TokenBucketLimiter* limiter); // 按主机限速（不持有所有权，nullptr 表示不限速）
+    // 整个请求（含限速等待和重试）的截止时间，单次请求的超时也不会超过它
+    void setDeadline(std::chrono::steady_clock::time_point deadline);
+    // 取消标志（不持有所有权，nullptr 表示不可取消）：置位后进行中的传输在一秒内中止，且不再重试
+    void setCancelFlag(const std::atomic<bool>* cancelled);
+    // 退避等待期间调用方可以借此归还并重新获取自己的并发名额
+    void setRetryWaitCallbacks(BeforeRetryWait before, AfterRetryWait after);
+    // 参与 HttpTrace 录制/回放（默认关闭，只对搜索等需要复现的请求开启）
+    void setTraced(bool traced);
+    // 拒绝连接解析到回环、链路本地、私有等内网地址的主机（在 DNS 解析之后按实际连接的地址判断）
+    void setBlockPrivateAddresses(bool block);
     // 执行GET请求
     std::string get(const std::string& url);
 
     // 获取最后一次错误信息
     std::string getLastError() const;
 
+    // 获取最后一次请求的CURL错误码（成功时为CURLE_OK）
+    CURLcode getLastErrorCode() const;
+
     // 获取最后一次HTTP状态码
     long getLastStatusCode() const;
 
+    // 获取最后一次请求的耗时统计
+    RequestTiming getLastTiming() const;
+
+    // 获取最后一次请求的传输量和内容编码
+    TransferSize getLastTransferSize() const;
+
+    // 获取最后一次 get 实际发出的请求次数（含重试）
+    int getLastAttempts() const;
+
+    // 最后一次 get 是否因本地限速或截止时间在发出任何请求之前放弃（上游没有收到请求）
+    bool wasThrottled() const;
+
+    // 取 URL 中的主机部分（含端口）
+    static std::string hostOf(const std::string& url);
+
     // URL编码
     std::string urlEncode(const std::string& str);
 
 private:
+    // 单次请求的接收状态
+    struct WriteState {
+        HTTPSJsonClient* client = nullptr;
+        CURL* curl = nullptr;
+        std::string* body = nullptr;
+        std::string* capture = nullptr;   // 录制时保存交给回调的数据
+        std::size_t received = 0;
+        bool started = false;
+        bool streaming = false;     // 是否交给分块回调
+        bool tooLarge = false;
+        bool aborted = false;
+    };
+
     // 静态回调函数
-    static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* output);
+    static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userdata);
+    static int progressCallback(void* userdata, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+    static curl_socket_t openSocketCallback(void* userdata, curlsocktype purpose, struct curl_sockaddr* address);
+
+    bool isCancelled() const;
 
     // 初始化CURL
     void initCurl();
@@ -46,10 +134,22 @@ private:
     // 执行请求
     std::string performRequest(CURL* curl);
 
+    // 回放录制的一次尝试，不访问网络；录制的耗时超过 timeout 时按超时处理
+    std::string replayRequest(const std::string& url, std::chrono::milliseconds timeout);
+
+    // 把最后一次请求的结果写入录制文件
+    void recordRequest(const std::string& url, const std::string& body);
+
+    // 根据最后一次请求的结果判断是否值得重试，retryAfter 返回上游要求的等待时间
+    bool shouldRetry(std::chrono::milliseconds& retryAfter) const;
+
 private:
     CURL* curl_;
     std::string lastError_;
+    CURLcode lastErrorCode_;
     long lastStatusCode_;
+    RequestTiming lastTiming_;
+    TransferSize lastTransferSize_;
     struct curl_slist* headers_;
 
     // 配置选项
@@ -57,6 +157,25 @@ private:
     long requestTimeout_;
     bool verifySSL_;
     std::string userAgent_;
+    std::string accept_;
+    std::string range_;
+    bool compression_;
+    std::size_t maxBodySize_;
+    ChunkCallback chunkCallback_;
+    bool lastDeliveredChunks_;
+    bool traced_;
+    std::string capturedBody_;
+    RetryPolicy retryPolicy_;
+    TokenBucketLimiter* rateLimiter_;
+    std::chrono::steady_clock::time_point deadline_;
+    const std::atomic<bool>* cancelFlag_;
+    BeforeRetryWait beforeRetryWait_;
+    AfterRetryWait afterRetryWait_;
+    std::chrono::milliseconds lastRetryAfter_;   // 最后一次响应的 Retry-After
+    int lastAttempts_;
+    bool lastThrottled_;
+    bool blockPrivateAddresses_;
+    bool blockedAddress_;
 };
 
 #endif // HTTPS_JSON_CLIENT_H
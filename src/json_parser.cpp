@@ -1,4 +1,6 @@
 #include "json_parser.h"
+#include "gzip_stream.h"
+#include "logger.h"
 #include <algorithm>
 #include <chrono>
 #include <ctime>
@@ -13,45 +15,14 @@
 namespace {
 constexpr const char* kLogModule = "JsonParser";
 
-enum class LogLevel {
-    Info,
-    Error
-};
-
-std::mutex logMutex;
-
-template <typename... Args>
-void logMessage(LogLevel level, Args&&... args) {
-    std::ostringstream buffer;
-    (buffer << ... << std::forward<Args>(args));
-
-    const auto now = std::chrono::system_clock::now();
-    const std::time_t nowTime = std::chrono::system_clock::to_time_t(now);
-    std::tm timeInfo{};
-#ifdef _WIN32
-    localtime_s(&timeInfo, &nowTime);
-#else
-    localtime_r(&nowTime, &timeInfo);
-#endif
-
-    std::ostringstream timestamp;
-    timestamp << std::put_time(&timeInfo, "%Y-%m-%d %H:%M:%S");
-
-    std::lock_guard<std::mutex> lock(logMutex);
-    std::ostream& stream = level == LogLevel::Error ? std::cerr : std::cout;
-    stream << '[' << timestamp.str() << "] [" << kLogModule << "] "
-           << (level == LogLevel::Error ? "[ERROR] " : "[INFO] ")
-           << buffer.str() << std::endl;
-}
-
 template <typename... Args>
 void logInfo(Args&&... args) {
-    logMessage(LogLevel::Info, std::forward<Args>(args)...);
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
 }
 
 template <typename... Args>
 void logError(Args&&... args) {
-    logMessage(LogLevel::Error, std::forward<Args>(args)...);
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
 }
 }
 
@@ -61,6 +32,10 @@ bool JsonParser::parseFromFile(const std::string& filePath) {
     isParsed_ = false;
     data_ = json();
 
+    if (gzip::isGzipFile(filePath)) {
+        return parseFromGzipFile(filePath);
+    }
+
     std::ifstream file(filePath);
     if (!file.is_open()) {
         logError("无法打开文件: ", filePath);
@@ -69,15 +44,66 @@ bool JsonParser::parseFromFile(const std::string& filePath) {
 
     try {
         data_ = json::parse(file);
-        source_ = std::filesystem::path(filePath).filename().stem().string();
+        source_ = sourceNameFromPath(filePath);
+        isParsed_ = true;
+        return true;
+    } catch (const json::parse_error& e) {
+        logError("JSON解析错误: file=", filePath, ", error=", e.what());
+        return false;
+    }
+}
+
+bool JsonParser::parseFromString(const std::string& content, const std::string& source) {
+    isParsed_ = false;
+    data_ = json();
+
+    try {
+        data_ = json::parse(content);
+        source_ = source;
+        isParsed_ = true;
+        return true;
+    } catch (const json::parse_error& e) {
+        logError("JSON解析错误: source=", source, ", error=", e.what());
+        return false;
+    }
+}
+
+bool JsonParser::parseFromGzipFile(const std::string& filePath) {
+    GzipInputStreamBuf buffer(filePath);
+    if (!buffer.isOpen()) {
+        logError("无法打开压缩文件: ", filePath);
+        return false;
+    }
+
+    try {
+        // 边解压边解析，不在内存中保留完整的解压结果
+        std::istream stream(&buffer);
+        data_ = json::parse(stream);
+        if (buffer.hasError()) {
+            logError("压缩文件解压失败: file=", filePath);
+            data_ = json();
+            return false;
+        }
+        source_ = sourceNameFromPath(filePath);
         isParsed_ = true;
         return true;
     } catch (const json::parse_error& e) {
         logError("JSON解析错误: file=", filePath, ", error=", e.what());
+        data_ = json();
         return false;
     }
 }
 
+// 去掉 .json / .json.gz 后缀和分页后缀（.page<N>）得到站点文件名
+std::string JsonParser::sourceNameFromPath(const std::string& filePath) {
+    std::filesystem::path fileName = std::filesystem::path(filePath).filename();
+    if (fileName.extension() == ".gz") {
+        fileName = fileName.stem();
+    }
+    const std::string stem = fileName.stem().string();
+    return stem.substr(0, stem.find('.'));
+}
+
 std::vector<VideoInfo> JsonParser::getVideoList() const {
     return getVideoListWithStats().videos;
 }
@@ -107,6 +133,9 @@ VideoParseResult JsonParser::getVideoListWithStats() const {
 VideoInfo JsonParser::parseVideoInfo(const json& videoJson) const {
     VideoInfo info;
     info.source = source_;
+    info.site = source_;
+    // 摘要条目（ac=list）不含 vod_play_url
+    info.detail_loaded = videoJson.contains("vod_play_url");
 
     if (videoJson.contains("vod_id")) info.vod_id = videoJson["vod_id"].get<int>();
     if (videoJson.contains("vod_name")) info.vod_name = videoJson["vod_name"].get<std::string>();
@@ -144,7 +173,7 @@ VideoInfo JsonParser::parseVideoInfo(const json& videoJson) const {
 }
 
 std::vector<std::pair<std::string, std::string>>
-JsonParser::parsePlayUrls(const std::string& playUrlString) const {
+JsonParser::parsePlayUrls(const std::string& playUrlString) {
     std::vector<std::pair<std::string, std::string>> urls;
 
     std::istringstream iss(playUrlString);
@@ -163,7 +192,7 @@ JsonParser::parsePlayUrls(const std::string& playUrlString) const {
 }
 
 // 按分隔符拆分字符串
-std::vector<std::string> JsonParser::splitString(const std::string& str, const std::string& delimiter) const {
+std::vector<std::string> JsonParser::splitString(const std::string& str, const std::string& delimiter) {
     std::vector<std::string> result;
     size_t start = 0;
     size_t end = str.find(delimiter);
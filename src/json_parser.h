@@ -18,6 +18,9 @@ struct VideoInfo {
     std::string vod_pic;
     std::string vod_content;
     std::map<std::string, std::vector<std::pair<std::string, std::string>>> play_urls;
+    double health_score = -1.0;  // 播放可用性评分，-1 表示尚未探测，0 表示探测失败
+    std::string site;            // 站点文件名（域名中的 . 替换为 _），source 换成展示名后仍可定位站点
+    bool detail_loaded = true;   // ac=list 的摘要条目没有播放地址和简介，需要再按 ac=detail 补全
 };
 
 struct VideoParseResult {
@@ -29,26 +32,35 @@ class JsonParser {
 public:
     JsonParser();
 
-    // 从文件解析JSON
+    // 从文件解析JSON，gzip 压缩的文件会自动流式解压
     bool parseFromFile(const std::string& filePath);
 
+    // 解析内存中的响应，source 为站点文件名
+    bool parseFromString(const std::string& content, const std::string& source);
+
     // 获取视频列表
     std::vector<VideoInfo> getVideoList() const;
 
     // 获取视频列表及跳过统计
     VideoParseResult getVideoListWithStats() const;
 
-private:
-    // 解析单个视频信息
-    VideoInfo parseVideoInfo(const json& videoJson) const;
+    // 由缓存文件路径得到站点文件名（去掉 .json、.gz 和分页后缀）
+    static std::string sourceNameFromPath(const std::string& filePath);
 
-    // 解析播放URL
-    std::vector<std::pair<std::string, std::string>>
-    parsePlayUrls(const std::string& playUrlString) const;
+    // 解析播放URL（"第1集$url#第2集$url"）
+    static std::vector<std::pair<std::string, std::string>>
+    parsePlayUrls(const std::string& playUrlString);
 
     // 按分隔符拆分字符串
-    std::vector<std::string>
-    splitString(const std::string& str, const std::string& delimiter) const;
+    static std::vector<std::string>
+    splitString(const std::string& str, const std::string& delimiter);
+
+private:
+    // 解析 gzip 压缩的JSON文件
+    bool parseFromGzipFile(const std::string& filePath);
+
+    // 解析单个视频信息
+    VideoInfo parseVideoInfo(const json& videoJson) const;
 
     json data_;
     std::string source_;
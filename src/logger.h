@@ -0,0 +1,68 @@
+// logger.h
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <utility>
+
+// 带时间戳和模块前缀的日志输出，格式与 WebServer/JsonParser 保持一致：
+// [2026-05-30 12:34:56] [Module] [INFO] ...
+namespace logger {
+
+enum class LogLevel {
+    Info,
+    Error
+};
+
+inline std::mutex& logMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// 是否输出 INFO 日志，基准测试等场景可关闭以免干扰测量
+inline std::atomic<bool>& infoEnabled() {
+    static std::atomic<bool> enabled{true};
+    return enabled;
+}
+
+inline void setInfoEnabled(bool enabled) {
+    infoEnabled().store(enabled, std::memory_order_relaxed);
+}
+
+template <typename... Args>
+void logMessage(const char* module, LogLevel level, Args&&... args) {
+    if (level == LogLevel::Info && !infoEnabled().load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    std::ostringstream buffer;
+    (buffer << ... << std::forward<Args>(args));
+
+    const auto now = std::chrono::system_clock::now();
+    const std::time_t nowTime = std::chrono::system_clock::to_time_t(now);
+    std::tm timeInfo{};
+#ifdef _WIN32
+    localtime_s(&timeInfo, &nowTime);
+#else
+    localtime_r(&nowTime, &timeInfo);
+#endif
+
+    std::ostringstream timestamp;
+    timestamp << std::put_time(&timeInfo, "%Y-%m-%d %H:%M:%S");
+
+    std::lock_guard<std::mutex> lock(logMutex());
+    std::ostream& stream = level == LogLevel::Error ? std::cerr : std::cout;
+    stream << '[' << timestamp.str() << "] [" << module << "] "
+           << (level == LogLevel::Error ? "[ERROR] " : "[INFO] ")
+           << buffer.str() << std::endl;
+}
+
+} // namespace logger
+
+#endif // LOGGER_H
@@ -1,11 +1,63 @@
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include "http_trace.h"
+#include "thread_pool.h"
 #include "web_server.h"
 
+namespace {
+std::string readEnv(const char* name) {
+    const char* value = std::getenv(name);
+    return value ? std::string(value) : std::string();
+}
+
+std::size_t readEnvCount(const char* name, std::size_t fallback) {
+    const std::string value = readEnv(name);
+    if (value.empty()) {
+        return fallback;
+    }
+    try {
+        return static_cast<std::size_t>(std::stoull(value));
+    } catch (const std::exception&) {
+        return fallback;
+    }
+}
+
+std::size_t readEnvMegabytes(const char* name, std::size_t fallback) {
+    return readEnvCount(name, fallback) * 1024 * 1024;
+}
+}
+
 int main() {
+    // MYTV_HTTP_TRACE=record:<文件> 录制搜索请求，replay:<文件> 回放
+    HttpTrace::Mode traceMode = HttpTrace::Mode::Off;
+    std::filesystem::path traceFile;
+    if (HttpTrace::parseSpec(readEnv("MYTV_HTTP_TRACE"), traceMode, traceFile)) {
+        const std::string speed = readEnv("MYTV_HTTP_TRACE_SPEED");
+        HttpTrace::instance().open(traceMode, traceFile, speed.empty() ? 1.0 : std::atof(speed.c_str()));
+    }
+
+    // 共享线程池在第一次提交任务时启动，线程数需在此之前设置
+    ThreadPool::instance().setWorkerCount(readEnvCount("MYTV_WORKER_THREADS", 0));
+
     WebServer webServer;
+    webServer.setFileSyncMode(AtomicFileWriter::parseSyncMode(readEnv("MYTV_FSYNC"), AtomicFileWriter::SyncMode::None));
+    webServer.setCacheCompression(readEnv("MYTV_CACHE_COMPRESSION") == "gzip");
+    webServer.setSearchConcurrency(readEnvCount("MYTV_SEARCH_MAX_CONCURRENCY", 32), readEnvCount("MYTV_SEARCH_PER_HOST_CONCURRENCY", 2));
+    webServer.setProviderRateLimit(readEnvCount("MYTV_PROVIDER_REQUESTS_PER_MINUTE", 120) / 60.0, static_cast<double>(readEnvCount("MYTV_PROVIDER_BURST", 4)));
+    webServer.setSearchRetryAttempts(static_cast<int>(readEnvCount("MYTV_SEARCH_RETRY_ATTEMPTS", 3)));
+    webServer.setSearchPageBudget(readEnvCount("MYTV_SEARCH_MAX_PAGES", 5));
+    webServer.setTwoPhaseSearch(readEnv("MYTV_TWO_PHASE_SEARCH") != "0");
+    webServer.setDetailPrefetchTitles(readEnvCount("MYTV_DETAIL_PREFETCH_TITLES", 24));
+    webServer.setHlsCacheBudget(readEnvMegabytes("MYTV_HLS_MEMORY_MB", 256), readEnvMegabytes("MYTV_HLS_DISK_MB", 2048));
+    webServer.setPosterCacheBudget(readEnvMegabytes("MYTV_IMG_DISK_MB", 512));
+    webServer.setHttpThreads(readEnvCount("MYTV_HTTP_THREADS", 0));
+    webServer.setBackgroundThreads(readEnvCount("MYTV_BACKGROUND_THREADS", 2), readEnvCount("MYTV_SEARCH_QUEUE_LIMIT", 4));
+    webServer.setHlsPrefetchDepth(readEnvCount("MYTV_HLS_PREFETCH_SEGMENTS", 3), readEnvCount("MYTV_HLS_NEXT_EPISODE_SEGMENTS", 2));
 
     auto videoList = webServer.getVideoList();
     webServer.setVideoList(videoList);
 
-    webServer.run(8080);
+    webServer.run(static_cast<int>(readEnvCount("MYTV_PORT", 8080)));
     return 0;
 }
@@ -0,0 +1,354 @@
+#include "poster_cache.h"
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+#include "https_json_client.h"
+#include "logger.h"
+#include "text_util.h"
+#include "thumbnail.h"
+
+namespace {
+constexpr const char* kLogModule = "PosterCache";
+constexpr std::size_t kMaxImageBytes = 10u * 1024 * 1024;
+constexpr std::size_t kMaxResolvedEntries = 8192;
+constexpr int kThumbnailWidths[] = {160, 320, 480, 640};
+// SHA-256 十六进制长度，旧版本以 64 位哈希命名的文件在启动时删除
+constexpr std::size_t kHashLength = 64;
+
+template <typename... Args>
+void logInfo(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+
+// 每个线程复用一个客户端
+HTTPSJsonClient& imageClient() {
+    thread_local HTTPSJsonClient client;
+    thread_local bool configured = false;
+    if (!configured) {
+        client.setUserAgent("Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/122.0.0.0 Safari/537.36");
+        client.setAccept("image/*");
+        client.setConnectTimeout(5);
+        client.setRequestTimeout(20);
+        client.setVerifySSL(true);
+        client.setMaxBodySize(kMaxImageBytes);
+        client.setBlockPrivateAddresses(true);
+        configured = true;
+    }
+    return client;
+}
+
+const char* extensionFor(const std::string& contentType) {
+    if (contentType == "image/png") {
+        return ".png";
+    }
+    if (contentType == "image/gif") {
+        return ".gif";
+    }
+    if (contentType == "image/webp") {
+        return ".webp";
+    }
+    return ".jpg";
+}
+
+bool readFile(const std::filesystem::path& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+std::string makeEtag(const std::string& hash, int width) {
+    return "\"" + hash + "-" + std::to_string(width) + "\"";
+}
+
+void removeFiles(const std::vector<std::string>& files) {
+    for (const auto& file : files) {
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+    }
+}
+}
+
+PosterCache::PosterCache(const std::filesystem::path& cacheDir, std::size_t diskBudget)
+    : urlDir_(cacheDir / "url")
+    , originalDir_(cacheDir / "orig")
+    , thumbnailDir_(cacheDir / "thumb")
+    , diskBudget_(diskBudget) {
+    for (const auto& dir : {urlDir_, originalDir_, thumbnailDir_}) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        if (ec) {
+            logError("无法创建图片缓存目录: ", dir, ", 错误: ", ec.message());
+        }
+    }
+    loadDiskIndex();
+}
+
+void PosterCache::loadDiskIndex() {
+    struct FileInfo {
+        std::string path;
+        std::size_t size;
+        std::filesystem::file_time_type mtime;
+    };
+    std::vector<FileInfo> files;
+
+    for (const auto& dir : {urlDir_, originalDir_, thumbnailDir_}) {
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            const std::string name = entry.path().filename().string();
+            // 临时文件和旧版本的短哈希文件都无法使用
+            if (name.empty() || name[0] == '.' || name.size() < kHashLength ||
+                name.find_first_of(".-") < kHashLength) {
+                std::filesystem::remove(entry.path(), ec);
+                continue;
+            }
+            files.push_back(FileInfo{entry.path().string(),
+                                     static_cast<std::size_t>(entry.file_size(ec)),
+                                     entry.last_write_time(ec)});
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](const FileInfo& a, const FileInfo& b) {
+        return a.mtime < b.mtime;
+    });
+
+    std::vector<std::string> evicted;
+    {
+        std::lock_guard<std::mutex> lock(diskMutex_);
+        for (const auto& file : files) {
+            diskLru_.push_front(file.path);
+            diskEntries_[file.path] = DiskEntry{file.size, diskLru_.begin()};
+            diskBytes_ += file.size;
+        }
+        while (diskBytes_ > diskBudget_ && !diskLru_.empty()) {
+            const std::string victim = diskLru_.back();
+            diskLru_.pop_back();
+            diskBytes_ -= diskEntries_[victim].size;
+            diskEntries_.erase(victim);
+            evicted.push_back(victim);
+        }
+    }
+    removeFiles(evicted);
+
+    logInfo("图片缓存已加载: 文件=", files.size() - evicted.size(), ", 字节=", diskBytes_);
+}
+
+bool PosterCache::storeFile(const std::filesystem::path& path, const std::string& data) {
+    if (!writer_.write(path, data)) {
+        return false;
+    }
+
+    std::vector<std::string> evicted;
+    {
+        std::lock_guard<std::mutex> lock(diskMutex_);
+        const std::string key = path.string();
+        const auto existing = diskEntries_.find(key);
+        if (existing != diskEntries_.end()) {
+            diskBytes_ -= existing->second.size;
+            diskLru_.erase(existing->second.lruIt);
+            diskEntries_.erase(existing);
+        }
+
+        diskLru_.push_front(key);
+        diskEntries_[key] = DiskEntry{data.size(), diskLru_.begin()};
+        diskBytes_ += data.size();
+
+        // 刚写入的文件排在最前，不会被立即淘汰
+        while (diskBytes_ > diskBudget_ && diskLru_.size() > 1) {
+            const std::string victim = diskLru_.back();
+            diskLru_.pop_back();
+            diskBytes_ -= diskEntries_[victim].size;
+            diskEntries_.erase(victim);
+            evicted.push_back(victim);
+        }
+    }
+    removeFiles(evicted);
+    return true;
+}
+
+void PosterCache::touchFile(const std::filesystem::path& path) {
+    std::lock_guard<std::mutex> lock(diskMutex_);
+    const auto it = diskEntries_.find(path.string());
+    if (it != diskEntries_.end()) {
+        diskLru_.splice(diskLru_.begin(), diskLru_, it->second.lruIt);
+    }
+}
+
+int PosterCache::normalizeWidth(int requested) {
+    if (requested <= 0) {
+        return 0;
+    }
+    for (int width : kThumbnailWidths) {
+        if (requested <= width) {
+            return width;
+        }
+    }
+    return kThumbnailWidths[std::size(kThumbnailWidths) - 1];
+}
+
+std::string PosterCache::requestKey(const std::string& src, int width) {
+    return std::to_string(width) + "|" + src;
+}
+
+bool PosterCache::findLocked(const std::string& key, PosterFile& file) {
+    const auto hit = resolved_.find(key);
+    if (hit == resolved_.end()) {
+        return false;
+    }
+    std::error_code ec;
+    if (!std::filesystem::is_regular_file(hit->second.path, ec)) {
+        resolved_.erase(hit);
+        return false;
+    }
+    file = hit->second;
+    touchFile(file.path);
+    return true;
+}
+
+bool PosterCache::find(const std::string& src, int width, PosterFile& file) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return findLocked(requestKey(src, width), file);
+}
+
+bool PosterCache::get(const std::string& src, int width, PosterFile& file) {
+    const std::string key = requestKey(src, width);
+
+    std::promise<PosterFile> promise;
+    std::shared_future<PosterFile> future;
+    bool isOwner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (findLocked(key, file)) {
+            return true;
+        }
+
+        const auto it = inflight_.find(key);
+        if (it != inflight_.end()) {
+            future = it->second;
+        } else {
+            future = promise.get_future().share();
+            inflight_.emplace(key, future);
+            isOwner = true;
+        }
+    }
+
+    if (!isOwner) {
+        file = future.get();
+        return !file.path.empty();
+    }
+
+    PosterFile result;
+    try {
+        result = resolve(src, width);
+    } catch (const std::exception& e) {
+        logError("获取海报异常: src=", src, ", error=", e.what());
+        result = PosterFile();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inflight_.erase(key);
+        if (!result.path.empty()) {
+            if (resolved_.size() >= kMaxResolvedEntries) {
+                resolved_.clear();
+            }
+            resolved_[key] = result;
+        }
+    }
+    promise.set_value(result);
+
+    file = result;
+    return !file.path.empty();
+}
+
+std::filesystem::path PosterCache::originalPath(const Original& original) const {
+    return originalDir_ / (original.hash + extensionFor(original.contentType));
+}
+
+bool PosterCache::loadOriginal(const std::string& src, Original& original, std::string& data) {
+    const std::filesystem::path linkPath = urlDir_ / text::sha256Hex(src);
+
+    // 已下载过的地址通过索引文件找到原图
+    std::string link;
+    if (readFile(linkPath, link)) {
+        std::istringstream stream(link);
+        if (stream >> original.hash >> original.contentType) {
+            std::error_code ec;
+            if (std::filesystem::is_regular_file(originalPath(original), ec)) {
+                touchFile(linkPath);
+                touchFile(originalPath(original));
+                return true;
+            }
+        }
+    }
+
+    HTTPSJsonClient& client = imageClient();
+    data = client.get(src);
+    const long status = client.getLastStatusCode();
+    if (status != 200 || data.empty()) {
+        logError("海报下载失败: src=", src, ", error=", client.getLastError(), ", status=", status);
+        return false;
+    }
+
+    original.contentType = thumbnail::detectContentType(data);
+    if (original.contentType.empty()) {
+        logError("海报不是可识别的图片: src=", src);
+        return false;
+    }
+    original.hash = text::sha256Hex(data);
+
+    if (!storeFile(originalPath(original), data) ||
+        !storeFile(linkPath, original.hash + " " + original.contentType + "\n")) {
+        logError("海报写入缓存失败: src=", src);
+        return false;
+    }
+    return true;
+}
+
+PosterFile PosterCache::resolve(const std::string& src, int width) {
+    Original original;
+    std::string data;
+    if (!loadOriginal(src, original, data)) {
+        return PosterFile();
+    }
+
+    PosterFile originalFile{originalPath(original), original.contentType, makeEtag(original.hash, 0)};
+    if (width <= 0 || !thumbnail::canResize(original.contentType)) {
+        return originalFile;
+    }
+
+    PosterFile thumbnailFile{
+        thumbnailDir_ / (original.hash + "-" + std::to_string(width) + ".jpg"),
+        "image/jpeg",
+        makeEtag(original.hash, width)};
+    std::error_code ec;
+    if (std::filesystem::is_regular_file(thumbnailFile.path, ec)) {
+        touchFile(thumbnailFile.path);
+        return thumbnailFile;
+    }
+
+    if (data.empty() && !readFile(originalFile.path, data)) {
+        return PosterFile();
+    }
+
+    std::string output;
+    if (!thumbnail::makeJpegThumbnail(data, width, output) || !storeFile(thumbnailFile.path, output)) {
+        // 无法生成缩略图时退回原图
+        logError("缩略图生成失败，使用原图: src=", src, ", width=", width);
+        return originalFile;
+    }
+    return thumbnailFile;
+}
@@ -0,0 +1,86 @@
+// poster_cache.h
+#ifndef POSTER_CACHE_H
+#define POSTER_CACHE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "atomic_file_writer.h"
+
+// 可直接发送的海报文件
+struct PosterFile {
+    std::filesystem::path path;
+    std::string contentType;
+    std::string etag;
+};
+
+// 海报图片缓存：原图按内容哈希保存，缩略图按“内容哈希-宽度”保存，
+// 不同站点引用同一张图片时只保存一份。哈希均为 SHA-256，命中即说明地址或内容相同。磁盘布局：
+//   url/<地址哈希>            记录地址对应的内容哈希和类型
+//   orig/<内容哈希>.<扩展名>   原图
+//   thumb/<内容哈希>-<宽度>.jpg 缩略图
+// 三个目录的文件总大小超过磁盘预算时，按最近使用时间淘汰最旧的文件。
+class PosterCache {
+public:
+    PosterCache(const std::filesystem::path& cacheDir, std::size_t diskBudget);
+
+    // 禁用拷贝和赋值
+    PosterCache(const PosterCache&) = delete;
+    PosterCache& operator=(const PosterCache&) = delete;
+
+    // 获取海报文件，width 为 0 时返回原图；下载或解析失败时返回 false
+    bool get(const std::string& src, int width, PosterFile& file);
+
+    // 只查询已解析过的请求，不读取索引文件也不下载；命中时返回 true
+    bool find(const std::string& src, int width, PosterFile& file);
+
+    // 将请求的宽度归一到固定的几档，限制缩略图的变体数量
+    static int normalizeWidth(int requested);
+
+private:
+    struct Original {
+        std::string hash;
+        std::string contentType;
+    };
+
+    struct DiskEntry {
+        std::size_t size = 0;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    static std::string requestKey(const std::string& src, int width);
+    // 调用方需持有 mutex_
+    bool findLocked(const std::string& key, PosterFile& file);
+    PosterFile resolve(const std::string& src, int width);
+    bool loadOriginal(const std::string& src, Original& original, std::string& data);
+    std::filesystem::path originalPath(const Original& original) const;
+
+    // 启动时扫描缓存目录，按修改时间恢复使用顺序
+    void loadDiskIndex();
+    // 写入文件并计入磁盘预算，超出时淘汰最久未使用的文件
+    bool storeFile(const std::filesystem::path& path, const std::string& data);
+    void touchFile(const std::filesystem::path& path);
+
+    std::filesystem::path urlDir_;
+    std::filesystem::path originalDir_;
+    std::filesystem::path thumbnailDir_;
+    AtomicFileWriter writer_;
+
+    std::size_t diskBudget_;
+    std::size_t diskBytes_ = 0;
+    std::list<std::string> diskLru_;
+    std::unordered_map<std::string, DiskEntry> diskEntries_;
+    std::mutex diskMutex_;
+
+    // 已解析过的请求直接返回文件路径，命中时只需一次文件发送
+    std::unordered_map<std::string, PosterFile> resolved_;
+    std::unordered_map<std::string, std::shared_future<PosterFile>> inflight_;
+    std::mutex mutex_;
+};
+
+#endif // POSTER_CACHE_H
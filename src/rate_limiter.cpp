@@ -0,0 +1,82 @@
+#include "rate_limiter.h"
+#include <algorithm>
+#include <iterator>
+#include <thread>
+
+namespace {
+// 超过该数量的桶时清理已经补满的空闲桶
+constexpr std::size_t kMaxIdleBuckets = 1024;
+
+TokenBucketLimiter::Config sanitize(TokenBucketLimiter::Config config) {
+    config.ratePerSecond = std::max(0.01, config.ratePerSecond);
+    config.burst = std::max(1.0, config.burst);
+    return config;
+}
+}
+
+TokenBucketLimiter::TokenBucketLimiter(const Config& config)
+    : config_(sanitize(config)) {
+}
+
+TokenBucketLimiter::Bucket& TokenBucketLimiter::bucketFor(const std::string& key, Clock::time_point now) {
+    auto it = buckets_.find(key);
+    if (it == buckets_.end()) {
+        if (buckets_.size() >= kMaxIdleBuckets) {
+            for (auto bucket = buckets_.begin(); bucket != buckets_.end();) {
+                const double elapsed = std::chrono::duration<double>(now - bucket->second.updatedAt).count();
+                const bool full = bucket->second.tokens + elapsed * config_.ratePerSecond >= config_.burst;
+                bucket = full && bucket->second.pausedUntil <= now ? buckets_.erase(bucket) : std::next(bucket);
+            }
+        }
+        Bucket bucket;
+        bucket.tokens = config_.burst;
+        bucket.updatedAt = now;
+        it = buckets_.emplace(key, bucket).first;
+    }
+
+    Bucket& bucket = it->second;
+    const double elapsed = std::chrono::duration<double>(now - bucket.updatedAt).count();
+    bucket.tokens = std::min(config_.burst, bucket.tokens + elapsed * config_.ratePerSecond);
+    bucket.updatedAt = now;
+    return bucket;
+}
+
+bool TokenBucketLimiter::acquire(const std::string& key, Clock::time_point deadline) {
+    Clock::time_point readyAt;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Clock::time_point now = Clock::now();
+        Bucket& bucket = bucketFor(key, now);
+
+        // 令牌允许透支：负数表示已有请求在排队，新请求排在它们之后
+        const double missing = std::max(0.0, 1.0 - bucket.tokens);
+        readyAt = std::max(now + std::chrono::duration_cast<Clock::duration>(
+                                     std::chrono::duration<double>(missing / config_.ratePerSecond)),
+                           bucket.pausedUntil);
+        // 恰好在截止时间才可用的令牌也不预订，否则请求已没有时间发出
+        if (readyAt >= deadline) {
+            return false;
+        }
+        bucket.tokens -= 1.0;
+    }
+
+    std::this_thread::sleep_until(readyAt);
+    return true;
+}
+
+void TokenBucketLimiter::pause(const std::string& key, std::chrono::milliseconds delay) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Clock::time_point now = Clock::now();
+    Bucket& bucket = bucketFor(key, now);
+    bucket.pausedUntil = std::max(bucket.pausedUntil, now + delay);
+}
+
+void TokenBucketLimiter::setConfig(const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = sanitize(config);
+}
+
+TokenBucketLimiter::Config TokenBucketLimiter::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
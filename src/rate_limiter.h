@@ -0,0 +1,50 @@
+// rate_limiter.h
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// 按主机的令牌桶限速：每个主机以固定速率补充令牌，最多积攒 burst 个；
+// 上游返回 Retry-After 时可暂停该主机，在指定时间之前不再发放令牌。
+class TokenBucketLimiter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Config {
+        double ratePerSecond = 2.0;
+        double burst = 4.0;
+    };
+
+    explicit TokenBucketLimiter(const Config& config);
+
+    // 禁用拷贝和赋值
+    TokenBucketLimiter(const TokenBucketLimiter&) = delete;
+    TokenBucketLimiter& operator=(const TokenBucketLimiter&) = delete;
+
+    // 为 key 预订一个令牌并等待到可用时刻；不能在 deadline 之前可用时不预订，直接返回 false
+    bool acquire(const std::string& key, Clock::time_point deadline);
+
+    // 在 delay 之内不再为 key 发放令牌
+    void pause(const std::string& key, std::chrono::milliseconds delay);
+
+    void setConfig(const Config& config);
+    Config getConfig() const;
+
+private:
+    struct Bucket {
+        double tokens = 0.0;
+        Clock::time_point updatedAt;
+        Clock::time_point pausedUntil;
+    };
+
+    Bucket& bucketFor(const std::string& key, Clock::time_point now);
+
+    Config config_;
+    std::unordered_map<std::string, Bucket> buckets_;
+    mutable std::mutex mutex_;
+};
+
+#endif // RATE_LIMITER_H
@@ -0,0 +1,235 @@
+#include "search_job.h"
+#include <algorithm>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <utility>
+
+namespace {
+// 已结束的任务保留的时间和数量
+constexpr auto kFinishedJobTtl = std::chrono::minutes(10);
+constexpr std::size_t kMaxFinishedJobs = 32;
+}
+
+SearchJob::SearchJob(std::string id, std::string keyword)
+    : id_(std::move(id))
+    , keyword_(std::move(keyword))
+    , createdAt_(std::chrono::steady_clock::now()) {
+}
+
+const std::string& SearchJob::id() const {
+    return id_;
+}
+
+const std::string& SearchJob::keyword() const {
+    return keyword_;
+}
+
+bool SearchJob::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ != State::Queued && state_ != State::Running) {
+        return false;
+    }
+    cancelled_.store(true);
+    return true;
+}
+
+bool SearchJob::isCancelled() const {
+    return cancelled_.load();
+}
+
+const std::atomic<bool>* SearchJob::cancelFlag() const {
+    return &cancelled_;
+}
+
+void SearchJob::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (state_ == State::Queued) {
+        state_ = State::Running;
+    }
+}
+
+void SearchJob::addSite(const std::string& site, const std::string& name, bool skipped) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (siteIndex_.count(site) > 0) {
+        return;
+    }
+    SiteProgress progress;
+    progress.site = site;
+    progress.name = name;
+    progress.skipped = skipped;
+    siteIndex_[site] = sites_.size();
+    sites_.push_back(std::move(progress));
+}
+
+void SearchJob::pageQueued(const std::string& site) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (SiteProgress* progress = findSite(site)) {
+        progress->pagesPending++;
+    }
+}
+
+void SearchJob::pageFinished(const std::string& site, std::size_t page, bool succeeded, bool saved) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SiteProgress* progress = findSite(site);
+    if (!progress) {
+        return;
+    }
+    if (progress->pagesPending > 0) {
+        progress->pagesPending--;
+    }
+    progress->pagesDone++;
+    if (saved) {
+        progress->savedFiles++;
+    }
+    if (page == 1 && !succeeded) {
+        progress->failed = true;
+    }
+}
+
+void SearchJob::finish(State state, const std::string& message, std::size_t titles) {
+    std::vector<std::function<void()>> callbacks;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        state_ = state;
+        message_ = message;
+        titles_ = titles;
+        finishedAt_ = std::chrono::steady_clock::now();
+        // 取消后未发出的分页不会再返回
+        for (auto& progress : sites_) {
+            progress.pagesPending = 0;
+        }
+        callbacks.swap(finishCallbacks_);
+    }
+    for (auto& callback : callbacks) {
+        callback();
+    }
+}
+
+bool SearchJob::isFinished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ != State::Queued && state_ != State::Running;
+}
+
+std::chrono::steady_clock::time_point SearchJob::finishedAt() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return finishedAt_;
+}
+
+void SearchJob::onFinished(std::function<void()> callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (state_ == State::Queued || state_ == State::Running) {
+            finishCallbacks_.push_back(std::move(callback));
+            return;
+        }
+    }
+    callback();
+}
+
+SearchJob::Snapshot SearchJob::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snapshot;
+    snapshot.id = id_;
+    snapshot.keyword = keyword_;
+    snapshot.state = state_;
+    snapshot.message = message_;
+    snapshot.sites = sites_;
+    snapshot.titles = titles_;
+    const bool finished = state_ != State::Queued && state_ != State::Running;
+    snapshot.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        (finished ? finishedAt_ : std::chrono::steady_clock::now()) - createdAt_);
+    return snapshot;
+}
+
+const char* SearchJob::stateName(State state) {
+    switch (state) {
+    case State::Queued:
+        return "queued";
+    case State::Running:
+        return "running";
+    case State::Completed:
+        return "completed";
+    case State::Failed:
+        return "failed";
+    case State::Cancelled:
+        return "cancelled";
+    }
+    return "unknown";
+}
+
+SearchJob::SiteProgress* SearchJob::findSite(const std::string& site) {
+    const auto it = siteIndex_.find(site);
+    return it == siteIndex_.end() ? nullptr : &sites_[it->second];
+}
+
+SearchJobRegistry::SearchJobRegistry() {
+    std::random_device device;
+    std::seed_seq seed{device(), device(), device(), device()};
+    idRandom_.seed(seed);
+}
+
+std::shared_ptr<SearchJob> SearchJobRegistry::create(const std::string& keyword) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    prune();
+
+    // 每个 ID 都带新的 64 位随机数，看到一个 ID 也无法推出其他任务的 ID；末尾的序号保证不重复
+    std::ostringstream id;
+    id << std::hex << std::setfill('0') << std::setw(16) << idRandom_()
+       << std::setw(8) << nextId_++;
+    auto job = std::make_shared<SearchJob>(id.str(), keyword);
+    jobs_[job->id()] = job;
+    return job;
+}
+
+std::shared_ptr<SearchJob> SearchJobRegistry::find(const std::string& id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = jobs_.find(id);
+    return it == jobs_.end() ? nullptr : it->second;
+}
+
+std::shared_ptr<SearchJob> SearchJobRegistry::findActive(const std::string& keyword) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [id, job] : jobs_) {
+        if (job->keyword() == keyword && !job->isFinished() && !job->isCancelled()) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+std::size_t SearchJobRegistry::cancelActive() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::size_t cancelled = 0;
+    for (const auto& [id, job] : jobs_) {
+        if (job->cancel()) {
+            cancelled++;
+        }
+    }
+    return cancelled;
+}
+
+void SearchJobRegistry::prune() {
+    const auto now = std::chrono::steady_clock::now();
+    std::vector<std::pair<std::chrono::steady_clock::time_point, std::string>> finished;
+    for (auto it = jobs_.begin(); it != jobs_.end();) {
+        if (!it->second->isFinished()) {
+            ++it;
+            continue;
+        }
+        const auto finishedAt = it->second->finishedAt();
+        if (now - finishedAt > kFinishedJobTtl) {
+            it = jobs_.erase(it);
+            continue;
+        }
+        finished.emplace_back(finishedAt, it->first);
+        ++it;
+    }
+
+    if (finished.size() > kMaxFinishedJobs) {
+        std::sort(finished.begin(), finished.end());
+        for (std::size_t i = 0; i + kMaxFinishedJobs < finished.size(); ++i) {
+            jobs_.erase(finished[i].second);
+        }
+    }
+}
@@ -0,0 +1,124 @@
+// search_job.h
+#ifndef SEARCH_JOB_H
+#define SEARCH_JOB_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// 一次异步搜索的状态和进度。搜索线程更新进度，HTTP 请求读取快照或请求取消；所有方法线程安全
+class SearchJob {
+public:
+    enum class State {
+        Queued,      // 等待上一次搜索结束
+        Running,
+        Completed,
+        Failed,
+        Cancelled
+    };
+
+    struct SiteProgress {
+        std::string site;            // source.json 中的站点键
+        std::string name;
+        bool skipped = false;        // 熔断中，未发起请求
+        bool failed = false;         // 第一页请求失败
+        std::size_t pagesDone = 0;
+        std::size_t pagesPending = 0;
+        std::size_t savedFiles = 0;
+    };
+
+    struct Snapshot {
+        std::string id;
+        std::string keyword;
+        State state = State::Queued;
+        std::string message;
+        std::vector<SiteProgress> sites;
+        std::size_t titles = 0;      // 完成后目录中的标题数
+        std::chrono::milliseconds elapsed{0};
+    };
+
+    SearchJob(std::string id, std::string keyword);
+
+    // 禁用拷贝和赋值
+    SearchJob(const SearchJob&) = delete;
+    SearchJob& operator=(const SearchJob&) = delete;
+
+    const std::string& id() const;
+    const std::string& keyword() const;
+
+    // 请求取消，返回任务此前是否还未结束
+    bool cancel();
+    bool isCancelled() const;
+    // 交给 HTTPSJsonClient，置位后进行中的传输会中止
+    const std::atomic<bool>* cancelFlag() const;
+
+    // 以下由搜索线程调用
+    void start();
+    void addSite(const std::string& site, const std::string& name, bool skipped);
+    void pageQueued(const std::string& site);
+    void pageFinished(const std::string& site, std::size_t page, bool succeeded, bool saved);
+    void finish(State state, const std::string& message, std::size_t titles = 0);
+
+    bool isFinished() const;
+    std::chrono::steady_clock::time_point finishedAt() const;
+    // 任务结束时在结束它的线程上调用 callback；已经结束时立即在当前线程调用
+    void onFinished(std::function<void()> callback);
+
+    Snapshot snapshot() const;
+
+    static const char* stateName(State state);
+
+private:
+    SiteProgress* findSite(const std::string& site);
+
+    const std::string id_;
+    const std::string keyword_;
+    std::atomic<bool> cancelled_{false};
+    State state_ = State::Queued;
+    std::string message_;
+    std::vector<SiteProgress> sites_;
+    std::map<std::string, std::size_t> siteIndex_;
+    std::size_t titles_ = 0;
+    std::chrono::steady_clock::time_point createdAt_;
+    std::chrono::steady_clock::time_point finishedAt_;
+    std::vector<std::function<void()>> finishCallbacks_;
+    mutable std::mutex mutex_;
+};
+
+// 按 ID 保存最近的搜索任务；已结束的任务保留一段时间供查询，之后清理
+class SearchJobRegistry {
+public:
+    SearchJobRegistry();
+
+    // 禁用拷贝和赋值
+    SearchJobRegistry(const SearchJobRegistry&) = delete;
+    SearchJobRegistry& operator=(const SearchJobRegistry&) = delete;
+
+    std::shared_ptr<SearchJob> create(const std::string& keyword);
+    std::shared_ptr<SearchJob> find(const std::string& id) const;
+
+    // 查找同一关键词尚未结束且未被取消的任务，没有时返回 nullptr
+    std::shared_ptr<SearchJob> findActive(const std::string& keyword) const;
+
+    // 服务关闭时取消所有未结束的任务，返回取消的数量
+    std::size_t cancelActive();
+
+private:
+    void prune();
+
+    std::map<std::string, std::shared_ptr<SearchJob>> jobs_;
+    std::uint64_t nextId_ = 1;
+    // 每个 ID 取 64 位随机数，只播种一次，由 mutex_ 保护
+    std::mt19937_64 idRandom_;
+    mutable std::mutex mutex_;
+};
+
+#endif // SEARCH_JOB_H
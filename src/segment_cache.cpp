@@ -0,0 +1,300 @@
+#include "segment_cache.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "logger.h"
+#include "text_util.h"
+
+namespace {
+constexpr const char* kLogModule = "SegmentCache";
+constexpr const char* kSegmentExtension = ".seg";
+// 缓存键为 URL 的 SHA-256（64 位十六进制），不同 URL 不会映射到同一个文件
+constexpr std::size_t kKeyLength = 64;
+
+std::string cacheKey(const std::string& url) {
+    return text::sha256Hex(url);
+}
+
+template <typename... Args>
+void logInfo(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+
+void removeFiles(const std::vector<std::filesystem::path>& files) {
+    for (const auto& file : files) {
+        std::error_code ec;
+        std::filesystem::remove(file, ec);
+    }
+}
+}
+
+SegmentCache::SegmentCache(const std::filesystem::path& cacheDir, std::size_t memoryBudget, std::size_t diskBudget)
+    : cacheDir_(cacheDir)
+    , memoryBudget_(memoryBudget)
+    , diskBudget_(diskBudget) {
+    loadDiskIndex();
+}
+
+std::filesystem::path SegmentCache::diskPath(const std::string& url) const {
+    return cacheDir_ / (cacheKey(url) + kSegmentExtension);
+}
+
+void SegmentCache::loadDiskIndex() {
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir_, ec);
+    if (ec) {
+        logError("无法创建缓存目录: ", cacheDir_, ", 错误: ", ec.message());
+        return;
+    }
+
+    struct FileInfo {
+        std::string key;
+        std::size_t size;
+        std::filesystem::file_time_type mtime;
+    };
+    std::vector<FileInfo> files;
+
+    for (const auto& entry : std::filesystem::directory_iterator(cacheDir_, ec)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        const std::string name = entry.path().filename().string();
+        if (!name.empty() && name[0] == '.') {
+            // 上次异常退出遗留的临时文件
+            std::filesystem::remove(entry.path(), ec);
+            continue;
+        }
+        if (entry.path().extension() != kSegmentExtension) {
+            continue;
+        }
+        if (entry.path().stem().string().size() != kKeyLength) {
+            // 旧版本以 64 位哈希命名的文件无法校验来源，直接删除
+            std::filesystem::remove(entry.path(), ec);
+            continue;
+        }
+        files.push_back(FileInfo{entry.path().stem().string(),
+                                 static_cast<std::size_t>(entry.file_size(ec)),
+                                 entry.last_write_time(ec)});
+    }
+
+    std::sort(files.begin(), files.end(), [](const FileInfo& a, const FileInfo& b) {
+        return a.mtime < b.mtime;
+    });
+
+    std::vector<std::filesystem::path> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& file : files) {
+            diskLru_.push_front(file.key);
+            diskEntries_[file.key] = DiskEntry{file.size, diskLru_.begin()};
+            diskBytes_ += file.size;
+        }
+        while (diskBytes_ > diskBudget_ && !diskLru_.empty()) {
+            const std::string key = diskLru_.back();
+            diskLru_.pop_back();
+            diskBytes_ -= diskEntries_[key].size;
+            diskEntries_.erase(key);
+            evicted.push_back(cacheDir_ / (key + kSegmentExtension));
+        }
+    }
+    removeFiles(evicted);
+
+    logInfo("磁盘缓存已加载: 目录=", cacheDir_, ", 文件=", files.size() - evicted.size(), ", 字节=", diskBytes_);
+}
+
+SegmentCache::Data SegmentCache::lookupMemory(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = memoryEntries_.find(key);
+    if (it == memoryEntries_.end()) {
+        return nullptr;
+    }
+
+    memoryLru_.splice(memoryLru_.begin(), memoryLru_, it->second.lruIt);
+    stats_.memoryHits++;
+    return it->second.data;
+}
+
+void SegmentCache::storeInMemory(const std::string& key, const Data& data) {
+    // 单个对象超过内存预算的四分之一时只放磁盘，避免把热点数据全部挤出
+    if (!data || data->size() > memoryBudget_ / 4) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto existing = memoryEntries_.find(key);
+    if (existing != memoryEntries_.end()) {
+        memoryBytes_ -= existing->second.data->size();
+        memoryLru_.erase(existing->second.lruIt);
+        memoryEntries_.erase(existing);
+    }
+
+    memoryLru_.push_front(key);
+    memoryEntries_[key] = MemoryEntry{data, memoryLru_.begin()};
+    memoryBytes_ += data->size();
+
+    while (memoryBytes_ > memoryBudget_ && !memoryLru_.empty()) {
+        const std::string victim = memoryLru_.back();
+        memoryLru_.pop_back();
+        memoryBytes_ -= memoryEntries_[victim].data->size();
+        memoryEntries_.erase(victim);
+    }
+}
+
+SegmentCache::Data SegmentCache::loadFromDisk(const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = diskEntries_.find(key);
+        if (it == diskEntries_.end()) {
+            return nullptr;
+        }
+        diskLru_.splice(diskLru_.begin(), diskLru_, it->second.lruIt);
+    }
+
+    const std::filesystem::path path = cacheDir_ / (key + kSegmentExtension);
+    std::ifstream file(path, std::ios::binary);
+    auto content = std::make_shared<std::string>();
+    if (file) {
+        content->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file) {
+        // 文件已被外部删除或淘汰，从索引中移除
+        const auto it = diskEntries_.find(key);
+        if (it != diskEntries_.end()) {
+            diskBytes_ -= it->second.size;
+            diskLru_.erase(it->second.lruIt);
+            diskEntries_.erase(it);
+        }
+        return nullptr;
+    }
+
+    stats_.diskHits++;
+    return content;
+}
+
+void SegmentCache::storeOnDisk(const std::string& key, const std::string& data) {
+    if (data.size() > diskBudget_) {
+        return;
+    }
+
+    const std::filesystem::path path = cacheDir_ / (key + kSegmentExtension);
+    if (!writer_.write(path, data)) {
+        return;
+    }
+
+    std::vector<std::filesystem::path> evicted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto existing = diskEntries_.find(key);
+        if (existing != diskEntries_.end()) {
+            diskBytes_ -= existing->second.size;
+            diskLru_.erase(existing->second.lruIt);
+            diskEntries_.erase(existing);
+        }
+
+        diskLru_.push_front(key);
+        diskEntries_[key] = DiskEntry{data.size(), diskLru_.begin()};
+        diskBytes_ += data.size();
+
+        while (diskBytes_ > diskBudget_ && !diskLru_.empty()) {
+            const std::string victim = diskLru_.back();
+            diskLru_.pop_back();
+            diskBytes_ -= diskEntries_[victim].size;
+            diskEntries_.erase(victim);
+            evicted.push_back(cacheDir_ / (victim + kSegmentExtension));
+        }
+    }
+    removeFiles(evicted);
+}
+
+SegmentCache::Data SegmentCache::getOrFetch(const std::string& url, const Fetcher& fetcher) {
+    const std::string key = cacheKey(url);
+    if (Data hit = lookupMemory(key)) {
+        return hit;
+    }
+
+    std::promise<Data> promise;
+    std::shared_future<Data> future;
+    bool isOwner = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto it = inflight_.find(key);
+        if (it != inflight_.end()) {
+            future = it->second;
+            stats_.sharedWaits++;
+        } else {
+            future = promise.get_future().share();
+            inflight_.emplace(key, future);
+            isOwner = true;
+        }
+    }
+
+    if (!isOwner) {
+        return future.get();
+    }
+
+    Data data;
+    try {
+        data = loadFromDisk(key);
+        if (!data) {
+            data = fetcher(url);
+            if (data) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stats_.upstreamFetches++;
+                }
+                storeOnDisk(key, *data);
+            }
+        }
+        storeInMemory(key, data);
+    } catch (const std::exception& e) {
+        logError("获取缓存内容异常: url=", url, ", error=", e.what());
+        data = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        inflight_.erase(key);
+    }
+    promise.set_value(data);
+    return data;
+}
+
+bool SegmentCache::contains(const std::string& url) const {
+    const std::string key = cacheKey(url);
+    std::lock_guard<std::mutex> lock(mutex_);
+    return memoryEntries_.count(key) > 0 || diskEntries_.count(key) > 0;
+}
+
+bool SegmentCache::lookup(const std::string& url, Data& data, std::filesystem::path& file) {
+    const std::string key = cacheKey(url);
+    if ((data = lookupMemory(key))) {
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = diskEntries_.find(key);
+    if (it == diskEntries_.end()) {
+        return false;
+    }
+    diskLru_.splice(diskLru_.begin(), diskLru_, it->second.lruIt);
+    stats_.diskHits++;
+    file = cacheDir_ / (key + kSegmentExtension);
+    return true;
+}
+
+SegmentCache::Stats SegmentCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.memoryBytes = memoryBytes_;
+    stats.diskBytes = diskBytes_;
+    return stats;
+}
@@ -0,0 +1,90 @@
+// segment_cache.h
+#ifndef SEGMENT_CACHE_H
+#define SEGMENT_CACHE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "atomic_file_writer.h"
+
+// 内存 + 磁盘两级 LRU 缓存，按 URL 保存 HLS 分片等二进制内容。
+// 同一 URL 的并发请求只会触发一次上游下载，其他请求等待同一结果。
+// 两级缓存都以 URL 的 SHA-256 为键，命中即说明来源 URL 相同。
+class SegmentCache {
+public:
+    using Data = std::shared_ptr<const std::string>;
+    using Fetcher = std::function<Data(const std::string& url)>;
+
+    struct Stats {
+        std::size_t memoryHits = 0;
+        std::size_t diskHits = 0;
+        std::size_t upstreamFetches = 0;
+        std::size_t sharedWaits = 0;
+        std::size_t memoryBytes = 0;
+        std::size_t diskBytes = 0;
+    };
+
+    SegmentCache(const std::filesystem::path& cacheDir, std::size_t memoryBudget, std::size_t diskBudget);
+
+    // 禁用拷贝和赋值
+    SegmentCache(const SegmentCache&) = delete;
+    SegmentCache& operator=(const SegmentCache&) = delete;
+
+    // 先查内存、再查磁盘，都未命中时调用 fetcher 下载并写入两级缓存
+    Data getOrFetch(const std::string& url, const Fetcher& fetcher);
+
+    // 仅查询缓存，不触发下载
+    bool contains(const std::string& url) const;
+
+    // 查询缓存但不读取磁盘文件：内存命中时返回 data，磁盘命中时返回文件路径，
+    // 由调用方直接发送文件；都未命中时返回 false
+    bool lookup(const std::string& url, Data& data, std::filesystem::path& file);
+
+    // 磁盘缓存文件路径（不保证文件存在）
+    std::filesystem::path diskPath(const std::string& url) const;
+
+    Stats getStats() const;
+
+private:
+    struct MemoryEntry {
+        Data data;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    struct DiskEntry {
+        std::size_t size = 0;
+        std::list<std::string>::iterator lruIt;
+    };
+
+    // 启动时扫描磁盘目录恢复索引
+    void loadDiskIndex();
+
+    Data lookupMemory(const std::string& key);
+    void storeInMemory(const std::string& key, const Data& data);
+    Data loadFromDisk(const std::string& key);
+    void storeOnDisk(const std::string& key, const std::string& data);
+
+    std::filesystem::path cacheDir_;
+    std::size_t memoryBudget_;
+    std::size_t diskBudget_;
+    AtomicFileWriter writer_;
+
+    mutable std::mutex mutex_;
+    std::list<std::string> memoryLru_;
+    std::unordered_map<std::string, MemoryEntry> memoryEntries_;
+    std::size_t memoryBytes_ = 0;
+    std::list<std::string> diskLru_;
+    std::unordered_map<std::string, DiskEntry> diskEntries_;
+    std::size_t diskBytes_ = 0;
+    std::map<std::string, std::shared_future<Data>> inflight_;
+    Stats stats_;
+};
+
+#endif // SEGMENT_CACHE_H
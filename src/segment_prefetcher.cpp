@@ -0,0 +1,18 @@
+#include "segment_prefetcher.h"
+#include <utility>
+
+SegmentPrefetcher::SegmentPrefetcher(std::size_t workerCount, std::size_t maxQueued)
+    : executor_(workerCount, maxQueued, ThreadPool::Priority::Low) {
+}
+
+bool SegmentPrefetcher::schedule(const std::string& key, Task task) {
+    return executor_.submit(key, std::move(task));
+}
+
+std::size_t SegmentPrefetcher::pending() const {
+    return executor_.pending();
+}
+
+std::size_t SegmentPrefetcher::dropped() const {
+    return executor_.getStats().rejected;
+}
@@ -0,0 +1,35 @@
+// segment_prefetcher.h
+#ifndef SEGMENT_PREFETCHER_H
+#define SEGMENT_PREFETCHER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "task_executor.h"
+
+// 后台预取队列：以低优先级在共享线程池上执行，workerCount 限制同时进行的下载数，
+// 相同 key 的任务在排队或执行期间不会重复加入。
+class SegmentPrefetcher {
+public:
+    using Task = std::function<void()>;
+
+    SegmentPrefetcher(std::size_t workerCount, std::size_t maxQueued);
+
+    // 禁用拷贝和赋值
+    SegmentPrefetcher(const SegmentPrefetcher&) = delete;
+    SegmentPrefetcher& operator=(const SegmentPrefetcher&) = delete;
+
+    // 加入预取任务，队列已满或 key 重复时返回 false
+    bool schedule(const std::string& key, Task task);
+
+    // 排队中和执行中的任务数量
+    std::size_t pending() const;
+
+    // 因队列已满被丢弃的任务总数（不含重复 key）
+    std::size_t dropped() const;
+
+private:
+    TaskExecutor executor_;
+};
+
+#endif // SEGMENT_PREFETCHER_H
@@ -0,0 +1,200 @@
+#include "stream_health_prober.h"
+#include <algorithm>
+#include <utility>
+#include "hls_proxy.h"
+#include "https_json_client.h"
+#include "logger.h"
+
+namespace {
+constexpr const char* kLogModule = "StreamHealthProber";
+// 只下载分片开头的部分用于测速
+constexpr const char* kProbeRange = "0-262143";
+// 失败结果较快过期，站点恢复后可以重新探测
+constexpr auto kFailureTtl = std::chrono::minutes(5);
+constexpr std::size_t kMaxResults = 4096;
+// 打分基准：首字节 300ms 得一半分，下载速度达到 2MB/s 得满分
+constexpr double kReferenceTtfbMs = 300.0;
+constexpr double kReferenceBytesPerSecond = 2.0 * 1024 * 1024;
+
+template <typename... Args>
+void logInfo(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
+}
+
+// 每个探测线程复用一个客户端
+HTTPSJsonClient& probeClient() {
+    thread_local HTTPSJsonClient client;
+    thread_local bool configured = false;
+    if (!configured) {
+        client.setUserAgent("Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/122.0.0.0 Safari/537.36");
+        client.setAccept("*/*");
+        client.setConnectTimeout(5);
+        client.setRequestTimeout(10);
+        client.setVerifySSL(true);
+        client.setBlockPrivateAddresses(true);
+        configured = true;
+    }
+    return client;
+}
+
+bool looksLikePlaylist(const std::string& url) {
+    const std::string path = url.substr(0, url.find('?'));
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".m3u8") == 0;
+}
+
+bool isSuccessStatus(long status) {
+    return status == 200 || status == 206;
+}
+
+// 找到播放列表中第一个地址，isVariant 表示它是子播放列表
+bool findFirstUri(const std::string& body, const std::string& playlistUrl, std::string& uri, bool& isVariant) {
+    bool nextIsVariant = false;
+    std::size_t start = 0;
+    while (start < body.size()) {
+        std::size_t end = body.find('\n', start);
+        if (end == std::string::npos) {
+            end = body.size();
+        }
+        std::string line = body.substr(start, end - start);
+        start = end + 1;
+
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+        if (line[0] == '#') {
+            nextIsVariant = nextIsVariant || line.rfind("#EXT-X-STREAM-INF", 0) == 0;
+            continue;
+        }
+
+        uri = HlsProxy::resolveUrl(playlistUrl, line);
+        isVariant = nextIsVariant || looksLikePlaylist(uri);
+        return true;
+    }
+    return false;
+}
+
+double scoreFor(double timeToFirstByteMs, double bytesPerSecond) {
+    const double latencyFactor = kReferenceTtfbMs / (kReferenceTtfbMs + std::max(0.0, timeToFirstByteMs));
+    const double throughputFactor = std::min(1.0, bytesPerSecond / kReferenceBytesPerSecond);
+    // 可播放的地址至少 1 分，与探测失败区分开
+    return std::max(1.0, 100.0 * (0.5 * latencyFactor + 0.5 * throughputFactor));
+}
+}
+
+StreamHealthProber::StreamHealthProber(std::size_t workerCount, std::size_t maxQueued, std::chrono::seconds ttl)
+    : ttl_(ttl)
+    , workers_(workerCount, maxQueued) {}
+
+std::size_t StreamHealthProber::probe(const std::vector<std::string>& urls) {
+    const std::size_t droppedBefore = workers_.dropped();
+    std::size_t scheduled = 0;
+    for (const auto& url : urls) {
+        StreamHealth cached;
+        if (url.empty() || !HlsProxy::isProxyableUrl(url) || lookup(url, cached)) {
+            continue;
+        }
+        if (workers_.schedule(url, [this, url]() {
+                store(url, measure(url));
+            })) {
+            ++scheduled;
+        }
+    }
+
+    if (scheduled > 0) {
+        logInfo("已安排播放地址探测: 数量=", scheduled);
+    }
+    // 队列已满时不排队等待，留到下次目录更新时再探测
+    const std::size_t dropped = workers_.dropped() - droppedBefore;
+    if (dropped > 0) {
+        logInfo("探测队列已满，丢弃播放地址: 数量=", dropped, ", 累计=", workers_.dropped());
+    }
+    return scheduled;
+}
+
+bool StreamHealthProber::lookup(const std::string& url, StreamHealth& health) const {
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    const auto it = results_.find(url);
+    if (it == results_.end() || it->second.expiresAt <= std::chrono::steady_clock::now()) {
+        return false;
+    }
+    health = it->second.health;
+    return true;
+}
+
+void StreamHealthProber::store(const std::string& url, const StreamHealth& health) {
+    const auto now = std::chrono::steady_clock::now();
+    const auto lifetime = health.playable ? std::chrono::steady_clock::duration(ttl_)
+                                          : std::chrono::steady_clock::duration(kFailureTtl);
+
+    std::lock_guard<std::mutex> lock(resultsMutex_);
+    if (results_.size() >= kMaxResults && results_.find(url) == results_.end()) {
+        for (auto it = results_.begin(); it != results_.end();) {
+            it = it->second.expiresAt <= now ? results_.erase(it) : std::next(it);
+        }
+        if (results_.size() >= kMaxResults) {
+            results_.erase(results_.begin());
+        }
+    }
+    results_[url] = Entry{health, now + lifetime};
+    version_++;
+}
+
+std::uint64_t StreamHealthProber::version() const {
+    return version_.load();
+}
+
+std::size_t StreamHealthProber::dropped() const {
+    return workers_.dropped();
+}
+
+StreamHealth StreamHealthProber::measure(const std::string& url) {
+    StreamHealth health;
+    HTTPSJsonClient& client = probeClient();
+    client.setRange("");
+
+    std::string target = url;
+    double timeToFirstByteMs = -1.0;
+
+    // 播放列表最多跟随一层子播放列表
+    for (int depth = 0; depth < 2 && looksLikePlaylist(target); ++depth) {
+        const std::string body = client.get(target);
+        if (!isSuccessStatus(client.getLastStatusCode()) || body.find("#EXTM3U") == std::string::npos) {
+            return health;
+        }
+        if (timeToFirstByteMs < 0) {
+            timeToFirstByteMs = client.getLastTiming().startTransferSeconds * 1000.0;
+        }
+
+        std::string uri;
+        bool isVariant = false;
+        if (!findFirstUri(body, target, uri, isVariant)) {
+            return health;
+        }
+        target = uri;
+        if (!isVariant) {
+            break;
+        }
+    }
+
+    client.setRange(kProbeRange);
+    const std::string data = client.get(target);
+    const long status = client.getLastStatusCode();
+    client.setRange("");
+    if (!isSuccessStatus(status) || data.empty()) {
+        return health;
+    }
+
+    const HTTPSJsonClient::RequestTiming timing = client.getLastTiming();
+    if (timeToFirstByteMs < 0) {
+        timeToFirstByteMs = timing.startTransferSeconds * 1000.0;
+    }
+
+    health.playable = true;
+    health.timeToFirstByteMs = timeToFirstByteMs;
+    health.bytesPerSecond = timing.downloadBytesPerSecond;
+    health.score = scoreFor(health.timeToFirstByteMs, health.bytesPerSecond);
+    return health;
+}
@@ -0,0 +1,66 @@
+// stream_health_prober.h
+#ifndef STREAM_HEALTH_PROBER_H
+#define STREAM_HEALTH_PROBER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "segment_prefetcher.h"
+
+// 单个播放地址的探测结果
+struct StreamHealth {
+    bool playable = false;
+    double score = 0.0;              // 0-100，越高越好，不可播放时为 0
+    double timeToFirstByteMs = 0.0;
+    double bytesPerSecond = 0.0;
+};
+
+// 后台探测播放地址的可用性：m3u8 先取播放列表（主列表跟随第一个码率），
+// 再取第一个分片的开头部分，按首字节时间和下载速度打分。
+// 结果按地址缓存，过期前不会重复探测；并发数由固定的工作线程限制。
+class StreamHealthProber {
+public:
+    StreamHealthProber(std::size_t workerCount, std::size_t maxQueued, std::chrono::seconds ttl);
+
+    // 禁用拷贝和赋值
+    StreamHealthProber(const StreamHealthProber&) = delete;
+    StreamHealthProber& operator=(const StreamHealthProber&) = delete;
+
+    // 为没有有效结果的地址安排探测，返回加入队列的数量
+    std::size_t probe(const std::vector<std::string>& urls);
+
+    // 查询缓存的探测结果，没有或已过期时返回 false
+    bool lookup(const std::string& url, StreamHealth& health) const;
+
+    // 每写入一个探测结果加一，用于判断按健康度排好的目录是否过期
+    std::uint64_t version() const;
+
+    // 因探测队列已满而未探测的地址总数
+    std::size_t dropped() const;
+
+    // 同步探测一个地址
+    static StreamHealth measure(const std::string& url);
+
+private:
+    struct Entry {
+        StreamHealth health;
+        std::chrono::steady_clock::time_point expiresAt;
+    };
+
+    void store(const std::string& url, const StreamHealth& health);
+
+    std::unordered_map<std::string, Entry> results_;
+    mutable std::mutex resultsMutex_;
+    std::atomic<std::uint64_t> version_{0};
+    std::chrono::seconds ttl_;
+
+    // 最后声明，析构时先停止探测线程
+    SegmentPrefetcher workers_;
+};
+
+#endif // STREAM_HEALTH_PROBER_H
@@ -0,0 +1,178 @@
+#include "suggestion_trie.h"
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+#include "text_util.h"
+
+namespace {
+// 单个词条最多建立的前缀深度，超长标题只对开头部分提供联想
+constexpr std::size_t kMaxPrefixLength = 32;
+// 超过上限时保留的词条比例，淘汰一批后要再插入这么多才会重建
+constexpr double kRetainRatio = 0.75;
+
+std::u32string foldKey(const std::string& value) {
+    std::u32string folded = text::foldWidth(text::decodeUtf8(value));
+    if (folded.size() > kMaxPrefixLength) {
+        folded.resize(kMaxPrefixLength);
+    }
+    return folded;
+}
+
+std::string trimSpaces(const std::string& value) {
+    const auto first = value.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+    const auto last = value.find_last_not_of(" \t\r\n");
+    return value.substr(first, last - first + 1);
+}
+}
+
+SuggestionTrie::SuggestionTrie(std::size_t topK, std::size_t maxEntries)
+    : topK_(topK), maxEntries_(std::max<std::size_t>(1, maxEntries)) {
+    nodes_.emplace_back();
+}
+
+void SuggestionTrie::raise(const std::string& text, double weight) {
+    update(text, weight, false);
+}
+
+void SuggestionTrie::increase(const std::string& text, double delta) {
+    update(text, delta, true);
+}
+
+std::uint32_t SuggestionTrie::childOf(std::uint32_t node, char32_t key) {
+    auto& children = nodes_[node].children;
+    auto it = std::lower_bound(children.begin(), children.end(), key, [](const auto& child, char32_t value) {
+        return child.first < value;
+    });
+    if (it != children.end() && it->first == key) {
+        return it->second;
+    }
+
+    const auto child = static_cast<std::uint32_t>(nodes_.size());
+    // 先插入边再扩容节点数组，避免 children 引用失效
+    children.insert(it, {key, child});
+    nodes_.emplace_back();
+    return child;
+}
+
+void SuggestionTrie::updateTop(Node& node, std::uint32_t entryId) {
+    auto& top = node.top;
+    if (std::find(top.begin(), top.end(), entryId) == top.end()) {
+        if (top.size() < topK_) {
+            top.push_back(entryId);
+        } else if (entries_[top.back()].weight < entries_[entryId].weight) {
+            top.back() = entryId;
+        } else {
+            return;
+        }
+    }
+
+    std::stable_sort(top.begin(), top.end(), [this](std::uint32_t a, std::uint32_t b) {
+        return entries_[a].weight > entries_[b].weight;
+    });
+}
+
+void SuggestionTrie::update(const std::string& rawText, double weight, bool accumulate) {
+    const std::string value = trimSpaces(rawText);
+    if (value.empty()) {
+        return;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    std::uint32_t entryId = 0;
+    const auto it = entryIds_.find(value);
+    if (it == entryIds_.end()) {
+        entryId = static_cast<std::uint32_t>(entries_.size());
+        entries_.push_back(Entry{value, 0.0});
+        entryIds_.emplace(value, entryId);
+    } else {
+        entryId = it->second;
+    }
+
+    Entry& entry = entries_[entryId];
+    const double newWeight = accumulate ? entry.weight + weight : std::max(entry.weight, weight);
+    if (newWeight <= entry.weight && it != entryIds_.end()) {
+        return;
+    }
+    entry.weight = newWeight;
+    insertPath(entryId);
+
+    if (entries_.size() > maxEntries_) {
+        evictLowWeight();
+    }
+}
+
+void SuggestionTrie::insertPath(std::uint32_t entryId) {
+    const std::u32string key = foldKey(entries_[entryId].text);
+    std::uint32_t node = 0;
+    for (char32_t c : key) {
+        node = childOf(node, c);
+        updateTop(nodes_[node], entryId);
+    }
+}
+
+void SuggestionTrie::evictLowWeight() {
+    // 按权重保留，权重相同时保留较新的词条；保留的词条维持原有顺序
+    std::vector<std::uint32_t> order(entries_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {
+        if (entries_[a].weight != entries_[b].weight) {
+            return entries_[a].weight > entries_[b].weight;
+        }
+        return a > b;
+    });
+    order.resize(std::max<std::size_t>(1, static_cast<std::size_t>(maxEntries_ * kRetainRatio)));
+    std::sort(order.begin(), order.end());
+
+    std::vector<Entry> kept;
+    kept.reserve(order.size());
+    for (std::uint32_t id : order) {
+        kept.push_back(std::move(entries_[id]));
+    }
+    entries_ = std::move(kept);
+
+    // 节点只增不删，淘汰后整体重建，空出的前缀不再占用内存
+    entryIds_.clear();
+    nodes_ = std::vector<Node>(1);
+    for (std::uint32_t id = 0; id < entries_.size(); ++id) {
+        entryIds_.emplace(entries_[id].text, id);
+        insertPath(id);
+    }
+}
+
+std::vector<std::string> SuggestionTrie::suggest(const std::string& prefix, std::size_t limit) const {
+    const std::u32string key = foldKey(trimSpaces(prefix));
+    std::vector<std::string> result;
+    if (key.empty() || limit == 0) {
+        return result;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::uint32_t node = 0;
+    for (char32_t c : key) {
+        const auto& children = nodes_[node].children;
+        auto it = std::lower_bound(children.begin(), children.end(), c, [](const auto& child, char32_t value) {
+            return child.first < value;
+        });
+        if (it == children.end() || it->first != c) {
+            return result;
+        }
+        node = it->second;
+    }
+
+    const auto& top = nodes_[node].top;
+    const std::size_t count = std::min(limit, top.size());
+    result.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        result.push_back(entries_[top[i]].text);
+    }
+    return result;
+}
+
+std::size_t SuggestionTrie::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_.size();
+}
@@ -0,0 +1,59 @@
+// suggestion_trie.h
+#ifndef SUGGESTION_TRIE_H
+#define SUGGESTION_TRIE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 输入联想用的前缀树。按全角折叠后的码点建边，每个节点预先保存
+// 权重最高的若干条候选，查询只需沿前缀走到对应节点，与词条总数无关。
+// 权重只增不减，因此可以在每次搜索后增量插入而不必整体重建；
+// 词条数超过上限时淘汰权重最低的一批词条并重建前缀树，内存不随搜索次数无限增长。
+class SuggestionTrie {
+public:
+    explicit SuggestionTrie(std::size_t topK = 10, std::size_t maxEntries = 50000);
+
+    // 将词条权重提升到至少 weight（用于影片标题，权重为视频源数量）
+    void raise(const std::string& text, double weight);
+
+    // 在词条当前权重上累加 delta（用于用户搜索过的关键词）
+    void increase(const std::string& text, double delta);
+
+    // 返回以 prefix 开头、权重最高的最多 limit 条词条
+    std::vector<std::string> suggest(const std::string& prefix, std::size_t limit) const;
+
+    std::size_t size() const;
+
+private:
+    struct Node {
+        // 按码点排序的子节点列表，比 map 更紧凑
+        std::vector<std::pair<char32_t, std::uint32_t>> children;
+        // 子树中权重最高的词条 id，按权重降序
+        std::vector<std::uint32_t> top;
+    };
+
+    struct Entry {
+        std::string text;
+        double weight = 0.0;
+    };
+
+    void update(const std::string& text, double weight, bool accumulate);
+    std::uint32_t childOf(std::uint32_t node, char32_t key);
+    void updateTop(Node& node, std::uint32_t entryId);
+    void insertPath(std::uint32_t entryId);
+    void evictLowWeight();
+
+    std::size_t topK_;
+    std::size_t maxEntries_;
+    std::vector<Node> nodes_;
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, std::uint32_t> entryIds_;
+    mutable std::shared_mutex mutex_;
+};
+
+#endif // SUGGESTION_TRIE_H
@@ -0,0 +1,122 @@
+#include "task_executor.h"
+#include <algorithm>
+#include <exception>
+#include "logger.h"
+
+namespace {
+constexpr const char* kLogModule = "TaskExecutor";
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+}
+
+TaskExecutor::TaskExecutor(std::size_t maxRunning, std::size_t maxQueued, ThreadPool::Priority priority)
+    : priority_(priority)
+    , maxRunning_(std::max<std::size_t>(1, maxRunning))
+    , maxQueued_(std::max<std::size_t>(1, maxQueued)) {
+}
+
+TaskExecutor::~TaskExecutor() {
+    shutdown();
+}
+
+void TaskExecutor::shutdown() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stopping_ = true;
+    for (const auto& item : queue_) {
+        activeKeys_.erase(item.first);
+    }
+    queue_.clear();
+    // 已提交到线程池的任务会引用本对象，等它们全部退出
+    idle_.wait(lock, [this]() {
+        return dispatched_ == 0;
+    });
+}
+
+bool TaskExecutor::submit(const std::string& key, Task task) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (activeKeys_.count(key) > 0) {
+        return false;
+    }
+    if (stopping_ || queue_.size() >= maxQueued_) {
+        rejected_++;
+        return false;
+    }
+    activeKeys_.insert(key);
+    queue_.emplace_back(key, std::move(task));
+    dispatchLocked();
+    return true;
+}
+
+void TaskExecutor::setMaxRunning(std::size_t maxRunning) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxRunning_ = std::max<std::size_t>(1, maxRunning);
+    if (!stopping_) {
+        dispatchLocked();
+    }
+}
+
+bool TaskExecutor::contains(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return activeKeys_.count(key) > 0;
+}
+
+std::size_t TaskExecutor::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return activeKeys_.size();
+}
+
+TaskExecutor::Stats TaskExecutor::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.maxRunning = maxRunning_;
+    stats.maxQueued = maxQueued_;
+    stats.queued = queue_.size();
+    stats.running = running_;
+    stats.completed = completed_;
+    stats.rejected = rejected_;
+    return stats;
+}
+
+void TaskExecutor::dispatchLocked() {
+    // 每个线程池任务只执行一项，执行完再按需提交下一项，其间线程池可以先处理更高优先级的任务
+    while (dispatched_ < maxRunning_ && dispatched_ - running_ < queue_.size()) {
+        dispatched_++;
+        ThreadPool::instance().post(priority_, [this]() {
+            runNext();
+        });
+    }
+}
+
+void TaskExecutor::runNext() {
+    std::pair<std::string, Task> item;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || queue_.empty()) {
+            dispatched_--;
+            idle_.notify_all();
+            return;
+        }
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        running_++;
+    }
+
+    try {
+        item.second();
+    } catch (const std::exception& e) {
+        logError("后台任务异常: key=", item.first, ", error=", e.what());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    activeKeys_.erase(item.first);
+    running_--;
+    completed_++;
+    dispatched_--;
+    if (!stopping_) {
+        dispatchLocked();
+    }
+    idle_.notify_all();
+}
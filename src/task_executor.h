@@ -0,0 +1,74 @@
+// task_executor.h
+#ifndef TASK_EXECUTOR_H
+#define TASK_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include "thread_pool.h"
+
+// 有界任务队列：任务在共享线程池上执行，同时执行的数量不超过 maxRunning，
+// 让搜索、目录序列化和预取等任务互不挤占。队列满时拒绝新任务，由调用方决定如何降级（如返回 429）；
+// 相同 key 的任务在排队或执行期间不会重复加入。
+class TaskExecutor {
+public:
+    using Task = std::function<void()>;
+
+    struct Stats {
+        std::size_t maxRunning = 0;
+        std::size_t maxQueued = 0;
+        std::size_t queued = 0;
+        std::size_t running = 0;
+        std::size_t completed = 0;
+        std::size_t rejected = 0;    // 因队列已满或已停止被拒绝，不含重复 key
+    };
+
+    TaskExecutor(std::size_t maxRunning, std::size_t maxQueued, ThreadPool::Priority priority = ThreadPool::Priority::Normal);
+    ~TaskExecutor();
+
+    // 禁用拷贝和赋值
+    TaskExecutor(const TaskExecutor&) = delete;
+    TaskExecutor& operator=(const TaskExecutor&) = delete;
+
+    // 加入任务，队列已满或 key 重复时返回 false
+    bool submit(const std::string& key, Task task);
+
+    // 修改同时执行的任务数上限，对之后的调度生效
+    void setMaxRunning(std::size_t maxRunning);
+
+    // 相同 key 的任务是否正在排队或执行
+    bool contains(const std::string& key) const;
+
+    // 丢弃排队中的任务，等待执行中的任务结束；之后提交的任务都会被拒绝
+    void shutdown();
+
+    // 排队中和执行中的任务数量
+    std::size_t pending() const;
+
+    Stats getStats() const;
+
+private:
+    void dispatchLocked();
+    void runNext();
+
+    const ThreadPool::Priority priority_;
+    std::deque<std::pair<std::string, Task>> queue_;
+    std::unordered_set<std::string> activeKeys_;
+    std::size_t maxRunning_;
+    std::size_t maxQueued_;
+    // 已提交到线程池、尚未结束的任务数
+    std::size_t dispatched_ = 0;
+    std::size_t running_ = 0;
+    std::size_t completed_ = 0;
+    std::size_t rejected_ = 0;
+    bool stopping_ = false;
+    mutable std::mutex mutex_;
+    std::condition_variable idle_;
+};
+
+#endif // TASK_EXECUTOR_H
@@ -0,0 +1,333 @@
+#include "text_util.h"
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace text {
+
+namespace {
+constexpr std::array<std::uint32_t, 64> kSha256Rounds = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+std::uint32_t rotateRight(std::uint32_t value, int bits) {
+    return (value >> bits) | (value << (32 - bits));
+}
+
+void sha256Block(std::array<std::uint32_t, 8>& state, const unsigned char* block) {
+    std::array<std::uint32_t, 64> w{};
+    for (std::size_t i = 0; i < 16; ++i) {
+        w[i] = (static_cast<std::uint32_t>(block[i * 4]) << 24) | (static_cast<std::uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<std::uint32_t>(block[i * 4 + 2]) << 8) | static_cast<std::uint32_t>(block[i * 4 + 3]);
+    }
+    for (std::size_t i = 16; i < 64; ++i) {
+        const std::uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const std::uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    std::uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    std::uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (std::size_t i = 0; i < 64; ++i) {
+        const std::uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+        const std::uint32_t choose = (e & f) ^ (~e & g);
+        const std::uint32_t t1 = h + s1 + choose + kSha256Rounds[i] + w[i];
+        const std::uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+        const std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        const std::uint32_t t2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+std::string toHex(const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string output;
+    output.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        output.push_back(digits[c >> 4]);
+        output.push_back(digits[c & 0x0F]);
+    }
+    return output;
+}
+}
+
+std::u32string decodeUtf8(const std::string& input) {
+    std::u32string output;
+    output.reserve(input.size());
+
+    std::size_t i = 0;
+    while (i < input.size()) {
+        const unsigned char lead = static_cast<unsigned char>(input[i]);
+        std::size_t length = 0;
+        char32_t codePoint = 0;
+
+        if (lead < 0x80) {
+            length = 1;
+            codePoint = lead;
+        } else if ((lead & 0xE0) == 0xC0) {
+            length = 2;
+            codePoint = lead & 0x1F;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+            codePoint = lead & 0x0F;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4;
+            codePoint = lead & 0x07;
+        } else {
+            ++i;
+            continue;
+        }
+
+        if (i + length > input.size()) {
+            break;
+        }
+
+        bool valid = true;
+        for (std::size_t k = 1; k < length; ++k) {
+            const unsigned char next = static_cast<unsigned char>(input[i + k]);
+            if ((next & 0xC0) != 0x80) {
+                valid = false;
+                break;
+            }
+            codePoint = (codePoint << 6) | (next & 0x3F);
+        }
+
+        if (!valid) {
+            ++i;
+            continue;
+        }
+
+        output.push_back(codePoint);
+        i += length;
+    }
+
+    return output;
+}
+
+void appendUtf8(char32_t codePoint, std::string& output) {
+    if (codePoint < 0x80) {
+        output.push_back(static_cast<char>(codePoint));
+    } else if (codePoint < 0x800) {
+        output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    } else {
+        output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+std::string encodeUtf8(const std::u32string& input) {
+    std::string output;
+    output.reserve(input.size() * 3);
+    for (char32_t codePoint : input) {
+        appendUtf8(codePoint, output);
+    }
+    return output;
+}
+
+char32_t foldWidth(char32_t codePoint) {
+    // 全角 ASCII 区 U+FF01-U+FF5E 与半角相差 0xFEE0
+    if (codePoint >= 0xFF01 && codePoint <= 0xFF5E) {
+        codePoint -= 0xFEE0;
+    } else if (codePoint == 0x3000) {
+        codePoint = U' ';
+    }
+
+    if (codePoint >= U'A' && codePoint <= U'Z') {
+        codePoint += U'a' - U'A';
+    }
+    return codePoint;
+}
+
+std::u32string foldWidth(const std::u32string& input) {
+    std::u32string output(input);
+    std::transform(output.begin(), output.end(), output.begin(), [](char32_t c) {
+        return foldWidth(c);
+    });
+    return output;
+}
+
+bool isSpaceOrPunctuation(char32_t c) {
+    if (c < 0x80) {
+        return !((c >= U'0' && c <= U'9') || (c >= U'a' && c <= U'z') || (c >= U'A' && c <= U'Z'));
+    }
+
+    return c == 0x00A0 || c == 0x00B7 || c == 0x30FB ||
+           (c >= 0x2000 && c <= 0x206F) ||  // 通用标点
+           (c >= 0x3000 && c <= 0x303F) ||  // CJK 符号和标点
+           (c >= 0xFE30 && c <= 0xFE4F) ||  // CJK 兼容形式
+           (c >= 0xFF01 && c <= 0xFF0F) ||  // 未折叠的全角标点
+           (c >= 0xFF1A && c <= 0xFF20) ||
+           (c >= 0xFF3B && c <= 0xFF40) ||
+           (c >= 0xFF5B && c <= 0xFF65);
+}
+
+bool isAsciiDigit(char32_t c) {
+    return c >= U'0' && c <= U'9';
+}
+
+std::vector<std::uint64_t> collectBigrams(const std::u32string& input) {
+    std::vector<std::uint64_t> grams;
+    if (input.size() == 1) {
+        grams.push_back(makeBigram(input[0], 0));
+        return grams;
+    }
+
+    grams.reserve(input.size());
+    for (std::size_t i = 0; i + 1 < input.size(); ++i) {
+        grams.push_back(makeBigram(input[i], input[i + 1]));
+    }
+
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    return grams;
+}
+
+std::string stripHtml(const std::string& html) {
+    static const std::pair<const char*, const char*> entities[] = {
+        {"&nbsp;", " "}, {"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"},
+        {"&quot;", "\""}, {"&#39;", "'"}, {"&apos;", "'"}
+    };
+
+    std::string output;
+    output.reserve(html.size());
+
+    std::size_t i = 0;
+    while (i < html.size()) {
+        const char c = html[i];
+        if (c == '<') {
+            const std::size_t close = html.find('>', i);
+            if (close == std::string::npos) {
+                break;
+            }
+            output.push_back(' ');
+            i = close + 1;
+            continue;
+        }
+
+        if (c == '&') {
+            bool decoded = false;
+            for (const auto& [entity, replacement] : entities) {
+                const std::size_t length = std::char_traits<char>::length(entity);
+                if (html.compare(i, length, entity) == 0) {
+                    output.append(replacement);
+                    i += length;
+                    decoded = true;
+                    break;
+                }
+            }
+            if (decoded) {
+                continue;
+            }
+        }
+
+        output.push_back(c);
+        ++i;
+    }
+
+    return output;
+}
+
+std::string hashHex(const std::string& value) {
+    std::uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : value) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+
+    static const char digits[] = "0123456789abcdef";
+    std::string output(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        output[static_cast<std::size_t>(i)] = digits[hash & 0xF];
+        hash >>= 4;
+    }
+    return output;
+}
+
+std::string sha256(const std::string& value) {
+    std::array<std::uint32_t, 8> state = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    const std::size_t fullBlocks = value.size() / 64;
+    const auto* data = reinterpret_cast<const unsigned char*>(value.data());
+    for (std::size_t i = 0; i < fullBlocks; ++i) {
+        sha256Block(state, data + i * 64);
+    }
+
+    // 剩余字节补 0x80、零和 64 位消息长度，凑满一或两个块
+    std::array<unsigned char, 128> tail{};
+    const std::size_t rest = value.size() - fullBlocks * 64;
+    std::copy(data + fullBlocks * 64, data + value.size(), tail.begin());
+    tail[rest] = 0x80;
+    const std::size_t tailSize = rest + 9 <= 64 ? 64 : 128;
+    const std::uint64_t bits = static_cast<std::uint64_t>(value.size()) * 8;
+    for (std::size_t i = 0; i < 8; ++i) {
+        tail[tailSize - 1 - i] = static_cast<unsigned char>(bits >> (i * 8));
+    }
+    for (std::size_t offset = 0; offset < tailSize; offset += 64) {
+        sha256Block(state, tail.data() + offset);
+    }
+
+    std::string digest(32, '\0');
+    for (std::size_t i = 0; i < 8; ++i) {
+        digest[i * 4] = static_cast<char>(state[i] >> 24);
+        digest[i * 4 + 1] = static_cast<char>(state[i] >> 16);
+        digest[i * 4 + 2] = static_cast<char>(state[i] >> 8);
+        digest[i * 4 + 3] = static_cast<char>(state[i]);
+    }
+    return digest;
+}
+
+std::string sha256Hex(const std::string& value) {
+    return toHex(sha256(value));
+}
+
+std::string hmacSha256Hex(const std::string& key, const std::string& message) {
+    constexpr std::size_t kBlockSize = 64;
+    std::string blockKey = key.size() > kBlockSize ? sha256(key) : key;
+    blockKey.resize(kBlockSize, '\0');
+
+    std::string inner(kBlockSize, '\0');
+    std::string outer(kBlockSize, '\0');
+    for (std::size_t i = 0; i < kBlockSize; ++i) {
+        inner[i] = static_cast<char>(blockKey[i] ^ 0x36);
+        outer[i] = static_cast<char>(blockKey[i] ^ 0x5c);
+    }
+    return toHex(sha256(outer + sha256(inner + message)));
+}
+
+bool constantTimeEquals(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    unsigned char diff = 0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
+
+} // namespace text
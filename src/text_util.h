@@ -0,0 +1,54 @@
+// text_util.h
+#ifndef TEXT_UTIL_H
+#define TEXT_UTIL_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 标题归一化、本地索引等模块共用的 UTF-8 文本处理函数
+namespace text {
+
+// UTF-8 解码为码点序列，非法字节会被跳过
+std::u32string decodeUtf8(const std::string& input);
+
+// 码点序列编码为 UTF-8
+std::string encodeUtf8(const std::u32string& input);
+void appendUtf8(char32_t codePoint, std::string& output);
+
+// 全角转半角、ASCII 大写转小写
+char32_t foldWidth(char32_t codePoint);
+std::u32string foldWidth(const std::u32string& input);
+
+// 空白或标点（含 CJK 标点和常见括号）
+bool isSpaceOrPunctuation(char32_t codePoint);
+
+bool isAsciiDigit(char32_t codePoint);
+
+// 相邻两个码点组成的 bigram 键
+inline std::uint64_t makeBigram(char32_t first, char32_t second) {
+    return (static_cast<std::uint64_t>(first) << 32) | static_cast<std::uint64_t>(second);
+}
+
+// 去重并排序后的 bigram 列表；长度为 1 时返回单字键
+std::vector<std::uint64_t> collectBigrams(const std::u32string& input);
+
+// 去除 HTML 标签并解码常见实体，用于 vod_content 之类的富文本字段
+std::string stripHtml(const std::string& html);
+
+// 稳定的 64 位 FNV-1a 哈希（16 位十六进制），用于缓存文件命名
+std::string hashHex(const std::string& value);
+
+// SHA-256 摘要（32 字节原始值）及其 64 位十六进制形式
+std::string sha256(const std::string& value);
+std::string sha256Hex(const std::string& value);
+
+// HMAC-SHA256 的十六进制形式，用于签名本服务生成的代理地址
+std::string hmacSha256Hex(const std::string& key, const std::string& message);
+
+// 比较耗时与内容无关的字符串比较，用于校验签名
+bool constantTimeEquals(const std::string& a, const std::string& b);
+
+} // namespace text
+
+#endif // TEXT_UTIL_H
@@ -0,0 +1,224 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <exception>
+#include "logger.h"
+
+namespace {
+constexpr const char* kLogModule = "ThreadPool";
+// 上游请求是阻塞传输，自动配置时线程数至少覆盖默认的搜索并发上限
+constexpr std::size_t kMinAutoWorkers = 32;
+
+constexpr std::size_t kPriorityCount = 3;
+
+// 当前线程所属的线程池和工作线程序号，用于把任务放入自己的队列
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+template <typename... Args>
+void logInfo(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
+}
+
+template <typename... Args>
+void logError(Args&&... args) {
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
+}
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+bool ThreadPool::setWorkerCount(std::size_t workers) {
+    std::lock_guard<std::mutex> lock(startMutex_);
+    if (started_.load()) {
+        logError("线程池已启动，忽略线程数设置: ", workers);
+        return false;
+    }
+    requestedWorkers_ = workers;
+    return true;
+}
+
+void ThreadPool::post(Priority priority, Task task) {
+    enqueue(priority, [task = std::move(task)]() {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            logError("任务异常: ", e.what());
+        }
+    });
+}
+
+void ThreadPool::enqueue(Priority priority, Task task) {
+    ensureStarted();
+
+    // 工作线程提交的任务留在自己的队列，其余按轮转分配
+    const std::size_t index = currentPool == this
+        ? currentWorker
+        : nextWorker_.fetch_add(1) % workers_.size();
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        workers_[index]->queues[static_cast<std::size_t>(priority)].push_back(std::move(task));
+        queued_++;
+    }
+    submitted_++;
+
+    // 先经过 sleepMutex_ 再通知，避免与正在判断是否休眠的线程错过唤醒
+    { std::lock_guard<std::mutex> lock(sleepMutex_); }
+    wake_.notify_one();
+}
+
+void ThreadPool::ensureStarted() {
+    if (started_.load()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(startMutex_);
+    if (started_.load()) {
+        return;
+    }
+    std::size_t count = requestedWorkers_;
+    if (count == 0) {
+        count = std::max<std::size_t>(kMinAutoWorkers, std::thread::hardware_concurrency());
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        threads_.emplace_back([this, i]() {
+            workerLoop(i);
+        });
+    }
+    started_.store(true);
+    logInfo("线程池启动: 工作线程 ", count, " 个");
+}
+
+bool ThreadPool::isWorkerThread() const {
+    return currentPool == this;
+}
+
+bool ThreadPool::runGroupTask(TaskGroup& group) {
+    std::shared_ptr<TaskGroup::Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(group.mutex_);
+        // 已被工作线程取走的任务直接丢弃；取最近提交的，与工作线程从队列尾部取任务一致
+        while (!group.pending_.empty()) {
+            std::shared_ptr<TaskGroup::Entry> candidate = std::move(group.pending_.back());
+            group.pending_.pop_back();
+            if (!candidate->claimed.exchange(true)) {
+                entry = std::move(candidate);
+                break;
+            }
+        }
+    }
+    if (!entry) {
+        return false;
+    }
+
+    // 队列中的对应项随后被取出时不再执行，completed 由它计数
+    helped_++;
+    running_++;
+    entry->task();
+    running_--;
+    return true;
+}
+
+bool ThreadPool::takeTask(std::size_t self, Priority minPriority, Task& task, bool& stolen) {
+    const std::size_t count = workers_.size();
+    const std::size_t levels = static_cast<std::size_t>(minPriority) + 1;
+    for (std::size_t level = 0; level < levels && level < kPriorityCount; ++level) {
+        // 自己的队列从尾部取，最近提交的任务数据更可能还在缓存中
+        {
+            Worker& worker = *workers_[self];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            auto& queue = worker.queues[level];
+            if (!queue.empty()) {
+                task = std::move(queue.back());
+                queue.pop_back();
+                queued_--;
+                stolen = false;
+                return true;
+            }
+        }
+
+        // 从其他线程的队列头部窃取，与其所有者从两端取任务，减少竞争
+        for (std::size_t offset = 1; offset < count; ++offset) {
+            Worker& victim = *workers_[(self + offset) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            auto& queue = victim.queues[level];
+            if (!queue.empty()) {
+                task = std::move(queue.front());
+                queue.pop_front();
+                queued_--;
+                stolen = true;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTask(Task& task) {
+    running_++;
+    task();
+    running_--;
+    completed_++;
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        Task task;
+        bool stolen = false;
+        if (takeTask(index, Priority::Low, task, stolen)) {
+            if (stolen) {
+                steals_++;
+            }
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this]() {
+            return stopping_ || queued_.load() > 0;
+        });
+        if (stopping_) {
+            return;
+        }
+    }
+}
+
+ThreadPool::Stats ThreadPool::getStats() const {
+    Stats stats;
+    if (started_.load()) {
+        stats.workers = workers_.size();
+        for (const auto& worker : workers_) {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            for (std::size_t level = 0; level < kPriorityCount; ++level) {
+                stats.queued[level] += worker->queues[level].size();
+            }
+        }
+    }
+    stats.running = running_.load();
+    stats.submitted = submitted_.load();
+    stats.completed = completed_.load();
+    stats.steals = steals_.load();
+    stats.helped = helped_.load();
+    return stats;
+}
@@ -0,0 +1,174 @@
+// thread_pool.h
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// 进程内共享的工作窃取线程池。每个工作线程有自己的按优先级分开的任务队列：
+// 工作线程提交的任务放入自己的队列尾部并优先从尾部取出，空闲时从其他线程的队列头部窃取；
+// 高优先级任务总是先于低优先级任务执行。
+// 搜索分页、详情批次、后台任务、探测和预取都提交到这里，线程复用，并发度在一处配置。
+class ThreadPool;
+
+// 同一调用方提交的一组任务。在工作线程上等待结果时，只会顺带执行本组尚未开始的任务，
+// 不会执行其他调用方的任务；组对象需在等待结束前保持有效
+class TaskGroup {
+public:
+    TaskGroup() = default;
+
+    // 禁用拷贝和赋值
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+private:
+    friend class ThreadPool;
+
+    // 同一任务同时在工作线程队列和组里，先取得 claimed 的一方执行
+    struct Entry {
+        std::atomic<bool> claimed{false};
+        std::function<void()> task;
+    };
+
+    std::mutex mutex_;
+    std::deque<std::shared_ptr<Entry>> pending_;
+};
+
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    enum class Priority {
+        High,        // 上游请求扇出，有调用方在等待结果
+        Normal,      // 搜索任务、目录序列化等后台任务
+        Low          // 预取和探测
+    };
+
+    struct Stats {
+        std::size_t workers = 0;
+        std::array<std::size_t, 3> queued{};   // 按优先级的排队数
+        std::size_t running = 0;
+        std::uint64_t submitted = 0;
+        std::uint64_t completed = 0;
+        std::uint64_t steals = 0;              // 从其他工作线程队列取走的任务数
+        std::uint64_t helped = 0;              // 等待结果的工作线程顺带执行的本组任务数
+    };
+
+    static ThreadPool& instance();
+
+    ~ThreadPool();
+
+    // 禁用拷贝和赋值
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 设置工作线程数（0 表示自动），只在第一次提交任务前生效
+    bool setWorkerCount(std::size_t workers);
+
+    // 提交不关心结果的任务，异常会被记录
+    void post(Priority priority, Task task);
+
+    // 提交任务并返回 future，异常保存在 future 中；传入 group 时任务同时登记到该组
+    template <typename F>
+    std::future<std::invoke_result_t<std::decay_t<F>>> submit(Priority priority, F&& function, TaskGroup* group = nullptr) {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(function));
+        std::future<Result> future = task->get_future();
+        if (!group) {
+            enqueue(priority, [task]() {
+                (*task)();
+            });
+            return future;
+        }
+
+        auto entry = std::make_shared<TaskGroup::Entry>();
+        entry->task = [task]() {
+            (*task)();
+        };
+        {
+            std::lock_guard<std::mutex> lock(group->mutex_);
+            group->pending_.push_back(entry);
+        }
+        enqueue(priority, [entry]() {
+            if (!entry->claimed.exchange(true)) {
+                entry->task();
+            }
+        });
+        return future;
+    }
+
+    // 等待 future 就绪。在本线程池的工作线程上等待时，先执行 group 中尚未开始的任务，
+    // 工作线程都在等待时调用方自己的任务也不会无人执行；其他线程（如 HTTP 线程）只等待
+    template <typename R>
+    std::future_status waitFor(const std::future<R>& future, std::chrono::milliseconds timeout, TaskGroup* group = nullptr) {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        if (group && isWorkerThread()) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready &&
+                   std::chrono::steady_clock::now() < deadline && runGroupTask(*group)) {
+            }
+        }
+        return future.wait_until(deadline);
+    }
+
+    template <typename R>
+    R get(std::future<R>& future, TaskGroup* group = nullptr) {
+        if (group && isWorkerThread()) {
+            while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready && runGroupTask(*group)) {
+            }
+        }
+        return future.get();
+    }
+
+    Stats getStats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Task>, 3> queues;
+    };
+
+    ThreadPool() = default;
+
+    void enqueue(Priority priority, Task task);
+    void ensureStarted();
+    void workerLoop(std::size_t index);
+    bool takeTask(std::size_t self, Priority minPriority, Task& task, bool& stolen);
+    void runTask(Task& task);
+    // 当前线程是否为本线程池的工作线程
+    bool isWorkerThread() const;
+    // 在当前线程执行 group 中一个尚未开始的任务，没有时返回 false
+    bool runGroupTask(TaskGroup& group);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::size_t requestedWorkers_ = 0;
+    std::atomic<bool> started_{false};
+    std::mutex startMutex_;
+
+    std::atomic<std::size_t> queued_{0};
+    std::atomic<std::size_t> running_{0};
+    std::atomic<std::size_t> nextWorker_{0};
+    std::atomic<std::uint64_t> submitted_{0};
+    std::atomic<std::uint64_t> completed_{0};
+    std::atomic<std::uint64_t> steals_{0};
+    std::atomic<std::uint64_t> helped_{0};
+
+    bool stopping_ = false;
+    std::mutex sleepMutex_;
+    std::condition_variable wake_;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,257 @@
+#include "thumbnail.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <csetjmp>
+#include <cstdlib>
+#include <vector>
+
+#ifdef MYTV_HAVE_JPEG
+#include <jpeglib.h>
+#endif
+#ifdef MYTV_HAVE_PNG
+#include <png.h>
+#endif
+
+namespace {
+// 解码后的像素数上限，避免超大图片占满内存
+constexpr std::size_t kMaxDecodedPixels = 40u * 1000 * 1000;
+constexpr int kJpegQuality = 80;
+
+struct RgbImage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;  // 每像素 3 字节
+};
+
+bool startsWith(const std::string& data, const char* magic, std::size_t length, std::size_t offset = 0) {
+    return data.size() >= offset + length && data.compare(offset, length, magic, length) == 0;
+}
+
+#ifdef MYTV_HAVE_JPEG
+// 区域平均缩小：每个目标像素取其覆盖的源像素均值
+RgbImage resizeBox(const RgbImage& source, int width, int height) {
+    RgbImage output;
+    output.width = width;
+    output.height = height;
+    output.pixels.resize(static_cast<std::size_t>(width) * height * 3);
+
+    for (int y = 0; y < height; ++y) {
+        const int sy0 = static_cast<int>(static_cast<std::int64_t>(y) * source.height / height);
+        const int sy1 = std::max(sy0 + 1, static_cast<int>(static_cast<std::int64_t>(y + 1) * source.height / height));
+        for (int x = 0; x < width; ++x) {
+            const int sx0 = static_cast<int>(static_cast<std::int64_t>(x) * source.width / width);
+            const int sx1 = std::max(sx0 + 1, static_cast<int>(static_cast<std::int64_t>(x + 1) * source.width / width));
+
+            std::uint32_t sum[3] = {0, 0, 0};
+            for (int sy = sy0; sy < sy1; ++sy) {
+                const unsigned char* row = &source.pixels[(static_cast<std::size_t>(sy) * source.width + sx0) * 3];
+                for (int sx = sx0; sx < sx1; ++sx, row += 3) {
+                    sum[0] += row[0];
+                    sum[1] += row[1];
+                    sum[2] += row[2];
+                }
+            }
+
+            const std::uint32_t count = static_cast<std::uint32_t>((sy1 - sy0) * (sx1 - sx0));
+            unsigned char* target = &output.pixels[(static_cast<std::size_t>(y) * width + x) * 3];
+            for (int c = 0; c < 3; ++c) {
+                target[c] = static_cast<unsigned char>((sum[c] + count / 2) / count);
+            }
+        }
+    }
+    return output;
+}
+
+struct JpegErrorManager {
+    jpeg_error_mgr base;
+    std::jmp_buf jump;
+};
+
+void onJpegError(j_common_ptr info) {
+    std::longjmp(reinterpret_cast<JpegErrorManager*>(info->err)->jump, 1);
+}
+
+// 损坏图片的警告不输出到 stderr
+void onJpegMessage(j_common_ptr) {}
+
+// 解码时利用 DCT 缩放直接得到不小于目标宽度的最小尺寸
+bool decodeJpeg(const std::string& data, int targetWidth, RgbImage& image) {
+    jpeg_decompress_struct info;
+    JpegErrorManager error;
+    info.err = jpeg_std_error(&error.base);
+    error.base.error_exit = onJpegError;
+    error.base.output_message = onJpegMessage;
+    if (setjmp(error.jump)) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, reinterpret_cast<const unsigned char*>(data.data()), static_cast<unsigned long>(data.size()));
+    jpeg_read_header(&info, TRUE);
+    info.out_color_space = JCS_RGB;
+    info.scale_num = 1;
+    info.scale_denom = 1;
+    while (info.scale_denom < 8 && info.image_width / (info.scale_denom * 2) >= static_cast<unsigned int>(targetWidth)) {
+        info.scale_denom *= 2;
+    }
+    jpeg_calc_output_dimensions(&info);
+    if (static_cast<std::size_t>(info.output_width) * info.output_height > kMaxDecodedPixels) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    jpeg_start_decompress(&info);
+    image.width = static_cast<int>(info.output_width);
+    image.height = static_cast<int>(info.output_height);
+    image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 3);
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW row = &image.pixels[static_cast<std::size_t>(info.output_scanline) * image.width * 3];
+        jpeg_read_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+
+// 输出缓冲区由调用方持有：longjmp 返回后，本函数中 setjmp 之后被修改过的非 volatile 局部变量取值不确定，
+// 而 jpeg_mem_dest 需要普通指针，无法把缓冲区声明为 volatile
+bool compressJpeg(const RgbImage& image, unsigned char** buffer, unsigned long* size) {
+    jpeg_compress_struct info;
+    JpegErrorManager error;
+    info.err = jpeg_std_error(&error.base);
+    error.base.error_exit = onJpegError;
+    error.base.output_message = onJpegMessage;
+    if (setjmp(error.jump)) {
+        jpeg_destroy_compress(&info);
+        return false;
+    }
+
+    jpeg_create_compress(&info);
+    jpeg_mem_dest(&info, buffer, size);
+    info.image_width = static_cast<JDIMENSION>(image.width);
+    info.image_height = static_cast<JDIMENSION>(image.height);
+    info.input_components = 3;
+    info.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&info);
+    jpeg_set_quality(&info, kJpegQuality, TRUE);
+    jpeg_start_compress(&info, TRUE);
+    while (info.next_scanline < info.image_height) {
+        JSAMPROW row = const_cast<unsigned char*>(&image.pixels[static_cast<std::size_t>(info.next_scanline) * image.width * 3]);
+        jpeg_write_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_compress(&info);
+    jpeg_destroy_compress(&info);
+    return true;
+}
+
+bool encodeJpeg(const RgbImage& image, std::string& output) {
+    unsigned char* buffer = nullptr;
+    unsigned long size = 0;
+    const bool encoded = compressJpeg(image, &buffer, &size);
+    if (encoded) {
+        output.assign(reinterpret_cast<const char*>(buffer), size);
+    }
+    // 出错时 libjpeg 可能已经分配了缓冲区
+    std::free(buffer);
+    return encoded;
+}
+#endif
+
+#if defined(MYTV_HAVE_JPEG) && defined(MYTV_HAVE_PNG)
+// 透明区域与页面背景色合成
+bool decodePng(const std::string& data, RgbImage& image) {
+    png_image info{};
+    info.version = PNG_IMAGE_VERSION;
+    if (!png_image_begin_read_from_memory(&info, data.data(), data.size())) {
+        return false;
+    }
+    if (static_cast<std::size_t>(info.width) * info.height > kMaxDecodedPixels) {
+        png_image_free(&info);
+        return false;
+    }
+
+    info.format = PNG_FORMAT_RGB;
+    image.width = static_cast<int>(info.width);
+    image.height = static_cast<int>(info.height);
+    image.pixels.resize(PNG_IMAGE_SIZE(info));
+    png_color background{18, 18, 18};
+    if (!png_image_finish_read(&info, &background, image.pixels.data(), 0, nullptr)) {
+        png_image_free(&info);
+        return false;
+    }
+    return true;
+}
+#endif
+}
+
+namespace thumbnail {
+
+std::string detectContentType(const std::string& data) {
+    if (startsWith(data, "\xFF\xD8\xFF", 3)) {
+        return "image/jpeg";
+    }
+    if (startsWith(data, "\x89PNG\r\n\x1A\n", 8)) {
+        return "image/png";
+    }
+    if (startsWith(data, "GIF87a", 6) || startsWith(data, "GIF89a", 6)) {
+        return "image/gif";
+    }
+    if (startsWith(data, "RIFF", 4) && startsWith(data, "WEBP", 4, 8)) {
+        return "image/webp";
+    }
+    return "";
+}
+
+bool canResize(const std::string& contentType) {
+#ifdef MYTV_HAVE_JPEG
+    if (contentType == "image/jpeg") {
+        return true;
+    }
+#ifdef MYTV_HAVE_PNG
+    if (contentType == "image/png") {
+        return true;
+    }
+#endif
+#endif
+    (void)contentType;
+    return false;
+}
+
+bool makeJpegThumbnail(const std::string& data, int width, std::string& output) {
+    const std::string contentType = detectContentType(data);
+    if (width <= 0 || !canResize(contentType)) {
+        return false;
+    }
+
+#ifdef MYTV_HAVE_JPEG
+    RgbImage image;
+    bool decoded = false;
+    if (contentType == "image/jpeg") {
+        decoded = decodeJpeg(data, width, image);
+    }
+#ifdef MYTV_HAVE_PNG
+    if (contentType == "image/png") {
+        decoded = decodePng(data, image);
+    }
+#endif
+    if (!decoded || image.width <= 0 || image.height <= 0) {
+        return false;
+    }
+
+    if (image.width > width) {
+        const int height = std::max(1, static_cast<int>(static_cast<std::int64_t>(image.height) * width / image.width));
+        image = resizeBox(image, width, height);
+    } else if (contentType == "image/jpeg" && image.width < width) {
+        // 原图窄于目标宽度时不放大，直接使用原始 JPEG
+        output = data;
+        return true;
+    }
+    return encodeJpeg(image, output);
+#else
+    return false;
+#endif
+}
+
+}
@@ -0,0 +1,22 @@
+// thumbnail.h
+#ifndef THUMBNAIL_H
+#define THUMBNAIL_H
+
+#include <string>
+
+// 海报缩略图：解码 JPEG/PNG，按宽度等比缩小后编码为 JPEG。
+// 编译时未找到 libjpeg / libpng 的格式不做缩放，调用方直接使用原图。
+namespace thumbnail {
+
+// 由文件头判断图片类型，返回 MIME 类型，无法识别时返回空字符串
+std::string detectContentType(const std::string& data);
+
+// 当前构建能否为该类型生成缩略图
+bool canResize(const std::string& contentType);
+
+// 缩放到指定宽度（不放大）并编码为 JPEG，失败时返回 false
+bool makeJpegThumbnail(const std::string& data, int width, std::string& output);
+
+}
+
+#endif // THUMBNAIL_H
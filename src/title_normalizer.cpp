@@ -0,0 +1,172 @@
+#include "title_normalizer.h"
+#include <utility>
+#include "text_util.h"
+
+namespace {
+// 模糊匹配时键至少需要的码点数量，过短的标题只做精确合并
+constexpr std::size_t kMinFuzzyKeyLength = 3;
+
+bool isChineseNumeral(char32_t c) {
+    static const std::u32string numerals = U"零一二三四五六七八九十百两";
+    return numerals.find(c) != std::u32string::npos;
+}
+
+bool isAsciiLetter(char32_t c) {
+    return c >= U'a' && c <= U'z';
+}
+
+// 去掉 "第2季"、"第二季"、"season 2" 以及末尾的 "s2" 这类季数标记
+std::u32string removeSeasonMarkers(const std::u32string& input) {
+    std::u32string output;
+    output.reserve(input.size());
+
+    std::size_t i = 0;
+    while (i < input.size()) {
+        if (input[i] == U'第') {
+            std::size_t j = i + 1;
+            while (j < input.size() && (text::isAsciiDigit(input[j]) || isChineseNumeral(input[j]))) {
+                ++j;
+            }
+            if (j > i + 1 && j < input.size() && input[j] == U'季') {
+                i = j + 1;
+                continue;
+            }
+        }
+
+        if (input.compare(i, 6, U"season") == 0) {
+            std::size_t j = i + 6;
+            while (j < input.size() && input[j] == U' ') {
+                ++j;
+            }
+            std::size_t k = j;
+            while (k < input.size() && text::isAsciiDigit(input[k])) {
+                ++k;
+            }
+            if (k > j) {
+                i = k;
+                continue;
+            }
+        }
+
+        output.push_back(input[i]);
+        ++i;
+    }
+
+    std::size_t end = output.size();
+    while (end > 0 && text::isAsciiDigit(output[end - 1])) {
+        --end;
+    }
+    if (end < output.size() && end > 0 && output[end - 1] == U's' &&
+        (end == 1 || !isAsciiLetter(output[end - 2]))) {
+        output.erase(end - 1);
+    }
+
+    return output;
+}
+
+std::u32string digitsOf(const std::u32string& key) {
+    std::u32string digits;
+    for (char32_t c : key) {
+        if (text::isAsciiDigit(c)) {
+            digits.push_back(c);
+        }
+    }
+    return digits;
+}
+}
+
+std::u32string TitleNormalizer::normalizeCodePoints(const std::string& title) {
+    const std::u32string folded = removeSeasonMarkers(text::foldWidth(text::decodeUtf8(title)));
+
+    std::u32string key;
+    key.reserve(folded.size());
+    for (char32_t c : folded) {
+        if (!text::isSpaceOrPunctuation(c)) {
+            key.push_back(c);
+        }
+    }
+
+    // 全部由标点组成的标题保留原样，避免被合并到同一个空键
+    if (key.empty()) {
+        return text::decodeUtf8(title);
+    }
+    return key;
+}
+
+std::string TitleNormalizer::normalize(const std::string& title) {
+    return text::encodeUtf8(normalizeCodePoints(title));
+}
+
+TitleMergeIndex::TitleMergeIndex(double similarityThreshold)
+    : similarityThreshold_(similarityThreshold) {}
+
+std::size_t TitleMergeIndex::groupCount() const {
+    return groups_.size();
+}
+
+bool TitleMergeIndex::isCompatible(const std::u32string& a, const std::u32string& b) const {
+    if (a.size() < kMinFuzzyKeyLength || b.size() < kMinFuzzyKeyLength) {
+        return false;
+    }
+    // 数字不同通常代表不同作品（如续集），不做合并
+    return digitsOf(a) == digitsOf(b);
+}
+
+std::size_t TitleMergeIndex::createGroup(const std::string& keyUtf8, std::u32string key, std::vector<std::uint64_t> grams) {
+    const std::size_t groupId = groups_.size();
+    if (key.size() >= kMinFuzzyKeyLength) {
+        for (std::uint64_t gram : grams) {
+            gramIndex_[gram].push_back(groupId);
+        }
+    }
+
+    groups_.push_back(Group{std::move(key), std::move(grams)});
+    exactGroups_.emplace(keyUtf8, groupId);
+    return groupId;
+}
+
+std::size_t TitleMergeIndex::assign(const std::string& title) {
+    std::u32string key = TitleNormalizer::normalizeCodePoints(title);
+    const std::string keyUtf8 = text::encodeUtf8(key);
+
+    const auto exactIt = exactGroups_.find(keyUtf8);
+    if (exactIt != exactGroups_.end()) {
+        return exactIt->second;
+    }
+
+    std::vector<std::uint64_t> grams = text::collectBigrams(key);
+    if (key.size() < kMinFuzzyKeyLength) {
+        return createGroup(keyUtf8, std::move(key), std::move(grams));
+    }
+
+    // 统计每个候选分组与当前键共享的 bigram 数量
+    std::unordered_map<std::size_t, std::size_t> sharedCounts;
+    for (std::uint64_t gram : grams) {
+        const auto it = gramIndex_.find(gram);
+        if (it == gramIndex_.end()) {
+            continue;
+        }
+        for (std::size_t groupId : it->second) {
+            sharedCounts[groupId]++;
+        }
+    }
+
+    std::size_t bestGroup = groups_.size();
+    double bestScore = 0.0;
+    for (const auto& [groupId, shared] : sharedCounts) {
+        const Group& group = groups_[groupId];
+        const double unionSize = static_cast<double>(grams.size() + group.grams.size() - shared);
+        const double score = unionSize > 0 ? static_cast<double>(shared) / unionSize : 0.0;
+        if (score >= similarityThreshold_ && score > bestScore && isCompatible(key, group.key)) {
+            bestScore = score;
+            bestGroup = groupId;
+        }
+    }
+
+    if (bestGroup < groups_.size()) {
+        exactGroups_.emplace(keyUtf8, bestGroup);
+        return bestGroup;
+    }
+
+    return createGroup(keyUtf8, std::move(key), std::move(grams));
+}
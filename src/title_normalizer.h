@@ -0,0 +1,47 @@
+// title_normalizer.h
+#ifndef TITLE_NORMALIZER_H
+#define TITLE_NORMALIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 标题归一化：全角转半角、大小写折叠、去掉季数标记、空白和标点
+// 例如 "凡人修仙传[第2季]"、"凡人修仙传 " 都会得到 "凡人修仙传"
+class TitleNormalizer {
+public:
+    static std::string normalize(const std::string& title);
+    static std::u32string normalizeCodePoints(const std::string& title);
+};
+
+// 近似标题归并索引：先按归一化键精确匹配，再用 bigram 倒排索引
+// 查找 Jaccard 相似度达到阈值的已有分组
+class TitleMergeIndex {
+public:
+    explicit TitleMergeIndex(double similarityThreshold);
+
+    // 返回标题所属分组的 id，没有足够相似的分组时新建一个
+    std::size_t assign(const std::string& title);
+
+    std::size_t groupCount() const;
+
+private:
+    struct Group {
+        std::u32string key;
+        std::vector<std::uint64_t> grams;
+    };
+
+    // 两个归一化键是否允许模糊合并
+    bool isCompatible(const std::u32string& a, const std::u32string& b) const;
+
+    std::size_t createGroup(const std::string& keyUtf8, std::u32string key, std::vector<std::uint64_t> grams);
+
+    double similarityThreshold_;
+    std::vector<Group> groups_;
+    std::unordered_map<std::string, std::size_t> exactGroups_;
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> gramIndex_;
+};
+
+#endif // TITLE_NORMALIZER_H
@@ -0,0 +1,179 @@
+#include "video_catalog.h"
+#include <algorithm>
+#include <iterator>
+#include "title_normalizer.h"
+
+namespace {
+std::string trim(const std::string& value) {
+    const auto first = value.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) {
+        return "";
+    }
+
+    const auto last = value.find_last_not_of(" \t\r\n");
+    return value.substr(first, last - first + 1);
+}
+
+// 同一分组前后两次的条目是否一致，用于判断分组是否需要重建索引（不比较健康度）
+bool sameVideos(const std::vector<VideoInfo>& a, const std::vector<VideoInfo>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        const VideoInfo& x = a[i];
+        const VideoInfo& y = b[i];
+        if (x.vod_id != y.vod_id || x.site != y.site || x.source != y.source ||
+            x.vod_name != y.vod_name || x.vod_sub != y.vod_sub || x.vod_remarks != y.vod_remarks ||
+            x.vod_pic != y.vod_pic || x.vod_content != y.vod_content ||
+            x.detail_loaded != y.detail_loaded || x.play_urls != y.play_urls) {
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+namespace catalog {
+
+// 精确键相同直接合并，近似标题通过 bigram 相似度合并。
+// 视频源多的标题优先建组，合并后的分组使用其原始名称作为展示名。
+std::size_t mergeEquivalentTitles(VideoCatalog& allVideos, double threshold) {
+    std::vector<VideoCatalog::iterator> order;
+    order.reserve(allVideos.size());
+    for (auto it = allVideos.begin(); it != allVideos.end(); ++it) {
+        order.push_back(it);
+    }
+
+    std::stable_sort(order.begin(), order.end(), [](const auto& a, const auto& b) {
+        if (a->second.size() != b->second.size()) {
+            return a->second.size() > b->second.size();
+        }
+        return a->first.size() < b->first.size();
+    });
+
+    TitleMergeIndex index(threshold);
+    std::vector<std::string> displayNames;
+    VideoCatalog merged;
+
+    for (auto it : order) {
+        const std::size_t groupId = index.assign(it->first);
+        if (groupId >= displayNames.size()) {
+            const std::string displayName = trim(it->first);
+            displayNames.resize(groupId + 1);
+            displayNames[groupId] = displayName.empty() ? it->first : displayName;
+        }
+
+        std::vector<VideoInfo>& target = merged[displayNames[groupId]];
+        target.insert(target.end(),
+                      std::make_move_iterator(it->second.begin()),
+                      std::make_move_iterator(it->second.end()));
+    }
+
+    // 组内按站点和 ID 排序，条目顺序与文件读取顺序、分页完成顺序无关
+    for (auto& [title, videos] : merged) {
+        std::stable_sort(videos.begin(), videos.end(), [](const VideoInfo& a, const VideoInfo& b) {
+            return a.site != b.site ? a.site < b.site : a.vod_id < b.vod_id;
+        });
+    }
+
+    const std::size_t mergedCount = allVideos.size() - merged.size();
+    allVideos.swap(merged);
+    return mergedCount;
+}
+
+PartitionedCatalog::PartitionedCatalog(double threshold)
+    : threshold_(threshold) {
+}
+
+void PartitionedCatalog::reset(const VideoCatalog& titles) {
+    titles_ = titles;
+}
+
+std::set<std::string> PartitionedCatalog::replacePartitions(std::map<std::string, std::vector<VideoInfo>> partitions) {
+    // 与启动时加载缓存相同：按原始标题汇总所有站点的条目，再跨站点按视频源数量统一归并
+    VideoCatalog merged;
+    for (auto& [site, videos] : partitions) {
+        for (auto& video : videos) {
+            video.site = site;
+            merged[video.vod_name].push_back(std::move(video));
+        }
+    }
+    mergeEquivalentTitles(merged, threshold_);
+
+    std::set<std::string> changed;
+    for (const auto& [title, videos] : merged) {
+        const auto it = titles_.find(title);
+        if (it == titles_.end() || !sameVideos(it->second, videos)) {
+            changed.insert(title);
+        }
+    }
+    for (const auto& [title, videos] : titles_) {
+        if (merged.count(title) == 0) {
+            changed.insert(title);
+        }
+    }
+
+    titles_.swap(merged);
+    return changed;
+}
+
+const VideoCatalog& PartitionedCatalog::titles() const {
+    return titles_;
+}
+
+VideoCatalog& PartitionedCatalog::titles() {
+    return titles_;
+}
+
+crow::json::wvalue toPlayUrlsJson(const VideoInfo& video) {
+    crow::json::wvalue playUrls;
+
+    for (const auto& [source, urls] : video.play_urls) {
+        crow::json::wvalue urlArray;
+        int urlIndex = 0;
+
+        for (const auto& [epName, url] : urls) {
+            crow::json::wvalue urlObj;
+            urlObj["name"] = epName;
+            urlObj["url"] = url;
+            urlArray[urlIndex++] = std::move(urlObj);
+        }
+
+        playUrls[source] = std::move(urlArray);
+    }
+
+    return playUrls;
+}
+
+crow::json::wvalue toVideoJson(const VideoInfo& video) {
+    crow::json::wvalue videoObj;
+    videoObj["vod_id"] = video.vod_id;
+    videoObj["vod_name"] = video.vod_name;
+    videoObj["source"] = video.source;
+    videoObj["vod_sub"] = video.vod_sub;
+    videoObj["vod_content"] = video.vod_content;
+    videoObj["vod_pic"] = video.vod_pic;
+    videoObj["play_urls"] = toPlayUrlsJson(video);
+    videoObj["health_score"] = video.health_score;
+    videoObj["detail_loaded"] = video.detail_loaded;
+    return videoObj;
+}
+
+crow::json::wvalue toCatalogJson(const VideoCatalog& catalog) {
+    crow::json::wvalue result;
+
+    for (const auto& [name, videos] : catalog) {
+        crow::json::wvalue videoArray;
+        int videoIndex = 0;
+
+        for (const auto& video : videos) {
+            videoArray[videoIndex++] = toVideoJson(video);
+        }
+
+        result[name] = std::move(videoArray);
+    }
+
+    return result;
+}
+
+} // namespace catalog
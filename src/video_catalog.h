@@ -0,0 +1,55 @@
+// video_catalog.h
+#ifndef VIDEO_CATALOG_H
+#define VIDEO_CATALOG_H
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "crow/crow.h"
+#include "json_parser.h"
+#include "title_normalizer.h"
+
+// 按标题分组的视频目录：合并等价标题并转换为接口返回的 JSON
+namespace catalog {
+
+using VideoCatalog = std::map<std::string, std::vector<VideoInfo>>;
+
+// 标题的字符 bigram Jaccard 相似度达到该值时归入同一分组，服务和基准测试共用
+constexpr double kTitleMergeThreshold = 0.8;
+
+// 按归一化标题合并分组，返回被合并掉的分组数量
+std::size_t mergeEquivalentTitles(VideoCatalog& allVideos, double threshold);
+
+// 由各站点的搜索结果组成的目录：一次搜索的全部站点结果一起传入，与启动时从缓存加载一样
+// 先汇总全部站点的条目再统一归并标题，分组和展示名只取决于目录内容，与更新历史无关。
+// 每次替换都整体重新归并，不做按站点的增量更新。
+// 不是线程安全的，由调用方加锁
+class PartitionedCatalog {
+public:
+    explicit PartitionedCatalog(double threshold = kTitleMergeThreshold);
+
+    // 用已归并好的目录整体替换（启动时从缓存加载）
+    void reset(const VideoCatalog& titles);
+
+    // 用一次搜索的全部结果整体替换，partitions 按站点划分，没有出现的站点不再保留。
+    // 返回内容有变化的标题分组（包括被删除的分组），未变化的分组调用方无需重建索引
+    std::set<std::string> replacePartitions(std::map<std::string, std::vector<VideoInfo>> partitions);
+
+    const VideoCatalog& titles() const;
+    // 只允许修改条目内容（如补全详情），不能改变标题或站点
+    VideoCatalog& titles();
+
+private:
+    double threshold_;
+    VideoCatalog titles_;
+};
+
+crow::json::wvalue toPlayUrlsJson(const VideoInfo& video);
+crow::json::wvalue toVideoJson(const VideoInfo& video);
+crow::json::wvalue toCatalogJson(const VideoCatalog& catalog);
+
+} // namespace catalog
+
+#endif // VIDEO_CATALOG_H
@@ -9,9 +9,15 @@
 #include <mutex>
 #include <sstream>
 #include <chrono>
+#include <cstdint>
 #include <nlohmann/json.hpp>
 #include "web_server.h"
+#include "atomic_file_writer.h"
+#include "gzip_stream.h"
 #include "https_json_client.h"
+#include "logger.h"
+#include "text_util.h"
+#include "video_catalog.h"
 
 using json = nlohmann::json;
 
@@ -21,66 +27,166 @@ struct SearchStats {
     int skippedSites = 0;
     int successfulResponses = 0;
     int savedFiles = 0;
+    int extraPages = 0;
+    int failedPages = 0;
+    int throttledRequests = 0;   // 因本地限速或截止时间没有发出的请求
 };
 
 struct SiteSearchResult {
     std::string domain;
     std::string siteName;
     bool requestSucceeded = false;
+    bool requestTimedOut = false;
+    bool throttled = false;      // 请求没有发出，不代表站点故障
+    bool cancelled = false;
     bool fileSaved = false;
+    std::size_t page = 1;
+    std::size_t pageCount = 0;   // 响应中的 pagecount，未找到时为 0
+    std::chrono::milliseconds latency{0};
+    HTTPSJsonClient::TransferSize transfer;
+    std::filesystem::path savedFile;
+    std::vector<VideoInfo> videos;   // 从已保存的页面解析出的条目
 };
 
-struct CatalogLoadStats {
-    int parsedFiles = 0;
-    int skippedFiles = 0;
-    int loadedVideos = 0;
-    int skippedVideos = 0;
+// 搜索中一个站点的分区：搜索成功结束后与其他站点的分区一起替换目录
+struct ProviderPartition {
+    std::size_t pagesPending = 0;
+    std::vector<VideoInfo> videos;
 };
 
-constexpr std::size_t kMaxConcurrentSearches = 4;
-constexpr int kMaxSiteFailureCount = 5;
-constexpr const char* kLogModule = "WebServer";
-constexpr const char* kSiteUpdateUrl = "https://pz.v88.qzz.io/?format=0&source=jin18";
+// 一个请求占用的自适应并发名额：重试退避期间归还，退避结束后在截止时间前重新获取
+class LimiterSlot {
+public:
+    LimiterSlot(ConcurrencyLimiter& limiter, std::string host)
+        : limiter_(limiter)
+        , host_(std::move(host)) {
+    }
+
+    LimiterSlot(const LimiterSlot&) = delete;
+    LimiterSlot& operator=(const LimiterSlot&) = delete;
+
+    void release(std::chrono::milliseconds latency, ConcurrencyLimiter::Outcome outcome) {
+        if (held_) {
+            limiter_.release(host_, latency, outcome);
+            held_ = false;
+        }
+    }
+
+    bool reacquire(std::chrono::steady_clock::time_point deadline) {
+        if (held_) {
+            return true;
+        }
+        std::size_t index = 0;
+        if (deadline == std::chrono::steady_clock::time_point::max()) {
+            limiter_.acquireAny({host_});
+            held_ = true;
+            return true;
+        }
+        const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        held_ = remaining.count() > 0 && limiter_.tryAcquireAny({host_}, index, remaining);
+        return held_;
+    }
 
-enum class LogLevel {
-    Info,
-    Error
+private:
+    ConcurrencyLimiter& limiter_;
+    std::string host_;
+    bool held_ = true;
 };
 
-std::mutex logMutex;
+// 单个站点请求的限速、重试和截止时间
+struct SiteRequestOptions {
+    TokenBucketLimiter* rateLimiter = nullptr;
+    HTTPSJsonClient::RetryPolicy retryPolicy;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    const std::atomic<bool>* cancelFlag = nullptr;
+    LimiterSlot* slot = nullptr;   // 调用方已获取的并发名额（不持有所有权）
+};
 
-template <typename... Args>
-void logMessage(LogLevel level, Args&&... args) {
-    std::ostringstream buffer;
-    (buffer << ... << std::forward<Args>(args));
+// 一次 ac=detail 请求：同一站点的一批 vod_id
+struct DetailBatch {
+    std::string site;       // 站点文件名
+    std::string domain;
+    std::string api;
+    std::string host;
+    std::vector<int> ids;
+};
 
-    const auto now = std::chrono::system_clock::now();
-    const std::time_t nowTime = std::chrono::system_clock::to_time_t(now);
-    std::tm timeInfo{};
-#ifdef _WIN32
-    localtime_s(&timeInfo, &nowTime);
-#else
-    localtime_r(&nowTime, &timeInfo);
-#endif
+struct DetailBatchResult {
+    std::string domain;
+    std::string site;
+    std::vector<int> ids;
+    std::string response;   // 原始响应，合并后与分页文件一起保存
+    bool requestSucceeded = false;
+    bool requestTimedOut = false;
+    bool throttled = false;
+    std::chrono::milliseconds latency{0};
+    HTTPSJsonClient::TransferSize transfer;
+    std::vector<VideoInfo> videos;
+};
 
-    std::ostringstream timestamp;
-    timestamp << std::put_time(&timeInfo, "%Y-%m-%d %H:%M:%S");
+// 等待并发名额的站点或分页请求
+struct PendingSite {
+    std::string domain;
+    json site;
+    std::string host;
+    std::size_t page = 1;
+};
 
-    std::lock_guard<std::mutex> lock(logMutex);
-    std::ostream& stream = level == LogLevel::Error ? std::cerr : std::cout;
-    stream << '[' << timestamp.str() << "] [" << kLogModule << "] "
-           << (level == LogLevel::Error ? "[ERROR] " : "[INFO] ")
-           << buffer.str() << std::endl;
-}
+struct CatalogLoadStats {
+    int parsedFiles = 0;
+    int skippedFiles = 0;
+    int loadedVideos = 0;
+    int skippedVideos = 0;
+    int restoredDetails = 0;   // 从已保存的详情文件补回的摘要条目
+};
+
+// 单个站点搜索响应的大小上限
+constexpr std::size_t kMaxSearchResponseBytes = 32u * 1024 * 1024;
+// 一次搜索的总时限
+constexpr auto kSearchDeadline = std::chrono::seconds(30);
+// 等待站点请求完成时检查其它任务的间隔
+constexpr auto kSearchTaskPollInterval = std::chrono::milliseconds(10);
+// 每个 ac=detail 请求携带的 vod_id 数量和一次补全的总时限；打开标题时有用户在等待，时限更短
+constexpr std::size_t kDetailBatchSize = 20;
+constexpr auto kDetailDeadline = std::chrono::seconds(15);
+constexpr auto kDetailOpenDeadline = std::chrono::seconds(5);
+constexpr std::size_t kDefaultLocalSearchLimit = 20;
+constexpr std::size_t kMaxLocalSearchLimit = 100;
+constexpr std::size_t kDefaultSuggestLimit = 8;
+// 目录持续变化时在锁外重建索引的最多次数
+constexpr std::size_t kIndexBuildAttempts = 3;
+// 用户成功搜索过的关键词每次累加的联想权重，标题的权重为视频源数量
+constexpr double kSearchKeywordWeight = 5.0;
+constexpr int kDefaultPosterWidth = 320;
+constexpr const char* kPosterCacheControl = "public, max-age=86400";
+// Range 请求读入内存返回的最大字节数，更大的区间改为流式发送完整文件
+constexpr std::uint64_t kMaxRangeBytes = 16u * 1024 * 1024;
+// 默认同时执行的后台任务数和排队上限
+constexpr std::size_t kDefaultBackgroundThreads = 2;
+constexpr std::size_t kBackgroundQueueLimit = 16;
+// 打开标题时的详情补全在独立的执行器上运行，不占用 HTTP 工作线程，也不与搜索争用后台名额
+constexpr std::size_t kDetailRequestThreads = 8;
+constexpr std::size_t kDetailRequestQueueLimit = 64;
+// HLS 代理和海报代理缓存未命中时的上游请求同样在独立的执行器上运行
+constexpr std::size_t kMediaRequestThreads = 16;
+constexpr std::size_t kMediaRequestQueueLimit = 128;
+// 只有探测结果变化时，序列化好的目录至少保留这么久再重建
+constexpr auto kCatalogHealthRefreshInterval = std::chrono::seconds(2);
+// 搜索排队已满时建议客户端的重试间隔（秒）
+constexpr int kSearchRetryAfterSeconds = 2;
+// 搜索结果先写入 output 下的这个子目录，搜索成功后才替换 output 中的文件
+constexpr const char* kSearchStagingDir = "_staging";
+constexpr const char* kLogModule = "WebServer";
+constexpr const char* kSiteUpdateUrl = "https://pz.v88.qzz.io/?format=0&source=jin18";
 
 template <typename... Args>
 void logInfo(Args&&... args) {
-    logMessage(LogLevel::Info, std::forward<Args>(args)...);
+    logger::logMessage(kLogModule, logger::LogLevel::Info, std::forward<Args>(args)...);
 }
 
 template <typename... Args>
 void logError(Args&&... args) {
-    logMessage(LogLevel::Error, std::forward<Args>(args)...);
+    logger::logMessage(kLogModule, logger::LogLevel::Error, std::forward<Args>(args)...);
 }
 
 bool isSubPath(const std::filesystem::path& base, const std::filesystem::path& candidate) {
@@ -119,24 +225,9 @@ const char* contentTypeForPath(const std::string& path) {
     return nullptr;
 }
 
-bool readFileContent(const std::filesystem::path& filePath, std::string& content) {
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file) {
-        return false;
-    }
-
-    content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
-    return true;
-}
-
-bool writeFileContent(const std::filesystem::path& filePath, const std::string& content) {
-    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
-    if (!file) {
-        return false;
-    }
-
-    file.write(content.data(), static_cast<std::streamsize>(content.size()));
-    return static_cast<bool>(file);
+bool writeFileContent(AtomicFileWriter& writer, const std::filesystem::path& filePath, const std::string& content) {
+    // 配置文件写入后立即落盘；只同步这一个文件，不替搜索结果提前执行批量同步
+    return writer.write(filePath, content) && writer.flushFile(filePath);
 }
 
 crow::response makeJsonResponse(int code, bool ok, const std::string& message) {
@@ -146,52 +237,130 @@ crow::response makeJsonResponse(int code, bool ok, const std::string& message) {
     return crow::response(code, body);
 }
 
-crow::json::wvalue toPlayUrlsJson(const VideoInfo& video) {
-    crow::json::wvalue playUrls;
-
-    for (const auto& [source, urls] : video.play_urls) {
-        crow::json::wvalue urlArray;
-        int urlIndex = 0;
-
-        for (const auto& [epName, url] : urls) {
-            crow::json::wvalue urlObj;
-            urlObj["name"] = epName;
-            urlObj["url"] = url;
-            urlArray[urlIndex++] = std::move(urlObj);
-        }
+// 在连接所属的 io 线程上结束异步响应：Crow 的连接对象只能在自己的 io 线程上写入
+void finishAsyncResponse(crow::asio::io_context* io, crow::response& res, crow::response result) {
+    auto pending = std::make_shared<crow::response>(std::move(result));
+    crow::asio::post(*io, [&res, pending]() {
+        res = std::move(*pending);
+        res.end();
+    });
+}
 
-        playUrls[source] = std::move(urlArray);
+// 搜索任务的进度：汇总计数加每个站点的状态
+crow::json::wvalue searchJobJson(const SearchJob::Snapshot& snapshot) {
+    crow::json::wvalue body;
+    body["ok"] = snapshot.state != SearchJob::State::Failed && snapshot.state != SearchJob::State::Cancelled;
+    body["id"] = snapshot.id;
+    body["keyword"] = snapshot.keyword;
+    body["state"] = SearchJob::stateName(snapshot.state);
+    body["message"] = snapshot.message;
+    body["elapsed_ms"] = static_cast<long long>(snapshot.elapsed.count());
+    body["titles"] = snapshot.titles;
+
+    std::size_t sitesDone = 0;
+    std::size_t sitesFailed = 0;
+    std::size_t sitesSkipped = 0;
+    std::size_t pagesDone = 0;
+    std::size_t pagesPending = 0;
+    std::size_t savedFiles = 0;
+    std::vector<crow::json::wvalue> sites;
+    sites.reserve(snapshot.sites.size());
+    for (const auto& progress : snapshot.sites) {
+        const bool done = progress.skipped || (progress.pagesDone > 0 && progress.pagesPending == 0);
+        const char* state = progress.skipped ? "skipped" : progress.failed ? "failed" : done ? "done" : "pending";
+        sitesDone += done ? 1 : 0;
+        sitesFailed += progress.failed ? 1 : 0;
+        sitesSkipped += progress.skipped ? 1 : 0;
+        pagesDone += progress.pagesDone;
+        pagesPending += progress.pagesPending;
+        savedFiles += progress.savedFiles;
+
+        crow::json::wvalue site;
+        site["site"] = progress.site;
+        site["name"] = progress.name;
+        site["state"] = state;
+        site["pages_done"] = progress.pagesDone;
+        site["pages_pending"] = progress.pagesPending;
+        site["saved_files"] = progress.savedFiles;
+        sites.push_back(std::move(site));
     }
 
-    return playUrls;
+    body["sites_total"] = snapshot.sites.size();
+    body["sites_done"] = sitesDone;
+    body["sites_pending"] = snapshot.sites.size() - sitesDone;
+    body["sites_failed"] = sitesFailed;
+    body["sites_skipped"] = sitesSkipped;
+    body["pages_done"] = pagesDone;
+    body["pages_pending"] = pagesPending;
+    body["saved_files"] = savedFiles;
+    body["sites"] = std::move(sites);
+    return body;
 }
 
-crow::json::wvalue toVideoJson(const VideoInfo& video) {
-    crow::json::wvalue videoObj;
-    videoObj["vod_id"] = video.vod_id;
-    videoObj["vod_name"] = video.vod_name;
-    videoObj["source"] = video.source;
-    videoObj["vod_sub"] = video.vod_sub;
-    videoObj["vod_content"] = video.vod_content;
-    videoObj["play_urls"] = toPlayUrlsJson(video);
-    return videoObj;
+// 剧集名中的第一个数字（如“第3集”中的 3），没有数字时返回 -1
+long episodeNumber(const std::string& name) {
+    const auto first = std::find_if(name.begin(), name.end(), [](char c) {
+        return c >= '0' && c <= '9';
+    });
+    long number = -1;
+    for (auto it = first; it != name.end() && *it >= '0' && *it <= '9' && number < 100000000; ++it) {
+        number = (number < 0 ? 0 : number * 10) + (*it - '0');
+    }
+    return number;
 }
 
-crow::json::wvalue toCatalogJson(const std::map<std::string, std::vector<VideoInfo>>& catalog) {
-    crow::json::wvalue result;
-
-    for (const auto& [name, videos] : catalog) {
-        crow::json::wvalue videoArray;
-        int videoIndex = 0;
+bool isPlaylistUrl(const std::string& url) {
+    const std::string path = url.substr(0, url.find('?'));
+    return path.size() >= 5 && path.compare(path.size() - 5, 5, ".m3u8") == 0;
+}
 
-        for (const auto& video : videos) {
-            videoArray[videoIndex++] = toVideoJson(video);
+// 每个视频源的第一集，用于探测可用性：优先 m3u8 分组，分组内按剧集编号取最小的一集，
+// 没有编号时按列表顺序；有的站点把最新一集排在最前面，不能直接取列表第一项
+std::string firstEpisodeUrl(const VideoInfo& video) {
+    std::string fallback;
+    for (const auto& [group, episodes] : video.play_urls) {
+        const std::pair<std::string, std::string>* first = nullptr;
+        long firstNumber = -1;
+        for (const auto& episode : episodes) {
+            if (!isPlaylistUrl(episode.second)) {
+                continue;
+            }
+            const long number = episodeNumber(episode.first);
+            if (!first || (number >= 0 && (firstNumber < 0 || number < firstNumber))) {
+                first = &episode;
+                firstNumber = number;
+            }
+        }
+        if (first) {
+            return first->second;
         }
+        if (fallback.empty() && !episodes.empty()) {
+            fallback = episodes.front().second;
+        }
+    }
+    return fallback;
+}
 
-        result[name] = std::move(videoArray);
+// 排序依据：已测得可播放的按评分，其次是尚未探测的，探测失败的排在最后
+double healthRank(const VideoInfo& video) {
+    if (video.health_score > 0) {
+        return 1.0 + video.health_score;
     }
+    return video.health_score < 0 ? 0.5 : 0.0;
+}
 
-    return result;
+void rankSourcesByHealth(std::map<std::string, std::vector<VideoInfo>>& catalog, const StreamHealthProber& prober) {
+    for (auto& [title, videos] : catalog) {
+        for (auto& video : videos) {
+            StreamHealth health;
+            if (prober.lookup(firstEpisodeUrl(video), health)) {
+                video.health_score = health.score;
+            }
+        }
+        std::stable_sort(videos.begin(), videos.end(), [](const VideoInfo& a, const VideoInfo& b) {
+            return healthRank(a) > healthRank(b);
+        });
+    }
 }
 
 bool ensureDirectoryExists(const std::filesystem::path& dirPath, const std::string& description) {
@@ -234,21 +403,49 @@ bool backupFileReplacingPrevious(const std::filesystem::path& sourceFile, const
     return !ec;
 }
 
-bool saveSearchResult(const std::filesystem::path& outputDir, const std::string& domain, const std::string& response) {
+// 第一页为 <站点>.json，后续页为 <站点>.page<N>.json；站点名中的 . 已替换为 _，不会与页码后缀混淆
+std::string searchResultFileName(const std::string& domain, std::size_t page) {
     std::string filename = domain;
     std::replace(filename.begin(), filename.end(), '.', '_');
+    if (page > 1) {
+        filename += ".page" + std::to_string(page);
+    }
+    return filename;
+}
 
-    std::ofstream outFile(outputDir / (filename + ".json"));
-    if (!outFile.is_open()) {
-        logError("无法创建文件: ", filename);
+bool saveSearchResult(
+    AtomicFileWriter& writer,
+    const std::filesystem::path& outputDir,
+    const std::string& filename,
+    const std::string& response) {
+    if (!writer.write(outputDir / (filename + ".json"), response)) {
+        logError("无法写入文件: ", filename);
         return false;
     }
 
-    outFile << response;
     logInfo("响应已保存到文件: ", filename);
     return true;
 }
 
+// 响应在下载过程中已经分块压缩，这里只写入 gzip 尾部并落盘
+bool saveCompressedSearchResult(
+    AtomicFileWriter& writer,
+    const std::filesystem::path& outputDir,
+    const std::string& filename,
+    GzipCompressor& compressor) {
+    if (!compressor.finish()) {
+        logError("压缩响应失败: ", filename);
+        return false;
+    }
+    if (!writer.write(outputDir / (filename + ".json.gz"), compressor.output())) {
+        logError("无法写入文件: ", filename);
+        return false;
+    }
+
+    logInfo("响应已压缩保存到文件: ", filename, ", ", compressor.inputBytes(), " -> ", compressor.output().size(), " 字节");
+    return true;
+}
+
 json loadApiSites(const json& source, const std::string& sourceFile) {
     if (!source.contains("api_site") || !source["api_site"].is_object()) {
         logError("配置文件缺少 api_site 对象: ", sourceFile);
@@ -258,24 +455,113 @@ json loadApiSites(const json& source, const std::string& sourceFile) {
     return source["api_site"];
 }
 
-void configureSearchClient(HTTPSJsonClient& client) {
+ConcurrencyLimiter::Outcome limiterOutcome(bool succeeded, bool timedOut, bool throttled = false) {
+    if (succeeded) {
+        return ConcurrencyLimiter::Outcome::Success;
+    }
+    if (throttled) {
+        return ConcurrencyLimiter::Outcome::Throttled;
+    }
+    return timedOut ? ConcurrencyLimiter::Outcome::Timeout : ConcurrencyLimiter::Outcome::Failure;
+}
+
+// 并发限制器只关心上游的响应速度，不计入限速等待和重试退避
+std::chrono::milliseconds lastAttemptLatency(const HTTPSJsonClient& client, std::chrono::milliseconds elapsed) {
+    const double lastAttemptSeconds = client.getLastTiming().totalSeconds;
+    return lastAttemptSeconds > 0.0
+               ? std::chrono::milliseconds(static_cast<long long>(lastAttemptSeconds * 1000.0))
+               : elapsed;
+}
+
+void configureSearchClient(HTTPSJsonClient& client, const SiteRequestOptions& options = SiteRequestOptions()) {
     client.setUserAgent("Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/122.0.0.0 Safari/537.36");
     client.setConnectTimeout(5);
     client.setRequestTimeout(10);
     client.setVerifySSL(true);
+    client.setMaxBodySize(kMaxSearchResponseBytes);
+    client.setRateLimiter(options.rateLimiter);
+    client.setRetryPolicy(options.retryPolicy);
+    client.setDeadline(options.deadline);
+    client.setCancelFlag(options.cancelFlag);
+    if (options.slot) {
+        // 退避等待时归还并发名额并提交失败那次请求的样本，让其他请求先用
+        LimiterSlot* slot = options.slot;
+        const auto deadline = options.deadline;
+        client.setRetryWaitCallbacks(
+            [&client, slot]() {
+                slot->release(lastAttemptLatency(client, std::chrono::milliseconds(0)),
+                              limiterOutcome(false, client.getLastErrorCode() == CURLE_OPERATION_TIMEDOUT));
+            },
+            [slot, deadline]() {
+                return slot->reacquire(deadline);
+            });
+    }
 }
 
+// 在响应流中查找 "pagecount":<数字>，不需要保留或解析完整响应。
+// 字符串值里的引号会被转义，所以未转义的 "pagecount": 只能是键
+class PageCountScanner {
+public:
+    void feed(const char* data, std::size_t size) {
+        if (pageCount_ > 0) {
+            return;
+        }
+
+        std::string window = tail_;
+        window.append(data, size);
+        std::size_t pos = window.find(kKey);
+        while (pos != std::string::npos) {
+            std::size_t i = pos + kKey.size();
+            while (i < window.size() && (window[i] == ' ' || window[i] == ':' || window[i] == '"')) {
+                ++i;
+            }
+            const std::size_t digits = i;
+            while (i < window.size() && window[i] >= '0' && window[i] <= '9') {
+                ++i;
+            }
+            if (i >= window.size()) {
+                break;      // 数字可能延续到下一块
+            }
+            if (i > digits && i - digits < 10) {
+                pageCount_ = static_cast<std::size_t>(std::stoul(window.substr(digits, i - digits)));
+                tail_.clear();
+                return;
+            }
+            pos = window.find(kKey, pos + 1);
+        }
+
+        // 保留可能被分块截断的键
+        const std::size_t keep = pos != std::string::npos ? pos : window.size() - std::min(window.size(), kKey.size() + 16);
+        tail_ = window.substr(keep);
+    }
+
+    std::size_t pageCount() const {
+        return pageCount_;
+    }
+
+private:
+    static inline const std::string kKey = "\"pagecount\"";
+    std::string tail_;
+    std::size_t pageCount_ = 0;
+};
+
 SiteSearchResult searchSingleSite(
+    AtomicFileWriter& writer,
     const std::filesystem::path& outputDir,
     const std::string& domain,
     const json& site,
-    const std::string& encodedKeyword) {
+    const std::string& query,
+    std::size_t page,
+    bool compress,
+    const SiteRequestOptions& options) {
     SiteSearchResult result;
     result.domain = domain;
+    result.page = page;
 
     try {
         HTTPSJsonClient client;
-        configureSearchClient(client);
+        configureSearchClient(client, options);
+        client.setTraced(true);
 
         if (!site.contains("api") || !site["api"].is_string()) {
             logError("站点配置缺少 api 字段: ", domain);
@@ -284,22 +570,56 @@ SiteSearchResult searchSingleSite(
 
         const std::string siteName = site.value("name", domain);
         result.siteName = siteName;
-        logInfo("查询 ", siteName);
+        logInfo("查询 ", siteName, page > 1 ? " 第 " + std::to_string(page) + " 页" : "");
+
+        // 开启压缩缓存时边下载边压缩，不在内存中保留完整的原始响应
+        GzipCompressor compressor;
+        PageCountScanner pageScanner;
+        if (compress) {
+            client.setChunkCallback([&compressor, &pageScanner](const char* data, std::size_t size) {
+                pageScanner.feed(data, size);
+                return compressor.write(data, size);
+            });
+        }
 
-        const std::string url = site["api"].get<std::string>() + "?ac=videolist&wd=" + encodedKeyword;
+        const std::string url = site["api"].get<std::string>() + query + (page > 1 ? "&pg=" + std::to_string(page) : "");
         const auto start = std::chrono::steady_clock::now();
         const std::string response = client.get(url);
         const auto end = std::chrono::steady_clock::now();
-        logInfo("站点 ", siteName, " 请求耗时: ", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(), "ms");
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+        result.latency = lastAttemptLatency(client, elapsed);
+        result.requestTimedOut = client.getLastErrorCode() == CURLE_OPERATION_TIMEDOUT;
+        result.throttled = client.wasThrottled();
+        result.transfer = client.getLastTransferSize();
+        logInfo("站点 ", siteName, " 请求耗时: ", elapsed.count(), "ms, 请求次数: ", client.getLastAttempts(),
+                ", 传输 ", result.transfer.wireBytes, " 字节 (编码: ",
+                result.transfer.contentEncoding.empty() ? "identity" : result.transfer.contentEncoding,
+                "), 解码后 ", result.transfer.bodyBytes, " 字节");
+
+        if (client.getLastErrorCode() == CURLE_ABORTED_BY_CALLBACK && options.cancelFlag && options.cancelFlag->load()) {
+            result.cancelled = true;
+            logInfo("搜索已取消，中止站点请求: ", siteName);
+            return result;
+        }
 
-        if (response.empty() || client.getLastStatusCode() != 200) {
+        const bool received = compress ? compressor.inputBytes() > 0 : !response.empty();
+        if (!received || client.getLastStatusCode() != 200) {
             logError("站点请求失败: ", siteName, ", error=", client.getLastError(), ", status=", client.getLastStatusCode(), ", url=", url);
             return result;
         }
 
+        if (!compress) {
+            pageScanner.feed(response.data(), response.size());
+        }
+        result.pageCount = pageScanner.pageCount();
         result.requestSucceeded = true;
-        logInfo("站点请求成功: ", siteName);
-        result.fileSaved = saveSearchResult(outputDir, domain, response);
+        logInfo("站点请求成功: ", siteName, ", 第 ", page, " 页, 共 ", result.pageCount, " 页");
+        const std::string filename = searchResultFileName(domain, page);
+        result.fileSaved = compress ? saveCompressedSearchResult(writer, outputDir, filename, compressor)
+                                    : saveSearchResult(writer, outputDir, filename, response);
+        if (result.fileSaved) {
+            result.savedFile = outputDir / (filename + (compress ? ".json.gz" : ".json"));
+        }
         return result;
     } catch (const std::exception& e) {
         if (result.siteName.empty()) {
@@ -310,11 +630,102 @@ SiteSearchResult searchSingleSite(
     }
 }
 
+DetailBatchResult fetchDetailBatch(const DetailBatch& batch, const SiteRequestOptions& options) {
+    DetailBatchResult result;
+    result.domain = batch.domain;
+    result.site = batch.site;
+    result.ids = batch.ids;
+
+    try {
+        HTTPSJsonClient client;
+        configureSearchClient(client, options);
+        client.setTraced(true);
+
+        std::string ids;
+        for (const int id : batch.ids) {
+            ids += (ids.empty() ? "" : ",") + std::to_string(id);
+        }
+
+        const std::string url = batch.api + "?ac=detail&ids=" + ids;
+        const auto start = std::chrono::steady_clock::now();
+        const std::string response = client.get(url);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        result.latency = lastAttemptLatency(client, elapsed);
+        result.requestTimedOut = client.getLastErrorCode() == CURLE_OPERATION_TIMEDOUT;
+        result.throttled = client.wasThrottled();
+        result.transfer = client.getLastTransferSize();
+
+        if (client.getLastErrorCode() == CURLE_ABORTED_BY_CALLBACK && options.cancelFlag && options.cancelFlag->load()) {
+            logInfo("详情预取已取消，中止请求: ", batch.domain);
+            return result;
+        }
+        if (response.empty() || client.getLastStatusCode() != 200) {
+            logError("详情请求失败: ", batch.domain, ", error=", client.getLastError(), ", status=", client.getLastStatusCode(), ", url=", url);
+            return result;
+        }
+
+        JsonParser parser;
+        if (!parser.parseFromString(response, batch.site)) {
+            return result;
+        }
+        result.videos = parser.getVideoListWithStats().videos;
+        result.response = response;
+        result.requestSucceeded = true;
+        logInfo("详情请求成功: ", batch.domain, ", 请求 ", batch.ids.size(), " 个, 返回 ", result.videos.size(),
+                " 个, 耗时 ", elapsed.count(), "ms, 传输 ", result.transfer.wireBytes, " 字节");
+    } catch (const std::exception& e) {
+        logError("详情请求异常: ", batch.domain, ", error=", e.what());
+    }
+    return result;
+}
+
+// 摘要条目的标题和展示站点名保持不变，其余字段取详情
+void applyDetail(VideoInfo& target, const VideoInfo& detail) {
+    if (!detail.vod_sub.empty()) {
+        target.vod_sub = detail.vod_sub;
+    }
+    if (!detail.vod_remarks.empty()) {
+        target.vod_remarks = detail.vod_remarks;
+    }
+    // ac=list 已带海报的站点，详情里缺少海报时保留原值
+    if (!detail.vod_pic.empty()) {
+        target.vod_pic = detail.vod_pic;
+    }
+    if (!detail.vod_content.empty()) {
+        target.vod_content = detail.vod_content;
+    }
+    target.play_urls = detail.play_urls;
+    target.detail_loaded = true;
+}
+
+bool hasSuffix(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() &&
+           value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// 缓存文件为 <站点>[.page<N>].json 或压缩后的 .json.gz
+bool isCacheFileName(const std::string& filename) {
+    return hasSuffix(filename, ".json") || hasSuffix(filename, ".json.gz");
+}
+
+// 合并过的详情保存为 <站点>.detail-<编号哈希>.json，与分页文件放在一起，加载目录时补回对应的摘要条目
+bool isDetailFileName(const std::string& filename) {
+    return filename.find(".detail-") != std::string::npos;
+}
+
+std::string detailFileName(const std::string& site, const std::vector<int>& ids) {
+    std::string key;
+    for (const int id : ids) {
+        key += std::to_string(id) + ",";
+    }
+    return site + ".detail-" + text::sha256Hex(key).substr(0, 16);
+}
+
 std::vector<std::filesystem::path> collectJsonFiles(const std::filesystem::path& outputPath) {
     std::vector<std::filesystem::path> jsonFiles;
 
     for (const auto& entry : std::filesystem::directory_iterator(outputPath)) {
-        if (entry.is_regular_file() && entry.path().extension() == ".json") {
+        if (entry.is_regular_file() && isCacheFileName(entry.path().filename().string())) {
             jsonFiles.push_back(entry.path());
         }
     }
@@ -344,7 +755,7 @@ std::map<std::string, std::string> buildSiteDisplayNames(const json& siteList) {
 bool loadVideosFromJsonFile(
     JsonParser& parser,
     const std::filesystem::path& filePath,
-    std::map<std::string, std::vector<VideoInfo>>& allVideos,
+    std::vector<VideoInfo>& videos,
     CatalogLoadStats& stats,
     const std::map<std::string, std::string>& siteDisplayNames) {
     try {
@@ -360,7 +771,7 @@ bool loadVideosFromJsonFile(
             if (displayNameIt != siteDisplayNames.end()) {
                 video.source = displayNameIt->second;
             }
-            allVideos[video.vod_name].push_back(video);
+            videos.push_back(std::move(video));
         }
 
         stats.parsedFiles++;
@@ -383,18 +794,62 @@ CatalogLoadStats collectVideoCatalog(
     const std::map<std::string, std::string>& siteDisplayNames) {
     CatalogLoadStats stats;
     JsonParser parser;
+    std::vector<VideoInfo> videos;
+    std::map<std::pair<std::string, int>, VideoInfo> details;
     for (const auto& filePath : jsonFiles) {
-        loadVideosFromJsonFile(parser, filePath, allVideos, stats, siteDisplayNames);
+        videos.clear();
+        if (isDetailFileName(filePath.filename().string())) {
+            CatalogLoadStats detailStats;
+            loadVideosFromJsonFile(parser, filePath, videos, detailStats, {});
+            stats.parsedFiles += detailStats.parsedFiles;
+            stats.skippedFiles += detailStats.skippedFiles;
+            for (auto& video : videos) {
+                details[{video.site, video.vod_id}] = std::move(video);
+            }
+            continue;
+        }
+        loadVideosFromJsonFile(parser, filePath, videos, stats, siteDisplayNames);
+        for (auto& video : videos) {
+            allVideos[video.vod_name].push_back(std::move(video));
+        }
     }
 
+    if (!details.empty()) {
+        for (auto& [title, entries] : allVideos) {
+            for (auto& video : entries) {
+                const auto it = video.detail_loaded ? details.end() : details.find({video.site, video.vod_id});
+                if (it != details.end()) {
+                    applyDetail(video, it->second);
+                    stats.restoredDetails++;
+                }
+            }
+        }
+    }
     return stats;
 }
 
-SiteSearchResult consumeCompletedSearchTask(std::deque<std::future<SiteSearchResult>>& tasks) {
-    SiteSearchResult siteResult = tasks.front().get();
-    tasks.pop_front();
+// 解析刚保存的搜索结果页，供搜索过程中按站点更新目录
+std::vector<VideoInfo> loadSearchResultFile(const std::filesystem::path& filePath, const std::string& siteKey, const std::string& siteName) {
+    JsonParser parser;
+    CatalogLoadStats stats;
+    std::vector<VideoInfo> videos;
+    loadVideosFromJsonFile(parser, filePath, videos, stats, {{siteKey, siteName}});
+    return videos;
+}
 
-    return siteResult;
+// 按完成顺序取出任意一个已完成的任务，先返回的站点可以尽早排入后续分页
+SiteSearchResult consumeCompletedSearchTask(std::deque<std::future<SiteSearchResult>>& tasks, TaskGroup& group) {
+    while (true) {
+        for (auto it = tasks.begin(); it != tasks.end(); ++it) {
+            if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                SiteSearchResult siteResult = it->get();
+                tasks.erase(it);
+                return siteResult;
+            }
+        }
+        // 只等待本次搜索自己的请求；工作线程都忙时顺带执行其中尚未开始的，不会执行其他任务
+        ThreadPool::instance().waitFor(tasks.front(), kSearchTaskPollInterval, &group);
+    }
 }
 
 bool createDirectory(const std::filesystem::path& dirPath, const std::string& errorPrefix) {
@@ -420,11 +875,41 @@ bool createBackupDirectory(const std::filesystem::path& outputPath, std::filesys
     return createDirectory(backupDir, "无法创建备份子目录: ");
 }
 
-int backupFiles(const std::vector<std::filesystem::path>& jsonFiles, const std::filesystem::path& backupDir) {
+// 压缩模式下，未压缩的缓存文件分块读入压缩器，再以 .json.gz 形式原子写入备份目录
+bool backupFileCompressed(AtomicFileWriter& writer, const std::filesystem::path& sourceFile, const std::filesystem::path& backupDir) {
+    std::ifstream in(sourceFile, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    GzipCompressor compressor;
+    std::vector<char> buffer(64 * 1024);
+    while (in) {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        const auto count = in.gcount();
+        if (count > 0 && !compressor.write(buffer.data(), static_cast<std::size_t>(count))) {
+            return false;
+        }
+    }
+    if (in.bad() || !compressor.finish()) {
+        return false;
+    }
+
+    return writer.write(backupDir / (sourceFile.filename().string() + ".gz"), compressor.output());
+}
+
+int backupFiles(AtomicFileWriter& writer, const std::vector<std::filesystem::path>& jsonFiles, const std::filesystem::path& backupDir, bool compress) {
     int copiedCount = 0;
 
     for (const auto& p : jsonFiles) {
         try {
+            if (compress && p.extension() == ".json") {
+                if (backupFileCompressed(writer, p, backupDir)) {
+                    copiedCount++;
+                    continue;
+                }
+                logError("压缩备份失败，改为直接复制: ", p.filename());
+            }
             std::filesystem::copy_file(p, backupDir / p.filename(), std::filesystem::copy_options::overwrite_existing);
             copiedCount++;
         } catch (const std::filesystem::filesystem_error& e) {
@@ -484,7 +969,169 @@ int deleteFiles(const std::vector<std::filesystem::path>& jsonFiles) {
     return deletedCount;
 }
 
-crow::response serveFrontFile(const std::string& path) {
+enum class RangeResult {
+    None,           // 没有 Range 头或格式不支持，返回完整内容
+    Satisfiable,
+    Unsatisfiable
+};
+
+// 解析单段 Range 头：bytes=first-last、bytes=first-、bytes=-suffix
+RangeResult parseByteRange(const std::string& header, std::uint64_t size, std::uint64_t& first, std::uint64_t& last) {
+    const std::string prefix = "bytes=";
+    if (header.compare(0, prefix.size(), prefix) != 0 || header.find(',') != std::string::npos) {
+        return RangeResult::None;
+    }
+
+    const std::string spec = trim(header.substr(prefix.size()));
+    const std::size_t dash = spec.find('-');
+    if (dash == std::string::npos) {
+        return RangeResult::None;
+    }
+
+    const std::string firstText = spec.substr(0, dash);
+    const std::string lastText = spec.substr(dash + 1);
+    const auto isNumber = [](const std::string& text) {
+        return !text.empty() && text.size() <= 18 && text.find_first_not_of("0123456789") == std::string::npos;
+    };
+
+    if (firstText.empty()) {
+        if (!isNumber(lastText)) {
+            return RangeResult::None;
+        }
+        const std::uint64_t suffix = std::stoull(lastText);
+        if (suffix == 0 || size == 0) {
+            return RangeResult::Unsatisfiable;
+        }
+        first = suffix >= size ? 0 : size - suffix;
+        last = size - 1;
+        return RangeResult::Satisfiable;
+    }
+
+    if (!isNumber(firstText) || (!lastText.empty() && !isNumber(lastText))) {
+        return RangeResult::None;
+    }
+    first = std::stoull(firstText);
+    last = lastText.empty() ? size - 1 : std::min<std::uint64_t>(std::stoull(lastText), size - 1);
+    if (first >= size || last < first) {
+        return RangeResult::Unsatisfiable;
+    }
+    return RangeResult::Satisfiable;
+}
+
+crow::response makeRangeNotSatisfiable(std::uint64_t size) {
+    crow::response res(416);
+    res.set_header("Content-Range", "bytes */" + std::to_string(size));
+    return res;
+}
+
+crow::response makePartialResponse(std::string body, std::uint64_t first, std::uint64_t last, std::uint64_t size, const std::string& contentType) {
+    crow::response res(206);
+    res.set_header("Content-Range", "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(size));
+    res.set_header("Accept-Ranges", "bytes");
+    if (!contentType.empty()) {
+        res.set_header("Content-Type", contentType);
+    }
+    res.body = std::move(body);
+    return res;
+}
+
+// 发送磁盘文件：完整请求交给 Crow 分块流式发送，不把整个文件读入内存；
+// Range 请求只读取对应片段，返回请求的完整区间。区间超过 kMaxRangeBytes 时忽略 Range，
+// 流式返回整个文件（RFC 7233 允许），不会截断响应。文件不存在时返回 404，调用方可以重新获取
+crow::response makeFileResponse(const crow::request& req, const std::filesystem::path& filePath, const std::string& contentType) {
+    std::error_code ec;
+    const std::uint64_t size = std::filesystem::file_size(filePath, ec);
+    if (ec) {
+        return crow::response(404, "File not found");
+    }
+
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+    switch (parseByteRange(req.get_header_value("Range"), size, first, last)) {
+    case RangeResult::Unsatisfiable:
+        return makeRangeNotSatisfiable(size);
+    case RangeResult::Satisfiable: {
+        if (last - first + 1 > kMaxRangeBytes) {
+            break;
+        }
+        std::ifstream file(filePath, std::ios::binary);
+        if (!file) {
+            return crow::response(404, "File not found");
+        }
+        std::string body(static_cast<std::size_t>(last - first + 1), '\0');
+        if (!file.seekg(static_cast<std::streamoff>(first)) || !file.read(&body[0], static_cast<std::streamsize>(body.size()))) {
+            return crow::response(500, "Error reading file");
+        }
+        return makePartialResponse(std::move(body), first, last, size, contentType);
+    }
+    case RangeResult::None:
+        break;
+    }
+
+    crow::response res;
+    res.set_static_file_info_unsafe(filePath.string(), contentType);
+    if (res.code != 200) {
+        return crow::response(404, "File not found");
+    }
+    res.set_header("Accept-Ranges", "bytes");
+    return res;
+}
+
+// 发送内存中的内容，同样支持 Range
+crow::response makeDataResponse(const crow::request& req, const std::string& data, const std::string& contentType) {
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+    switch (parseByteRange(req.get_header_value("Range"), data.size(), first, last)) {
+    case RangeResult::Unsatisfiable:
+        return makeRangeNotSatisfiable(data.size());
+    case RangeResult::Satisfiable:
+        return makePartialResponse(data.substr(first, last - first + 1), first, last, data.size(), contentType);
+    case RangeResult::None:
+        break;
+    }
+
+    crow::response res(200);
+    res.set_header("Content-Type", contentType);
+    res.set_header("Accept-Ranges", "bytes");
+    res.body = data;
+    return res;
+}
+
+// 海报缓存文件的响应：ETag 匹配时返回 304；文件在发送前被淘汰时返回 404，调用方可以重新获取。
+// 服务端缓存淘汰后同一地址可能下载到新内容，因此不标记 immutable，浏览器缓存一天后凭 ETag 重新验证
+crow::response makePosterResponse(const crow::request& req, const PosterFile& file) {
+    if (req.get_header_value("If-None-Match") == file.etag) {
+        crow::response res(304);
+        res.set_header("Cache-Control", kPosterCacheControl);
+        res.set_header("ETag", file.etag);
+        return res;
+    }
+
+    crow::response res = makeFileResponse(req, file.path, file.contentType);
+    if (res.code == 200 || res.code == 206) {
+        res.set_header("Cache-Control", kPosterCacheControl);
+        res.set_header("ETag", file.etag);
+    }
+    return res;
+}
+
+crow::response makePlaylistResponse(const std::string& body) {
+    crow::response res(200);
+    res.set_header("Content-Type", "application/vnd.apple.mpegurl");
+    res.set_header("Cache-Control", "no-cache");
+    res.write(body);
+    return res;
+}
+
+crow::response makeSegmentResponse(const crow::request& req, const SegmentCache::Data& data, const std::filesystem::path& file, const std::string& contentType) {
+    crow::response res = data ? makeDataResponse(req, *data, contentType) : makeFileResponse(req, file, contentType);
+    if (res.code == 200 || res.code == 206) {
+        res.set_header("Cache-Control", "public, max-age=86400");
+    }
+    return res;
+}
+
+crow::response serveFrontFile(const crow::request& req, const std::string& path) {
     const std::filesystem::path baseDir = "../front";
     if (!std::filesystem::exists(baseDir) || !std::filesystem::is_directory(baseDir)) {
         return crow::response(500, "Front directory not found");
@@ -503,81 +1150,644 @@ crow::response serveFrontFile(const std::string& path) {
             return crow::response(403, "Forbidden");
         }
 
-        std::string content;
-        if (!readFileContent(canonicalRequested, content)) {
-            return crow::response(500, "Error reading file");
-        }
-
-        crow::response res;
-        if (const char* contentType = contentTypeForPath(path)) {
-            res.set_header("Content-Type", contentType);
-        }
-        res.write(content);
-        return res;
+        // 未知扩展名由 Crow 按 MIME 表推断
+        const char* contentType = contentTypeForPath(path);
+        return makeFileResponse(req, canonicalRequested, contentType ? contentType : "");
     } catch (const std::filesystem::filesystem_error&) {
         return crow::response(404, "File not found");
     }
 }
 }
 
-const std::string WebServer::INPUT_PATH = "../input/";
-const std::string WebServer::OUTPUT_PATH = "../output/";
-
-bool WebServer::shouldSkipSite(const std::string& domain, int maxFailures) const {
-    std::lock_guard<std::mutex> lock(siteFailureCountsMutex);
-    const auto it = siteFailureCounts.find(domain);
-    return it != siteFailureCounts.end() && it->second >= maxFailures;
+WebServer::WebServer()
+    : videoList(catalog::kTitleMergeThreshold) {
+    siteBreaker = std::make_unique<CircuitBreaker>(std::filesystem::path(cachePath) / "circuit_breaker.json", CircuitBreaker::Config());
+    backgroundTasks = std::make_unique<TaskExecutor>(kDefaultBackgroundThreads, kBackgroundQueueLimit);
+    detailTasks = std::make_unique<TaskExecutor>(kDetailRequestThreads, kDetailRequestQueueLimit);
+    mediaTasks = std::make_unique<TaskExecutor>(kMediaRequestThreads, kMediaRequestQueueLimit);
 }
 
-int WebServer::recordSiteRequestResult(const std::string& domain, bool requestSucceeded) {
-    std::lock_guard<std::mutex> lock(siteFailureCountsMutex);
-
-    if (requestSucceeded) {
-        siteFailureCounts.erase(domain);
-        return 0;
+WebServer::~WebServer() {
+    // 先取消搜索并停止后台执行器，搜索完成时会更新目录并启动预取
+    searchJobs.cancelActive();
+    detailTasks->shutdown();
+    mediaTasks->shutdown();
+    backgroundTasks->shutdown();
+
+    // 取消后台预取，进行中的请求随之中止
+    std::lock_guard<std::mutex> lock(detailPrefetchMutex);
+    if (detailPrefetchCancel) {
+        detailPrefetchCancel->store(true);
     }
+    for (auto& prefetch : detailPrefetches) {
+        prefetch.wait();
+    }
+}
 
-    int& failureCount = siteFailureCounts[domain];
-    failureCount++;
-    return failureCount;
+void WebServer::setDataPaths(const std::string& inputDir, const std::string& outputDir, const std::string& cacheDir) {
+    inputPath = inputDir;
+    outputPath = outputDir;
+    cachePath = cacheDir;
+    siteBreaker = std::make_unique<CircuitBreaker>(std::filesystem::path(cachePath) / "circuit_breaker.json", CircuitBreaker::Config());
 }
 
 void WebServer::run(int port) {
+    hlsProxy = std::make_unique<HlsProxy>(std::filesystem::path(cachePath) / "hls", hlsMemoryCacheBytes, hlsDiskCacheBytes);
+    hlsProxy->setPrefetchDepth(hlsPrefetchSegments, hlsNextEpisodeSegments);
+    posterCache = std::make_unique<PosterCache>(std::filesystem::path(cachePath) / "img", posterDiskCacheBytes);
     setupRoutes();
     logInfo("Web服务器启动在端口: ", port);
     logInfo("访问 http://localhost:", port, " 查看视频列表");
-    app.port(port).multithreaded().run();
+    logInfo("HTTP 工作线程: ", httpThreads > 0 ? std::to_string(httpThreads) : std::string("自动"));
+    if (httpThreads > 0) {
+        app.port(port).concurrency(static_cast<std::uint16_t>(httpThreads)).run();
+    } else {
+        app.port(port).multithreaded().run();
+    }
 }
 
-void WebServer::setVideoList(const std::map<std::string, std::vector<VideoInfo>>& data) {
-    std::lock_guard<std::mutex> lock(videoListMutex);
-    videoList = data;
+void WebServer::setFileSyncMode(AtomicFileWriter::SyncMode mode) {
+    fileWriter.setSyncMode(mode);
 }
 
-std::map<std::string, std::vector<VideoInfo>> WebServer::getVideoList() {
-    std::map<std::string, std::vector<VideoInfo>> allVideos;
-    const std::filesystem::path outputPath(OUTPUT_PATH);
+void WebServer::setHlsCacheBudget(std::size_t memoryBytes, std::size_t diskBytes) {
+    hlsMemoryCacheBytes = memoryBytes;
+    hlsDiskCacheBytes = diskBytes;
+}
 
-    try {
-        if (!std::filesystem::exists(outputPath)) {
-            logError("输出目录不存在: ", outputPath);
-            return allVideos;
-        }
+void WebServer::setPosterCacheBudget(std::size_t diskBytes) {
+    posterDiskCacheBytes = diskBytes;
+}
 
-        const std::vector<std::filesystem::path> jsonFiles = collectJsonFiles(outputPath);
-        std::map<std::string, std::string> siteDisplayNames;
-        const std::string sourceFile = INPUT_PATH + "source.json";
-        const json sourceConfig = readSiteConfig(sourceFile);
-        if (!sourceConfig.empty()) {
-            siteDisplayNames = buildSiteDisplayNames(loadApiSites(sourceConfig, sourceFile));
-        }
+void WebServer::setHlsPrefetchDepth(std::size_t segmentsAhead, std::size_t nextEpisodeSegments) {
+    hlsPrefetchSegments = segmentsAhead;
+    hlsNextEpisodeSegments = nextEpisodeSegments;
+}
 
-        const CatalogLoadStats stats = collectVideoCatalog(jsonFiles, allVideos, siteDisplayNames);
-        logInfo("目录解析完成: 文件总数=", jsonFiles.size(),
-                ", 成功文件=", stats.parsedFiles,
-                ", 跳过文件=", stats.skippedFiles,
+void WebServer::setSearchConcurrency(std::size_t maxConcurrency, std::size_t perHostConcurrency) {
+    ConcurrencyLimiter::Config config = searchLimiter.getConfig();
+    config.maxLimit = maxConcurrency;
+    config.perHostLimit = perHostConcurrency;
+    searchLimiter.setConfig(config);
+}
+
+void WebServer::setProviderRateLimit(double requestsPerSecond, double burst) {
+    TokenBucketLimiter::Config config;
+    config.ratePerSecond = requestsPerSecond;
+    config.burst = burst;
+    providerRateLimiter.setConfig(config);
+}
+
+void WebServer::setSearchRetryAttempts(int attempts) {
+    searchRetryAttempts = std::max(1, attempts);
+}
+
+void WebServer::setCacheCompression(bool enabled) {
+    cacheCompression = enabled;
+}
+
+void WebServer::setSearchPageBudget(std::size_t pages) {
+    searchPageBudget = std::max<std::size_t>(1, pages);
+}
+
+void WebServer::setTwoPhaseSearch(bool enabled) {
+    twoPhaseSearch = enabled;
+}
+
+void WebServer::setDetailPrefetchTitles(std::size_t titles) {
+    detailPrefetchTitles = titles;
+}
+
+void WebServer::setHttpThreads(std::size_t threads) {
+    httpThreads = threads;
+}
+
+void WebServer::setBackgroundThreads(std::size_t threads, std::size_t queueLimit) {
+    // 执行器只在构造时创建一次，这里只调整上限，已提交的任务不受影响
+    backgroundTasks->setMaxRunning(threads);
+    searchQueueLimit = std::max<std::size_t>(1, queueLimit);
+}
+
+void WebServer::setVideoList(const std::map<std::string, std::vector<VideoInfo>>& data) {
+    // 索引在锁外构建，再与目录在同一临界区内发布，查询方不会看到新目录配旧索引
+    auto index = std::make_shared<CatalogSearchIndex>();
+    index->build(data);
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        videoList.reset(data);
+        searchIndex = std::move(index);
+        rebuildCatalogUrls();
+        videoListVersion++;
+    }
+    scheduleCatalogRefresh();
+
+    // 后台探测各视频源第一集的可用性，已有结果的地址不会重复探测
+    std::vector<std::string> probeUrls;
+    for (const auto& [title, videos] : data) {
+        for (const auto& video : videos) {
+            probeUrls.push_back(firstEpisodeUrl(video));
+        }
+    }
+    healthProber.probe(probeUrls);
+
+    publishCatalog(data);
+}
+
+void WebServer::publishSearchResults(std::map<std::string, std::vector<VideoInfo>> partitions) {
+    std::vector<std::string> probeUrls;
+    std::size_t entries = 0;
+    for (const auto& [site, videos] : partitions) {
+        entries += videos.size();
+        for (const auto& video : videos) {
+            probeUrls.push_back(firstEpisodeUrl(video));
+        }
+    }
+
+    // 全部站点的分区一起替换，读取方不会看到新旧结果混合的目录
+    std::set<std::string> changed;
+    std::map<std::string, std::vector<VideoInfo>> changedEntries;
+    std::shared_ptr<const CatalogSearchIndex> previousIndex;
+    std::uint64_t version = 0;
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        changed = videoList.replacePartitions(std::move(partitions));
+        rebuildCatalogUrls();
+        version = ++videoListVersion;
+        for (const auto& title : changed) {
+            const auto it = videoList.titles().find(title);
+            if (it != videoList.titles().end()) {
+                changedEntries.emplace(title, it->second);
+            }
+        }
+        previousIndex = searchIndex;
+    }
+    logInfo("搜索结果已发布到目录: 条目 ", entries, ", 变化标题 ", changed.size(), ", 版本 ", version);
+
+    healthProber.probe(probeUrls);
+    updateSearchIndex(previousIndex, version, changed, changedEntries);
+    publishCatalog(changedEntries);
+}
+
+
+void WebServer::addCatalogUrls(const VideoInfo& video) {
+    for (const auto& [group, episodes] : video.play_urls) {
+        for (const auto& episode : episodes) {
+            catalogPlayUrls.insert(episode.second);
+        }
+    }
+    if (!video.vod_pic.empty()) {
+        catalogPosterUrls.insert(video.vod_pic);
+    }
+}
+
+void WebServer::rebuildCatalogUrls() {
+    catalogPlayUrls.clear();
+    catalogPosterUrls.clear();
+    for (const auto& [title, videos] : videoList.titles()) {
+        for (const auto& video : videos) {
+            addCatalogUrls(video);
+        }
+    }
+}
+
+bool WebServer::isProxyAllowed(const std::string& url, const char* signature) const {
+    if (!HlsProxy::isProxyableUrl(url)) {
+        return false;
+    }
+    if (signature && hlsProxy->isSignedUrl(url, signature)) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(videoListMutex);
+    return catalogPlayUrls.count(url) > 0;
+}
+
+bool WebServer::isCatalogPoster(const std::string& url) const {
+    if (!HlsProxy::isProxyableUrl(url)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(videoListMutex);
+    return catalogPosterUrls.count(url) > 0;
+}
+
+void WebServer::publishCatalog(const std::map<std::string, std::vector<VideoInfo>>& data) {
+    // 联想前缀树只做增量更新，已有标题仅在视频源变多时提升权重
+    for (const auto& [title, videos] : data) {
+        suggestions.raise(title, static_cast<double>(videos.size()));
+    }
+
+    startDetailPrefetch(data);
+}
+
+void WebServer::rebuildSearchIndex() {
+    // 按快照在锁外构建，目录版本未变时才发布；构建期间目录又变化则按新快照重来，
+    // 多次都追不上时在锁内构建，保证发布的索引总是对应当前目录
+    for (std::size_t attempt = 0; attempt < kIndexBuildAttempts; ++attempt) {
+        std::map<std::string, std::vector<VideoInfo>> snapshot;
+        std::uint64_t version = 0;
+        {
+            std::lock_guard<std::mutex> lock(videoListMutex);
+            snapshot = videoList.titles();
+            version = videoListVersion;
+        }
+
+        auto index = std::make_shared<CatalogSearchIndex>();
+        index->build(snapshot);
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        if (videoListVersion == version) {
+            searchIndex = std::move(index);
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(videoListMutex);
+    auto index = std::make_shared<CatalogSearchIndex>();
+    index->build(videoList.titles());
+    searchIndex = std::move(index);
+}
+
+void WebServer::updateSearchIndex(const std::shared_ptr<const CatalogSearchIndex>& previous, std::uint64_t version,
+                                  const std::set<std::string>& changed,
+                                  const std::map<std::string, std::vector<VideoInfo>>& entries) {
+    if (!previous) {
+        rebuildSearchIndex();
+        return;
+    }
+
+    // 复制上一份索引，只重新切分变化的标题；期间目录又变化时退回完整重建
+    auto index = std::make_shared<CatalogSearchIndex>(*previous);
+    index->update(changed, entries);
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        if (videoListVersion == version && searchIndex == previous) {
+            searchIndex = std::move(index);
+            return;
+        }
+    }
+    rebuildSearchIndex();
+}
+
+std::map<std::string, WebServer::ProviderTransferStats> WebServer::getTransferStats() const {
+    std::lock_guard<std::mutex> lock(transferStatsMutex);
+    return transferStats;
+}
+
+void WebServer::recordProviderTransfer(const std::string& domain, const HTTPSJsonClient::TransferSize& transfer) {
+    std::lock_guard<std::mutex> lock(transferStatsMutex);
+    ProviderTransferStats& stats = transferStats[domain];
+    stats.responses++;
+    if (!transfer.contentEncoding.empty()) {
+        stats.compressedResponses++;
+    }
+    stats.wireBytes += transfer.wireBytes;
+    stats.bodyBytes += transfer.bodyBytes;
+    stats.lastEncoding = transfer.contentEncoding;
+}
+
+// 视频源多的标题更可能被打开，后台先补全这些标题的详情，完成后重建索引以纳入简介
+void WebServer::startDetailPrefetch(const std::map<std::string, std::vector<VideoInfo>>& data) {
+    std::vector<std::map<std::string, std::vector<VideoInfo>>::const_iterator> titles;
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        titles.push_back(it);
+    }
+    std::stable_sort(titles.begin(), titles.end(), [](const auto& a, const auto& b) {
+        return a->second.size() > b->second.size();
+    });
+    if (titles.size() > detailPrefetchTitles) {
+        titles.resize(detailPrefetchTitles);
+    }
+
+    std::vector<std::pair<std::string, int>> refs;
+    for (const auto& it : titles) {
+        for (const auto& video : it->second) {
+            if (!video.detail_loaded && !video.site.empty()) {
+                refs.emplace_back(video.site, video.vod_id);
+            }
+        }
+    }
+
+    // 目录已变化，取消旧的预取（进行中的请求随之中止），不等待它结束
+    std::lock_guard<std::mutex> lock(detailPrefetchMutex);
+    if (detailPrefetchCancel) {
+        detailPrefetchCancel->store(true);
+    }
+    detailPrefetches.erase(std::remove_if(detailPrefetches.begin(), detailPrefetches.end(), [](const std::future<void>& prefetch) {
+        return prefetch.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }), detailPrefetches.end());
+    if (refs.empty()) {
+        detailPrefetchCancel.reset();
+        return;
+    }
+
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    detailPrefetchCancel = cancelled;
+    detailPrefetches.push_back(ThreadPool::instance().submit(ThreadPool::Priority::Low, [this, refs, cancelled]() {
+        const std::size_t loaded = fetchDetails(refs, kDetailDeadline, cancelled.get());
+        if (loaded > 0 && !cancelled->load()) {
+            rebuildSearchIndex();
+        }
+        logInfo("后台详情预取", cancelled->load() ? "已取消" : "完成", ": 请求 ", refs.size(), " 个条目, 补全 ", loaded, " 个");
+    }));
+}
+
+std::size_t WebServer::fetchDetails(const std::vector<std::pair<std::string, int>>& refs,
+                                    std::chrono::steady_clock::duration timeLimit,
+                                    const std::atomic<bool>* cancelled) {
+    const std::string sourceFile = inputPath + "source.json";
+    const json source = readSiteConfig(sourceFile);
+    if (source.empty()) {
+        return 0;
+    }
+    const json siteList = loadApiSites(source, sourceFile);
+    if (!siteList.is_object()) {
+        return 0;
+    }
+
+    std::map<std::string, std::string> siteDomains;
+    for (const auto& [domain, site] : siteList.items()) {
+        siteDomains[normalizeSiteFileKey(domain)] = domain;
+    }
+
+    std::map<std::string, std::vector<int>> idsBySite;
+    for (const auto& [site, id] : refs) {
+        std::vector<int>& ids = idsBySite[site];
+        if (std::find(ids.begin(), ids.end(), id) == ids.end()) {
+            ids.push_back(id);
+        }
+    }
+
+    std::vector<DetailBatch> pending;
+    for (const auto& [siteKey, ids] : idsBySite) {
+        const auto domainIt = siteDomains.find(siteKey);
+        if (domainIt == siteDomains.end()) {
+            logError("站点不在当前配置中，无法补全详情: ", siteKey);
+            continue;
+        }
+        const json& site = siteList[domainIt->second];
+        if (!site.contains("api") || !site["api"].is_string()) {
+            continue;
+        }
+
+        const std::string api = site["api"].get<std::string>();
+        for (std::size_t offset = 0; offset < ids.size(); offset += kDetailBatchSize) {
+            DetailBatch batch{siteKey, domainIt->second, api, HTTPSJsonClient::hostOf(api), {}};
+            batch.ids.assign(ids.begin() + static_cast<std::ptrdiff_t>(offset),
+                             ids.begin() + static_cast<std::ptrdiff_t>(std::min(ids.size(), offset + kDetailBatchSize)));
+            pending.push_back(std::move(batch));
+        }
+    }
+
+    SiteRequestOptions requestOptions;
+    requestOptions.rateLimiter = &providerRateLimiter;
+    requestOptions.retryPolicy.maxAttempts = searchRetryAttempts;
+    requestOptions.deadline = std::chrono::steady_clock::now() + timeLimit;
+    requestOptions.cancelFlag = cancelled;
+
+    // 与搜索共用自适应并发限制和单主机名额；等待名额同样受截止时间约束，并能响应取消
+    std::deque<std::future<DetailBatchResult>> tasks;
+    TaskGroup group;
+    while (!pending.empty()) {
+        if (cancelled && cancelled->load()) {
+            logInfo("详情补全已取消，放弃剩余 ", pending.size(), " 批");
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= requestOptions.deadline) {
+            logInfo("详情补全超出时限，放弃剩余 ", pending.size(), " 批");
+            break;
+        }
+
+        std::vector<std::string> hosts;
+        hosts.reserve(pending.size());
+        for (const auto& candidate : pending) {
+            hosts.push_back(candidate.host);
+        }
+
+        std::size_t index = 0;
+        if (!searchLimiter.tryAcquireAny(hosts, index, kSearchTaskPollInterval)) {
+            continue;
+        }
+        DetailBatch next = std::move(pending[index]);
+        pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(index));
+
+        tasks.push_back(ThreadPool::instance().submit(ThreadPool::Priority::High, [this, next, requestOptions]() {
+            LimiterSlot slot(searchLimiter, next.host);
+            SiteRequestOptions options = requestOptions;
+            options.slot = &slot;
+            DetailBatchResult result = fetchDetailBatch(next, options);
+            slot.release(result.latency, limiterOutcome(result.requestSucceeded, result.requestTimedOut, result.throttled));
+            return result;
+        }, &group));
+    }
+
+    std::size_t loaded = 0;
+    while (!tasks.empty()) {
+        DetailBatchResult result = ThreadPool::instance().get(tasks.front(), &group);
+        tasks.pop_front();
+        if (!result.requestSucceeded) {
+            continue;
+        }
+        recordProviderTransfer(result.domain, result.transfer);
+        const std::size_t merged = mergeDetails(result.videos);
+        loaded += merged;
+        if (merged > 0) {
+            saveDetailResult(result.site, result.ids, result.response);
+        }
+    }
+    return loaded;
+}
+
+// 详情与分页文件放在同一目录，重启后加载目录时补回，不必重新请求；新的搜索清空 output 时一并删除
+void WebServer::saveDetailResult(const std::string& site, const std::vector<int>& ids, const std::string& response) {
+    const std::filesystem::path outputDir(outputPath);
+    const std::string filename = detailFileName(site, ids);
+    std::filesystem::path target = outputDir / (filename + ".json");
+    bool saved = false;
+    if (cacheCompression) {
+        GzipCompressor compressor;
+        saved = compressor.write(response.data(), response.size()) &&
+                saveCompressedSearchResult(fileWriter, outputDir, filename, compressor);
+        target = outputDir / (filename + ".json.gz");
+    } else {
+        saved = saveSearchResult(fileWriter, outputDir, filename, response);
+    }
+    if (saved) {
+        fileWriter.flushFile(target);
+    }
+}
+
+std::size_t WebServer::mergeDetails(const std::vector<VideoInfo>& details) {
+    std::map<std::pair<std::string, int>, const VideoInfo*> byKey;
+    for (const auto& detail : details) {
+        byKey[{detail.site, detail.vod_id}] = &detail;
+    }
+
+    std::size_t merged = 0;
+    std::vector<std::string> probeUrls;
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        for (auto& [title, videos] : videoList.titles()) {
+            for (auto& video : videos) {
+                if (video.detail_loaded) {
+                    continue;
+                }
+                const auto it = byKey.find({video.site, video.vod_id});
+                if (it != byKey.end()) {
+                    applyDetail(video, *it->second);
+                    addCatalogUrls(video);
+                    probeUrls.push_back(firstEpisodeUrl(video));
+                    merged++;
+                }
+            }
+        }
+        if (merged > 0) {
+            videoListVersion++;
+        }
+    }
+
+    healthProber.probe(probeUrls);
+    if (merged > 0) {
+        scheduleCatalogRefresh();
+    }
+    return merged;
+}
+
+std::shared_ptr<const WebServer::CatalogBody> WebServer::buildCatalogBody() {
+    auto body = std::make_shared<CatalogBody>();
+    std::map<std::string, std::vector<VideoInfo>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        snapshot = videoList.titles();
+        body->catalogVersion = videoListVersion;
+    }
+    // 先取版本再排序，排序期间的新探测结果会在下一次刷新时体现
+    body->healthVersion = healthProber.version();
+    rankSourcesByHealth(snapshot, healthProber);
+    body->json = catalog::toCatalogJson(snapshot).dump();
+    body->builtAt = std::chrono::steady_clock::now();
+    return body;
+}
+
+std::shared_ptr<const WebServer::CatalogBody> WebServer::currentCatalogBody() {
+    std::uint64_t version = 0;
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        version = videoListVersion;
+    }
+    std::shared_ptr<const CatalogBody> body;
+    {
+        std::lock_guard<std::mutex> lock(catalogBodyMutex);
+        body = catalogBody;
+    }
+    if (body) {
+        // 目录已变化时先返回上一份内容，在后台重建；搜索任务在标记完成前已刷新过
+        if (body->catalogVersion < version) {
+            scheduleCatalogRefresh();
+        }
+        return body;
+    }
+
+    // 还没有生成过时在当前请求中构建，并发的请求等待同一次构建
+    std::lock_guard<std::mutex> buildLock(catalogBuildMutex);
+    {
+        std::lock_guard<std::mutex> lock(catalogBodyMutex);
+        if (catalogBody) {
+            return catalogBody;
+        }
+    }
+    body = buildCatalogBody();
+    std::lock_guard<std::mutex> lock(catalogBodyMutex);
+    catalogBody = body;
+    return body;
+}
+
+void WebServer::refreshCatalogBody() {
+    std::lock_guard<std::mutex> buildLock(catalogBuildMutex);
+    // 构建串行执行，后完成的一定不旧于当前内容
+    std::shared_ptr<const CatalogBody> body = buildCatalogBody();
+    std::lock_guard<std::mutex> lock(catalogBodyMutex);
+    catalogBody = std::move(body);
+}
+
+void WebServer::scheduleCatalogRefresh() {
+    // 同一时间只排一次刷新，执行时读取最新目录，合并了期间的多次变化；已在排队时直接忽略
+    const bool submitted = backgroundTasks->submit("catalog-json", [this]() {
+        refreshCatalogBody();
+    });
+    if (!submitted && !backgroundTasks->contains("catalog-json")) {
+        catalogRefreshDropped++;
+        logError("后台队列已满，目录 JSON 刷新被丢弃，/api/videos 暂时返回旧内容");
+    }
+}
+
+bool WebServer::loadTitleDetails(const std::string& title, std::vector<VideoInfo>& videos) {
+    std::vector<std::pair<std::string, int>> refs;
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        const auto it = videoList.titles().find(title);
+        if (it == videoList.titles().end()) {
+            return false;
+        }
+        for (const auto& video : it->second) {
+            if (!video.detail_loaded && !video.site.empty()) {
+                refs.emplace_back(video.site, video.vod_id);
+            }
+        }
+    }
+
+    if (!refs.empty()) {
+        const std::size_t loaded = fetchDetails(refs, kDetailOpenDeadline, nullptr);
+        logInfo("打开标题时补全详情: ", title, ", 请求 ", refs.size(), " 个, 补全 ", loaded, " 个");
+    }
+
+    std::lock_guard<std::mutex> lock(videoListMutex);
+    const auto it = videoList.titles().find(title);
+    if (it == videoList.titles().end()) {
+        return false;
+    }
+    videos = it->second;
+    return true;
+}
+
+std::vector<LocalSearchHit> WebServer::localSearch(const std::string& query, std::size_t limit) const {
+    std::shared_ptr<const CatalogSearchIndex> index;
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        index = searchIndex;
+    }
+
+    if (!index) {
+        return {};
+    }
+    return index->search(query, limit);
+}
+
+std::map<std::string, std::vector<VideoInfo>> WebServer::getVideoList() {
+    std::map<std::string, std::vector<VideoInfo>> allVideos;
+    const std::filesystem::path outputDir(outputPath);
+
+    try {
+        if (!std::filesystem::exists(outputDir)) {
+            logError("输出目录不存在: ", outputDir);
+            return allVideos;
+        }
+
+        const std::vector<std::filesystem::path> jsonFiles = collectJsonFiles(outputDir);
+        std::map<std::string, std::string> siteDisplayNames;
+        const std::string sourceFile = inputPath + "source.json";
+        const json sourceConfig = readSiteConfig(sourceFile);
+        if (!sourceConfig.empty()) {
+            siteDisplayNames = buildSiteDisplayNames(loadApiSites(sourceConfig, sourceFile));
+        }
+
+        const CatalogLoadStats stats = collectVideoCatalog(jsonFiles, allVideos, siteDisplayNames);
+        const std::size_t rawTitleCount = allVideos.size();
+        const std::size_t mergedTitles = catalog::mergeEquivalentTitles(allVideos, catalog::kTitleMergeThreshold);
+        logInfo("标题归并完成: 原始标题=", rawTitleCount, ", 合并后=", allVideos.size(), ", 合并=", mergedTitles);
+        logInfo("目录解析完成: 文件总数=", jsonFiles.size(),
+                ", 成功文件=", stats.parsedFiles,
+                ", 跳过文件=", stats.skippedFiles,
                 ", 成功视频=", stats.loadedVideos,
-                ", 跳过条目=", stats.skippedVideos);
+                ", 跳过条目=", stats.skippedVideos,
+                ", 补回详情=", stats.restoredDetails);
     } catch (const std::filesystem::filesystem_error& e) {
         logError("文件系统错误: ", e.what());
     } catch (const std::exception& e) {
@@ -588,11 +1798,27 @@ std::map<std::string, std::vector<VideoInfo>> WebServer::getVideoList() {
 }
 
 // 在 setupRoutes 方法中添加搜索端点
+void WebServer::respondAsync(const crow::request& req, crow::response& res,
+                             std::function<crow::response(const crow::request&)> produce) {
+    // Range、If-None-Match 等请求头在任务中仍然需要，复制一份请求
+    auto request = std::make_shared<const crow::request>(req);
+    crow::asio::io_context* io = req.io_context;
+    const std::string key = "media-" + std::to_string(mediaRequestSeq++);
+    const bool submitted = mediaTasks->submit(key, [request, io, &res, produce = std::move(produce)]() {
+        finishAsyncResponse(io, res, produce(*request));
+    });
+    if (!submitted) {
+        res = crow::response(429, "Proxy queue is full, retry later");
+        res.set_header("Retry-After", std::to_string(kSearchRetryAfterSeconds));
+        res.end();
+    }
+}
+
 void WebServer::setupRoutes() {
     // 静态文件服务 - 提供前端页面
     CROW_ROUTE(app, "/front/<path>")
-    ([](const crow::request&, std::string path) {
-        return serveFrontFile(path);
+    ([](const crow::request& req, std::string path) {
+        return serveFrontFile(req, path);
     });
 
     // 首页路由 - 重定向到前端页面
@@ -606,42 +1832,456 @@ void WebServer::setupRoutes() {
     // JSON API路由 - 返回视频数据的JSON格式
     CROW_ROUTE(app, "/api/videos")
     ([this]() {
-        std::map<std::string, std::vector<VideoInfo>> snapshot;
-        {
-            std::lock_guard<std::mutex> lock(videoListMutex);
-            snapshot = videoList;
+        // 返回预先序列化好的目录；只有探测结果变化时先返回旧内容，同时在后台按新的健康度重排
+        const std::shared_ptr<const CatalogBody> body = currentCatalogBody();
+        if (body->healthVersion != healthProber.version() &&
+            std::chrono::steady_clock::now() - body->builtAt >= kCatalogHealthRefreshInterval) {
+            scheduleCatalogRefresh();
+        }
+
+        crow::response res(200, body->json);
+        res.set_header("Content-Type", "application/json");
+        res.set_header("X-Catalog-Version", std::to_string(body->catalogVersion));
+        return res;
+    });
+
+    // 两阶段搜索的第二阶段：打开标题时补全各视频源的播放地址和简介
+    // 异步处理：请求在详情执行器上完成后回到连接的 io 线程 end()，等待上游期间不占用 HTTP 工作线程
+    CROW_ROUTE(app, "/api/detail")
+    ([this](const crow::request& req, crow::response& res) {
+        const char* titleParam = req.url_params.get("title");
+        const std::string title = titleParam ? titleParam : "";
+        if (title.empty()) {
+            res = makeJsonResponse(400, false, "Missing title parameter");
+            res.end();
+            return;
+        }
+
+        const std::string key = "detail-" + std::to_string(detailRequestSeq++);
+        crow::asio::io_context* io = req.io_context;
+        const bool submitted = detailTasks->submit(key, [this, title, io, &res]() {
+            std::map<std::string, std::vector<VideoInfo>> entry;
+            if (!loadTitleDetails(title, entry[title])) {
+                finishAsyncResponse(io, res, makeJsonResponse(404, false, "Title not found"));
+                return;
+            }
+            rankSourcesByHealth(entry, healthProber);
+
+            crow::json::wvalue body;
+            body["ok"] = true;
+            body["title"] = title;
+            body["videos"] = crow::json::wvalue::list();
+            int videoIndex = 0;
+            for (const auto& video : entry[title]) {
+                body["videos"][videoIndex++] = catalog::toVideoJson(video);
+            }
+            finishAsyncResponse(io, res, crow::response(200, body));
+        });
+        if (!submitted) {
+            res = makeJsonResponse(429, false, "Detail queue is full, retry later");
+            res.set_header("Retry-After", std::to_string(kSearchRetryAfterSeconds));
+            res.end();
+        }
+    });
+
+    // HLS 播放列表代理：改写后的列表中分片地址都指向本服务。
+    // 缓存命中时直接返回，未命中时在媒体执行器上获取，不占用 HTTP 工作线程
+    CROW_ROUTE(app, "/proxy/hls")
+    ([this](const crow::request& req, crow::response& res) {
+        const char* url = req.url_params.get("url");
+        if (!url || !HlsProxy::isProxyableUrl(url)) {
+            res = crow::response(400, "Invalid url parameter");
+            res.end();
+            return;
+        }
+        if (!isProxyAllowed(url, req.url_params.get("sig"))) {
+            res = crow::response(403, "Url is not a catalog play url or a signed playlist url");
+            res.end();
+            return;
+        }
+
+        std::string body;
+        if (hlsProxy->lookupPlaylist(url, body)) {
+            res = makePlaylistResponse(body);
+            res.end();
+            return;
+        }
+
+        const std::string playlistUrl = url;
+        respondAsync(req, res, [this, playlistUrl](const crow::request&) {
+            std::string body;
+            if (!hlsProxy->fetchPlaylist(playlistUrl, body)) {
+                return crow::response(502, "Failed to fetch playlist");
+            }
+            return makePlaylistResponse(body);
+        });
+    });
+
+    // HLS 分片代理：分片在所有观看者之间共享缓存。
+    // 内存或磁盘缓存命中时直接发送，未命中时在媒体执行器上下载
+    CROW_ROUTE(app, "/proxy/hls/segment")
+    ([this](const crow::request& req, crow::response& res) {
+        const char* url = req.url_params.get("url");
+        if (!url || !HlsProxy::isProxyableUrl(url)) {
+            res = crow::response(400, "Invalid url parameter");
+            res.end();
+            return;
+        }
+        if (!isProxyAllowed(url, req.url_params.get("sig"))) {
+            res = crow::response(403, "Url is not a signed segment url");
+            res.end();
+            return;
+        }
+
+        const std::string segmentUrl = url;
+        const std::string contentType = HlsProxy::contentTypeForSegment(segmentUrl);
+        SegmentCache::Data data;
+        std::filesystem::path file;
+        if (hlsProxy->lookupSegment(segmentUrl, data, file)) {
+            crow::response hit = makeSegmentResponse(req, data, file, contentType);
+            // 磁盘文件在查询之后、发送之前被淘汰时，转为异步重新获取
+            if (data || hit.code != 404) {
+                res = std::move(hit);
+                res.end();
+                return;
+            }
+        }
+
+        respondAsync(req, res, [this, segmentUrl, contentType](const crow::request& request) {
+            SegmentCache::Data data;
+            std::filesystem::path file;
+            if (!hlsProxy->openSegment(segmentUrl, data, file)) {
+                return crow::response(502, "Failed to fetch segment");
+            }
+            crow::response res = makeSegmentResponse(request, data, file, contentType);
+            if (!data && res.code == 404) {
+                file.clear();
+                if (!hlsProxy->fetchSegment(segmentUrl, data)) {
+                    return crow::response(502, "Failed to fetch segment");
+                }
+                res = makeSegmentResponse(request, data, file, contentType);
+            }
+            return res;
+        });
+    });
+
+    // 预取下一集的播放列表和开头分片，立即返回
+    CROW_ROUTE(app, "/proxy/hls/prefetch")
+    .methods("POST"_method)
+    ([this](const crow::request& req) {
+        const auto x = crow::json::load(req.body);
+        if (!x || !x.has("url") || !HlsProxy::isProxyableUrl(x["url"].s())) {
+            return makeJsonResponse(400, false, "Invalid url parameter");
+        }
+        // 只预取目录中的播放地址
+        if (!isProxyAllowed(x["url"].s(), nullptr)) {
+            return makeJsonResponse(403, false, "Url is not a catalog play url");
+        }
+
+        if (!hlsProxy->prefetchPlaylist(x["url"].s())) {
+            return makeJsonResponse(202, true, "Prefetch already queued or queue is full");
+        }
+        return makeJsonResponse(202, true, "Prefetch scheduled");
+    });
+
+    // 海报图片代理：缓存原图和缩略图，命中时直接发送文件；未命中时在媒体执行器上下载和缩放
+    CROW_ROUTE(app, "/img")
+    ([this](const crow::request& req, crow::response& res) {
+        const char* src = req.url_params.get("src");
+        if (!src || !HlsProxy::isProxyableUrl(src)) {
+            res = crow::response(400, "Invalid src parameter");
+            res.end();
+            return;
+        }
+        if (!isCatalogPoster(src)) {
+            res = crow::response(403, "Src is not a catalog poster url");
+            res.end();
+            return;
+        }
+
+        int width = kDefaultPosterWidth;
+        if (const char* widthParam = req.url_params.get("w")) {
+            try {
+                width = std::stoi(widthParam);
+            } catch (const std::exception&) {
+                res = crow::response(400, "Invalid w parameter");
+                res.end();
+                return;
+            }
+        }
+        width = PosterCache::normalizeWidth(width);
+
+        PosterFile file;
+        if (posterCache->find(src, width, file)) {
+            crow::response hit = makePosterResponse(req, file);
+            if (hit.code != 404) {
+                res = std::move(hit);
+                res.end();
+                return;
+            }
+        }
+
+        const std::string posterUrl = src;
+        respondAsync(req, res, [this, posterUrl, width](const crow::request& request) {
+            PosterFile file;
+            if (!posterCache->get(posterUrl, width, file)) {
+                return crow::response(502, "Failed to fetch image");
+            }
+            crow::response res = makePosterResponse(request, file);
+            if (res.code == 404) {
+                // 缓存文件在查询之后、发送之前被淘汰，重新获取一次
+                if (!posterCache->get(posterUrl, width, file)) {
+                    return crow::response(502, "Failed to fetch image");
+                }
+                res = makePosterResponse(request, file);
+            }
+            return res;
+        });
+    });
+
+    // 本地目录全文检索，不访问上游站点
+    CROW_ROUTE(app, "/api/local-search")
+    ([this](const crow::request& req) {
+        const char* queryParam = req.url_params.get("q");
+        const std::string query = queryParam ? trim(queryParam) : "";
+        if (query.empty()) {
+            return makeJsonResponse(400, false, "Missing q parameter");
+        }
+
+        std::size_t limit = kDefaultLocalSearchLimit;
+        if (const char* limitParam = req.url_params.get("limit")) {
+            try {
+                limit = std::min<std::size_t>(std::stoul(limitParam), kMaxLocalSearchLimit);
+            } catch (const std::exception&) {
+                return makeJsonResponse(400, false, "Invalid limit parameter");
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const std::vector<LocalSearchHit> hits = localSearch(query, limit);
+        const auto end = std::chrono::steady_clock::now();
+
+        crow::json::wvalue body;
+        body["ok"] = true;
+        body["query"] = query;
+        body["took_us"] = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+        body["hits"] = crow::json::wvalue::list();
+        int hitIndex = 0;
+        for (const auto& hit : hits) {
+            crow::json::wvalue hitObj;
+            hitObj["title"] = hit.title;
+            hitObj["score"] = hit.score;
+            hitObj["sources"] = hit.sourceCount;
+            body["hits"][hitIndex++] = std::move(hitObj);
         }
+        return crow::response(200, body);
+    });
 
-        return crow::response(toCatalogJson(snapshot));
+    // 搜索框输入联想
+    CROW_ROUTE(app, "/api/suggest")
+    ([this](const crow::request& req) {
+        const char* prefixParam = req.url_params.get("prefix");
+        const std::string prefix = prefixParam ? trim(prefixParam) : "";
+
+        crow::json::wvalue body;
+        body["ok"] = true;
+        body["prefix"] = prefix;
+        body["suggestions"] = crow::json::wvalue::list();
+        int index = 0;
+        for (const auto& suggestion : suggestions.suggest(prefix, kDefaultSuggestLimit)) {
+            body["suggestions"][index++] = suggestion;
+        }
+        return crow::response(200, body);
     });
 
     // 添加搜索端点
     CROW_ROUTE(app, "/api/search")
     .methods("POST"_method)
-    ([this](const crow::request& req) {
+    ([this](const crow::request& req, crow::response& res) {
         const auto x = crow::json::load(req.body);
         if (!x || !x.has("keyword")) {
-            return makeJsonResponse(400, false, "Missing keyword parameter");
+            res = makeJsonResponse(400, false, "Missing keyword parameter");
+            res.end();
+            return;
         }
 
         const std::string keyword = trim(x["keyword"].s());
         if (keyword.empty()) {
-            return makeJsonResponse(400, false, "Keyword cannot be empty");
+            res = makeJsonResponse(400, false, "Keyword cannot be empty");
+            res.end();
+            return;
+        }
+
+        // 默认立即返回任务 ID，由客户端轮询进度；"wait": true 时在搜索结束后再返回，
+        // 等待期间不占用 HTTP 工作线程，任务结束时回到连接的 io 线程 end()
+        const bool wait = x.has("wait") && x["wait"].t() == crow::json::type::True;
+        bool joined = false;
+        const std::shared_ptr<SearchJob> job = startSearchJob(keyword, joined);
+        if (!job) {
+            res = makeJsonResponse(429, false, "Search queue is full, retry later");
+            res.set_header("Retry-After", std::to_string(kSearchRetryAfterSeconds));
+            res.end();
+            return;
+        }
+        if (!wait) {
+            crow::json::wvalue body = searchJobJson(job->snapshot());
+            body["message"] = joined ? "Search already in progress" : "Search started";
+            res = crow::response(202, body);
+            res.end();
+            return;
+        }
+
+        crow::asio::io_context* io = req.io_context;
+        // 回调保存在任务里，只持有弱引用，避免任务引用自身
+        std::weak_ptr<SearchJob> weakJob = job;
+        job->onFinished([io, &res, weakJob]() {
+            const std::shared_ptr<SearchJob> finished = weakJob.lock();
+            if (!finished) {
+                return;
+            }
+            const SearchJob::Snapshot snapshot = finished->snapshot();
+            finishAsyncResponse(io, res, crow::response(snapshot.state == SearchJob::State::Completed ? 200 : 500, searchJobJson(snapshot)));
+        });
+    });
+
+    // 搜索任务：GET 查询进度，DELETE 取消并中止进行中的上游请求
+    CROW_ROUTE(app, "/api/search/<string>")
+    .methods("GET"_method, "DELETE"_method)
+    ([this](const crow::request& req, const std::string& id) {
+        const std::shared_ptr<SearchJob> job = searchJobs.find(id);
+        if (!job) {
+            return makeJsonResponse(404, false, "Search job not found");
         }
 
-        bool result = deleteOutputJsonFiles();
-        if (!result) {
-            return makeJsonResponse(500, false, "Failed to reset cached search results");
+        if (req.method == "DELETE"_method && job->cancel()) {
+            logInfo("搜索任务已请求取消: id=", id, ", keyword=", job->keyword());
+        }
+        return crow::response(200, searchJobJson(job->snapshot()));
+    });
+
+    // 线程池、后台任务和搜索排队状态
+    CROW_ROUTE(app, "/api/executor")
+    ([this]() {
+        const TaskExecutor::Stats stats = backgroundTasks->getStats();
+        const ThreadPool::Stats pool = ThreadPool::instance().getStats();
+        crow::json::wvalue body;
+        body["ok"] = true;
+        body["http_threads"] = httpThreads;
+        body["pool"]["workers"] = pool.workers;
+        body["pool"]["queued_high"] = pool.queued[static_cast<std::size_t>(ThreadPool::Priority::High)];
+        body["pool"]["queued_normal"] = pool.queued[static_cast<std::size_t>(ThreadPool::Priority::Normal)];
+        body["pool"]["queued_low"] = pool.queued[static_cast<std::size_t>(ThreadPool::Priority::Low)];
+        body["pool"]["running"] = pool.running;
+        body["pool"]["submitted"] = pool.submitted;
+        body["pool"]["completed"] = pool.completed;
+        body["pool"]["steals"] = pool.steals;
+        body["pool"]["helped"] = pool.helped;
+        body["max_running"] = stats.maxRunning;
+        body["max_queued"] = stats.maxQueued;
+        body["queued"] = stats.queued;
+        body["running"] = stats.running;
+        body["completed"] = stats.completed;
+        body["rejected"] = stats.rejected;
+        body["probe_dropped"] = healthProber.dropped();
+        body["catalog_refresh_dropped"] = catalogRefreshDropped.load();
+        const TaskExecutor::Stats detail = detailTasks->getStats();
+        body["detail"]["max_running"] = detail.maxRunning;
+        body["detail"]["max_queued"] = detail.maxQueued;
+        body["detail"]["queued"] = detail.queued;
+        body["detail"]["running"] = detail.running;
+        body["detail"]["completed"] = detail.completed;
+        body["detail"]["rejected"] = detail.rejected;
+        const TaskExecutor::Stats media = mediaTasks->getStats();
+        body["media"]["max_running"] = media.maxRunning;
+        body["media"]["max_queued"] = media.maxQueued;
+        body["media"]["queued"] = media.queued;
+        body["media"]["running"] = media.running;
+        body["media"]["completed"] = media.completed;
+        body["media"]["rejected"] = media.rejected;
+        {
+            std::lock_guard<std::mutex> lock(searchQueueMutex);
+            body["search_queue"] = searchQueue.size();
+            body["search_running"] = searchLaneBusy;
+            body["search_queue_limit"] = searchQueueLimit;
         }
+        return crow::response(200, body);
+    });
+
+    // 搜索并发限制：GET 查看当前状态，POST 修改 min_limit / max_limit / per_host_limit
+    CROW_ROUTE(app, "/api/limiter")
+    .methods("GET"_method, "POST"_method)
+    ([this](const crow::request& req) {
+        if (req.method == "POST"_method) {
+            const auto x = crow::json::load(req.body);
+            if (!x) {
+                return makeJsonResponse(400, false, "Invalid JSON body");
+            }
 
-        result = search(keyword);
+            ConcurrencyLimiter::Config config = searchLimiter.getConfig();
+            const auto readLimit = [&x](const char* key, std::size_t& target) {
+                if (!x.has(key)) {
+                    return true;
+                }
+                if (x[key].t() != crow::json::type::Number || x[key].i() < 1) {
+                    return false;
+                }
+                target = static_cast<std::size_t>(x[key].i());
+                return true;
+            };
+            if (!readLimit("min_limit", config.minLimit) || !readLimit("max_limit", config.maxLimit) ||
+                !readLimit("per_host_limit", config.perHostLimit) || config.minLimit > config.maxLimit) {
+                return makeJsonResponse(400, false, "Limits must be positive integers and min_limit <= max_limit");
+            }
+            searchLimiter.setConfig(config);
+            logInfo("并发限制配置已更新: min=", config.minLimit, ", max=", config.maxLimit, ", per_host=", config.perHostLimit);
+        }
 
-        if (!result) {
-            return makeJsonResponse(500, false, "Search failed or returned no valid sources");
+        const ConcurrencyLimiter::Snapshot snapshot = searchLimiter.getSnapshot();
+        crow::json::wvalue body;
+        body["ok"] = true;
+        body["limit"] = snapshot.limit;
+        body["in_flight"] = snapshot.inFlight;
+        body["min_limit"] = snapshot.config.minLimit;
+        body["max_limit"] = snapshot.config.maxLimit;
+        body["per_host_limit"] = snapshot.config.perHostLimit;
+        body["increases"] = snapshot.increases;
+        body["decreases"] = snapshot.decreases;
+        body["hosts_in_flight"] = crow::json::wvalue::object();
+        for (const auto& [host, count] : snapshot.hostsInFlight) {
+            body["hosts_in_flight"][host] = count;
+        }
+        body["host_latency"] = crow::json::wvalue::object();
+        for (const auto& [host, latency] : snapshot.hostLatency) {
+            body["host_latency"][host]["baseline_ms"] = latency.baselineMs;
+            body["host_latency"][host]["recent_ms"] = latency.recentMs;
         }
+        return crow::response(200, body);
+    });
 
-        setVideoList(getVideoList());
-        return makeJsonResponse(200, true, "Search completed successfully");
+    CROW_ROUTE(app, "/api/transfer-stats")
+    ([this]() {
+        crow::json::wvalue body;
+        std::size_t totalWireBytes = 0;
+        std::size_t totalBodyBytes = 0;
+        body["providers"] = crow::json::wvalue::object();
+        {
+            std::lock_guard<std::mutex> lock(transferStatsMutex);
+            for (const auto& [domain, transfer] : transferStats) {
+                crow::json::wvalue& entry = body["providers"][domain];
+                entry["responses"] = transfer.responses;
+                entry["compressed_responses"] = transfer.compressedResponses;
+                entry["wire_bytes"] = transfer.wireBytes;
+                entry["body_bytes"] = transfer.bodyBytes;
+                entry["last_encoding"] = transfer.lastEncoding;
+                totalWireBytes += transfer.wireBytes;
+                totalBodyBytes += transfer.bodyBytes;
+            }
+        }
+        body["wire_bytes"] = totalWireBytes;
+        body["body_bytes"] = totalBodyBytes;
+        // 解码后字节数 / 网络传输字节数，越大说明压缩越有效
+        body["compression_ratio"] = totalWireBytes > 0 ? static_cast<double>(totalBodyBytes) / static_cast<double>(totalWireBytes) : 1.0;
+        return crow::response(200, body);
     });
 
     CROW_ROUTE(app, "/api/update")
@@ -655,22 +2295,28 @@ void WebServer::setupRoutes() {
     });
 }
 
-bool WebServer::search(const std::string& key) {
+bool WebServer::search(const std::string& key, SearchJob* job) {
     try {
-        const std::string sourceFile = INPUT_PATH + "source.json";
+        const std::string sourceFile = inputPath + "source.json";
         json source = readSiteConfig(sourceFile);
         if (source.empty()) {
             logError("无法读取配置文件: ", sourceFile);
             return false;
         }
 
-        const std::filesystem::path outputDir(OUTPUT_PATH);
+        const std::filesystem::path outputDir(outputPath);
         if (!ensureDirectoryExists(outputDir, "输出目录")) {
             return false;
         }
+        // 取消或没有结果时丢弃暂存目录，output 中上一次的结果保持不变
+        const std::filesystem::path stagingDir = outputDir / kSearchStagingDir;
+        std::filesystem::remove_all(stagingDir);
+        if (!ensureDirectoryExists(stagingDir, "搜索暂存目录")) {
+            return false;
+        }
 
         HTTPSJsonClient encodeClient;
-        const std::string encodeKey = encodeClient.urlEncode(key);
+        const std::string query = (twoPhaseSearch ? "?ac=list&wd=" : "?ac=videolist&wd=") + encodeClient.urlEncode(key);
         const json siteList = loadApiSites(source, sourceFile);
         if (siteList.empty()) {
             return false;
@@ -678,64 +2324,193 @@ bool WebServer::search(const std::string& key) {
 
         SearchStats stats;
         std::deque<std::future<SiteSearchResult>> tasks;
+        TaskGroup group;
+        std::vector<PendingSite> pending;
+        std::map<std::string, ProviderPartition> partitions;
+
+        // 所有站点共用一个截止时间，排队、限速等待和重试都不会超过它
+        SiteRequestOptions requestOptions;
+        requestOptions.rateLimiter = &providerRateLimiter;
+        requestOptions.retryPolicy.maxAttempts = searchRetryAttempts;
+        requestOptions.deadline = std::chrono::steady_clock::now() + kSearchDeadline;
+        requestOptions.cancelFlag = job ? job->cancelFlag() : nullptr;
+        const auto isCancelled = [job]() {
+            return job && job->isCancelled();
+        };
 
         for (const auto& [domain, site] : siteList.items()) {
             const std::string siteName = site.value("name", domain);
 
-            if (shouldSkipSite(domain, kMaxSiteFailureCount)) {
+            if (!siteBreaker->allowRequest(domain)) {
                 stats.skippedSites++;
-                logInfo("站点已累计失败 ", kMaxSiteFailureCount, " 次，跳过本次搜索: ", siteName);
+                logInfo("站点熔断中，跳过本次搜索: ", siteName);
+                if (job) {
+                    job->addSite(domain, siteName, true);
+                }
                 continue;
             }
 
             stats.attemptedSites++;
+            const std::string api = site.contains("api") && site["api"].is_string() ? site["api"].get<std::string>() : domain;
+            pending.push_back(PendingSite{domain, site, HTTPSJsonClient::hostOf(api)});
+            partitions[domain].pagesPending++;
+            if (job) {
+                job->addSite(domain, siteName, false);
+                job->pageQueued(domain);
+            }
+        }
 
-            if (tasks.size() >= kMaxConcurrentSearches) {
-                SiteSearchResult siteResult = consumeCompletedSearchTask(tasks);
-                if (siteResult.requestSucceeded) {
-                    stats.successfulResponses++;
+        // 由自适应限制器决定同时进行的请求数，优先启动所在主机还有名额的站点。
+        // 第一页返回后，其余分页加入同一队列并发请求，每个站点最多 searchPageBudget 页
+        while (!pending.empty() || !tasks.empty()) {
+            // 取消后不再发起新请求，进行中的请求由取消标志中止
+            if (isCancelled()) {
+                pending.clear();
+                if (tasks.empty()) {
+                    break;
                 }
-                if (siteResult.fileSaved) {
-                    stats.savedFiles++;
+            }
+
+            if (!pending.empty()) {
+                std::vector<std::string> hosts;
+                hosts.reserve(pending.size());
+                for (const auto& candidate : pending) {
+                    hosts.push_back(candidate.host);
                 }
 
-                const int failureCount = recordSiteRequestResult(siteResult.domain, siteResult.requestSucceeded);
-                if (!siteResult.requestSucceeded) {
-                    logError("站点失败计数更新: ", siteResult.siteName.empty() ? siteResult.domain : siteResult.siteName,
-                             ", failures=", failureCount, "/", kMaxSiteFailureCount);
+                // 有请求在途时不等待名额，先处理已返回的结果，让它们的分页尽早排队；
+                // 没有请求在途时分段等待，期间仍能响应取消
+                std::size_t index = 0;
+                const bool acquired = searchLimiter.tryAcquireAny(hosts, index, tasks.empty() ? kSearchTaskPollInterval : std::chrono::milliseconds(0));
+
+                if (acquired) {
+                    PendingSite next = std::move(pending[index]);
+                    pending.erase(pending.begin() + static_cast<std::ptrdiff_t>(index));
+
+                    tasks.push_back(ThreadPool::instance().submit(ThreadPool::Priority::High, [this, stagingDir, next, query, requestOptions]() {
+                        LimiterSlot slot(searchLimiter, next.host);
+                        SiteRequestOptions options = requestOptions;
+                        options.slot = &slot;
+                        SiteSearchResult result = searchSingleSite(fileWriter, stagingDir, next.domain, next.site, query, next.page, cacheCompression, options);
+                        slot.release(result.latency, limiterOutcome(result.requestSucceeded, result.requestTimedOut, result.throttled));
+                        // 在请求所在的线程解析，搜索循环只合并结果
+                        if (result.fileSaved) {
+                            result.videos = loadSearchResultFile(result.savedFile, normalizeSiteFileKey(next.domain), next.site.value("name", next.domain));
+                        }
+                        return result;
+                    }, &group));
+                    continue;
+                }
+                if (tasks.empty()) {
+                    continue;
                 }
             }
 
-            tasks.push_back(std::async(std::launch::async, [outputDir, domain, site, encodeKey]() {
-                return searchSingleSite(outputDir, domain, site, encodeKey);
-            }));
-        }
-
-        while (!tasks.empty()) {
-            SiteSearchResult siteResult = consumeCompletedSearchTask(tasks);
-            if (siteResult.requestSucceeded) {
-                stats.successfulResponses++;
+            SiteSearchResult siteResult = consumeCompletedSearchTask(tasks, group);
+            ProviderPartition& partition = partitions[siteResult.domain];
+            partition.pagesPending--;
+            partition.videos.insert(partition.videos.end(),
+                                    std::make_move_iterator(siteResult.videos.begin()),
+                                    std::make_move_iterator(siteResult.videos.end()));
+            if (job && !siteResult.cancelled) {
+                job->pageFinished(siteResult.domain, siteResult.page, siteResult.requestSucceeded, siteResult.fileSaved);
             }
             if (siteResult.fileSaved) {
                 stats.savedFiles++;
             }
+            if (siteResult.requestSucceeded) {
+                recordProviderTransfer(siteResult.domain, siteResult.transfer);
+            }
+
+            // 被取消的请求不代表站点故障；分页失败不计入熔断，已取得的页面照常使用
+            if (siteResult.cancelled) {
+                continue;
+            }
+            // 本地限速或截止时间导致请求没有发出，站点本身没有出错，不计入熔断
+            if (siteResult.throttled) {
+                stats.throttledRequests++;
+                logInfo("站点请求未发出（本地限速或截止时间），不计入熔断: ", siteResult.siteName.empty() ? siteResult.domain : siteResult.siteName,
+                        ", 第 ", siteResult.page, " 页");
+                continue;
+            }
+            if (siteResult.page > 1) {
+                if (!siteResult.requestSucceeded) {
+                    stats.failedPages++;
+                }
+                continue;
+            }
+
+            if (siteResult.requestSucceeded) {
+                stats.successfulResponses++;
+                const std::size_t lastPage = std::min(siteResult.pageCount, searchPageBudget);
+                if (siteResult.pageCount > searchPageBudget) {
+                    logInfo("站点 ", siteResult.siteName, " 共 ", siteResult.pageCount, " 页，只取前 ", searchPageBudget, " 页");
+                }
+                for (std::size_t page = 2; page <= lastPage; ++page) {
+                    const json& site = siteList[siteResult.domain];
+                    const std::string api = site["api"].get<std::string>();
+                    pending.push_back(PendingSite{siteResult.domain, site, HTTPSJsonClient::hostOf(api), page});
+                    partition.pagesPending++;
+                    stats.extraPages++;
+                    if (job) {
+                        job->pageQueued(siteResult.domain);
+                    }
+                }
+            }
 
-            const int failureCount = recordSiteRequestResult(siteResult.domain, siteResult.requestSucceeded);
+            const CircuitBreaker::Status breakerState = siteBreaker->recordResult(siteResult.domain, siteResult.requestSucceeded);
             if (!siteResult.requestSucceeded) {
                 logError("站点失败计数更新: ", siteResult.siteName.empty() ? siteResult.domain : siteResult.siteName,
-                         ", failures=", failureCount, "/", kMaxSiteFailureCount);
+                         ", failures=", breakerState.consecutiveFailures,
+                         ", state=", CircuitBreaker::stateName(breakerState.state));
+            }
+        }
+
+        // 分页未取完的站点，已取得的页面同样进入目录，与 output 目录保持一致
+        std::map<std::string, std::vector<VideoInfo>> fresh;
+        for (auto& [domain, partition] : partitions) {
+            if (!partition.videos.empty()) {
+                fresh[normalizeSiteFileKey(domain)] = std::move(partition.videos);
             }
         }
 
+        if (!fileWriter.flush()) {
+            logError("搜索结果同步到磁盘时出现错误");
+        }
+        siteBreaker->save();
+
         logInfo("搜索完成: 共尝试 ", stats.attemptedSites,
                 " 个站点, 跳过 ", stats.skippedSites,
                 " 个站点, 成功响应 ", stats.successfulResponses,
-                " 个, 落盘 ", stats.savedFiles, " 个文件");
+                " 个, 追加分页 ", stats.extraPages,
+                " 页 (失败 ", stats.failedPages,
+                "), 本地限流未发出 ", stats.throttledRequests,
+                " 个请求, 落盘 ", stats.savedFiles, " 个文件");
+
+        const ConcurrencyLimiter::Snapshot limiterState = searchLimiter.getSnapshot();
+        logInfo("并发限制: 当前=", limiterState.limit, ", 已统计延迟的主机 ", limiterState.hostLatency.size(), " 个");
+        for (const auto& [host, latency] : limiterState.hostLatency) {
+            logInfo("  ", host, ": 基线延迟=", static_cast<long long>(latency.baselineMs),
+                    "ms, 近期延迟=", static_cast<long long>(latency.recentMs), "ms");
+        }
+
+        if (isCancelled()) {
+            logInfo("搜索已取消，丢弃暂存结果: ", key);
+            std::filesystem::remove_all(stagingDir);
+            return false;
+        }
+
+        // 取消或一个结果都没有时，output 和目录都保持上一次的内容
+        if (stats.savedFiles == 0 || fresh.empty()) {
+            logError("没有任何站点返回可用的搜索结果");
+            std::filesystem::remove_all(stagingDir);
+            return false;
+        }
 
-        if (stats.savedFiles == 0) {
-            logError("没有任何站点返回可保存的搜索结果");
+        if (!commitSearchOutput(stagingDir)) {
             return false;
         }
+        publishSearchResults(std::move(fresh));
     } catch (const std::exception& e) {
         logError("程序异常: ", e.what());
         return false;
@@ -744,9 +2519,114 @@ bool WebServer::search(const std::string& key) {
     return true;
 }
 
+// 备份并清除 output 中上一次的结果，再把暂存目录中的新结果移入
+bool WebServer::commitSearchOutput(const std::filesystem::path& stagingDir) {
+    if (!deleteOutputJsonFiles()) {
+        return false;
+    }
+
+    const std::filesystem::path outputDir(outputPath);
+    int moved = 0;
+    for (const auto& staged : collectJsonFiles(stagingDir)) {
+        if (fileWriter.move(staged, outputDir / staged.filename())) {
+            moved++;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::remove_all(stagingDir, ec);
+    if (!fileWriter.flush()) {
+        logError("搜索结果同步到磁盘时出现错误");
+    }
+    logInfo("搜索结果已替换 output 目录: ", moved, " 个文件");
+    return moved > 0;
+}
+
+std::shared_ptr<SearchJob> WebServer::startSearchJob(const std::string& keyword, bool& joined) {
+    std::lock_guard<std::mutex> lock(searchQueueMutex);
+    // 同一关键词的搜索正在排队或进行时直接返回它，不重复搜索，也不取消其他客户端的搜索
+    joined = false;
+    if (std::shared_ptr<SearchJob> existing = searchJobs.findActive(keyword)) {
+        logInfo("同一关键词的搜索尚未结束，复用任务: id=", existing->id(), ", keyword=", keyword);
+        joined = true;
+        return existing;
+    }
+
+    // 被取消的任务收尾前仍占用名额，排队已满时拒绝
+    if (searchQueue.size() + (searchLaneBusy ? 1 : 0) >= searchQueueLimit) {
+        logInfo("搜索排队已满，拒绝新的搜索: keyword=", keyword);
+        return nullptr;
+    }
+
+    std::shared_ptr<SearchJob> job = searchJobs.create(keyword);
+    logInfo("创建搜索任务: id=", job->id(), ", keyword=", keyword);
+    searchQueue.push_back(job);
+
+    // 搜索共用 output 目录，只占用一个后台线程依次执行
+    if (!searchLaneBusy) {
+        if (!backgroundTasks->submit("search-" + job->id(), [this]() { drainSearchQueue(); })) {
+            searchQueue.pop_back();
+            job->finish(SearchJob::State::Failed, "Background executor is busy");
+            return nullptr;
+        }
+        searchLaneBusy = true;
+    }
+    return job;
+}
+
+void WebServer::drainSearchQueue() {
+    while (true) {
+        std::shared_ptr<SearchJob> job;
+        {
+            std::lock_guard<std::mutex> lock(searchQueueMutex);
+            if (searchQueue.empty()) {
+                searchLaneBusy = false;
+                return;
+            }
+            job = searchQueue.front();
+            searchQueue.pop_front();
+        }
+        runSearchJob(job);
+    }
+}
+
+void WebServer::runSearchJob(const std::shared_ptr<SearchJob>& job) {
+    // 排队期间已被客户端取消
+    if (job->isCancelled()) {
+        job->finish(SearchJob::State::Cancelled, "Search cancelled");
+        return;
+    }
+
+    job->start();
+
+    // 成功的搜索在返回前已把结果整体发布到目录并更新了索引
+    const bool result = search(job->keyword(), job.get());
+    std::size_t titles = 0;
+    {
+        std::lock_guard<std::mutex> lock(videoListMutex);
+        titles = videoList.titles().size();
+    }
+    // 标记完成前刷新 /api/videos 的内容，客户端看到任务完成后读到的一定是新目录
+    if (result) {
+        refreshCatalogBody();
+    }
+
+    if (job->isCancelled()) {
+        job->finish(SearchJob::State::Cancelled, "Search cancelled");
+        return;
+    }
+    if (!result) {
+        job->finish(SearchJob::State::Failed, "Search failed or returned no valid sources");
+        return;
+    }
+
+    suggestions.increase(job->keyword(), kSearchKeywordWeight);
+    job->finish(SearchJob::State::Completed, "Search completed successfully", titles);
+    logInfo("搜索任务完成: id=", job->id(), ", 标题数=", titles);
+}
+
 bool WebServer::updateSiteConfig() {
     try {
-        const std::filesystem::path inputDir(INPUT_PATH);
+        const std::filesystem::path inputDir(inputPath);
         if (!ensureDirectoryExists(inputDir, "输入目录")) {
             return false;
         }
@@ -788,7 +2668,7 @@ bool WebServer::updateSiteConfig() {
             logInfo("已备份站点配置到: ", backupFile);
         }
 
-        if (!writeFileContent(sourceFile, formattedJson)) {
+        if (!writeFileContent(fileWriter, sourceFile, formattedJson)) {
             logError("写入站点配置失败: ", sourceFile);
             return false;
         }
@@ -831,16 +2711,16 @@ json WebServer::readSiteConfig(const std::string& filePath) {
     }
 }
 
-// OUTPUT_PATH路径下所有JSON文件的方法
+// outputPath路径下所有JSON文件的方法
 bool WebServer::deleteOutputJsonFiles() {
     try {
-        const std::filesystem::path outputPath(OUTPUT_PATH);
+        const std::filesystem::path outputDir(outputPath);
 
-        if (!std::filesystem::exists(outputPath)) {
-            return ensureDirectoryExists(outputPath, "输出目录");
+        if (!std::filesystem::exists(outputDir)) {
+            return ensureDirectoryExists(outputDir, "输出目录");
         }
 
-        const std::vector<std::filesystem::path> jsonFiles = collectJsonFiles(outputPath);
+        const std::vector<std::filesystem::path> jsonFiles = collectJsonFiles(outputDir);
 
         if (jsonFiles.empty()) {
             logInfo("没有找到要删除的 JSON 文件");
@@ -849,11 +2729,11 @@ bool WebServer::deleteOutputJsonFiles() {
 
         std::filesystem::path backupRoot;
         std::filesystem::path backupDir;
-        if (!createBackupDirectory(outputPath, backupRoot, backupDir)) {
+        if (!createBackupDirectory(outputDir, backupRoot, backupDir)) {
             return false;
         }
 
-        const int copiedCount = backupFiles(jsonFiles, backupDir);
+        const int copiedCount = backupFiles(fileWriter, jsonFiles, backupDir, cacheCompression);
         pruneOldBackups(backupRoot);
         const int deletedCount = deleteFiles(jsonFiles);
 
@@ -1,49 +1,238 @@
 #ifndef WEBSERVER_H
 #define WEBSERVER_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include "crow/crow.h"
+#include "atomic_file_writer.h"
+#include "catalog_search_index.h"
+#include "circuit_breaker.h"
+#include "concurrency_limiter.h"
+#include "hls_proxy.h"
+#include "https_json_client.h"
 #include "json_parser.h"
+#include "poster_cache.h"
+#include "rate_limiter.h"
+#include "search_job.h"
+#include "task_executor.h"
+#include "stream_health_prober.h"
+#include "suggestion_trie.h"
+#include "video_catalog.h"
 
 class WebServer {
+public:
+    // 按站点累计的上游传输量：wireBytes 为网络上收到的字节数，bodyBytes 为解码后的字节数
+    struct ProviderTransferStats {
+        std::size_t responses = 0;
+        std::size_t compressedResponses = 0;
+        std::size_t wireBytes = 0;
+        std::size_t bodyBytes = 0;
+        std::string lastEncoding;
+    };
+
 private:
-    std::map<std::string, std::vector<VideoInfo>> videoList;
+    // 按标题归并的目录，每次搜索用全部站点的结果整体替换
+    catalog::PartitionedCatalog videoList;
+    // 目录内容每次变化（替换搜索结果或补全详情）加一，受 videoListMutex 保护
+    std::uint64_t videoListVersion = 0;
     mutable std::mutex videoListMutex;
-    std::map<std::string, int> siteFailureCounts;
-    mutable std::mutex siteFailureCountsMutex;
+    // 目录中出现过的播放地址和海报地址，受 videoListMutex 保护；
+    // HLS 代理只接受这些入口地址或本服务签名过的地址，/img 只下载目录中的海报
+    std::unordered_set<std::string> catalogPlayUrls;
+    std::unordered_set<std::string> catalogPosterUrls;
+    // 预先序列化的 /api/videos 响应，记录生成时的目录版本和探测结果版本
+    struct CatalogBody {
+        std::string json;
+        std::uint64_t catalogVersion = 0;
+        std::uint64_t healthVersion = 0;
+        std::chrono::steady_clock::time_point builtAt;
+    };
+    std::shared_ptr<const CatalogBody> catalogBody;
+    std::mutex catalogBodyMutex;
+    std::mutex catalogBuildMutex;
+    // 本地搜索索引，与 videoList 一起受 videoListMutex 保护并同时发布
+    std::shared_ptr<const CatalogSearchIndex> searchIndex;
+    SuggestionTrie suggestions;
+    std::unique_ptr<HlsProxy> hlsProxy;
+    std::unique_ptr<PosterCache> posterCache;
+    std::size_t hlsMemoryCacheBytes = 256u * 1024 * 1024;
+    std::size_t hlsDiskCacheBytes = 2048u * 1024 * 1024;
+    std::size_t posterDiskCacheBytes = 512u * 1024 * 1024;
+    std::size_t hlsPrefetchSegments = 3;
+    std::size_t hlsNextEpisodeSegments = 2;
+    StreamHealthProber healthProber{4, 512, std::chrono::minutes(30)};
+    // 初始并发 4，之后按站点响应延迟和超时自适应调整
+    ConcurrencyLimiter searchLimiter{ConcurrencyLimiter::Config(), 4};
+    // 按主机限速，429/503 的 Retry-After 会暂停对应主机
+    TokenBucketLimiter providerRateLimiter{TokenBucketLimiter::Config()};
+    int searchRetryAttempts = 3;
+    // 每个站点最多请求的结果页数（含第一页）
+    std::size_t searchPageBudget = 5;
+    // 按站点累计的上游传输量，用于观察压缩效果
+    std::map<std::string, ProviderTransferStats> transferStats;
+    mutable std::mutex transferStatsMutex;
+    // 按站点熔断，状态保存在缓存目录
+    std::unique_ptr<CircuitBreaker> siteBreaker;
     crow::SimpleApp app;
+    AtomicFileWriter fileWriter;
+    bool cacheCompression = false;
 
-    static const std::string INPUT_PATH;
-    static const std::string OUTPUT_PATH;
-
-    bool shouldSkipSite(const std::string& domain, int maxFailures) const;
-    int recordSiteRequestResult(const std::string& domain, bool requestSucceeded);
+    // 数据目录，默认相对于 build/ 目录
+    std::string inputPath = "../input/";
+    std::string outputPath = "../output/";
+    std::string cachePath = "../cache/";
+    // 两阶段搜索：先用 ac=list 取摘要，播放地址等详情在打开标题或后台预取时按 ac=detail 补全
+    bool twoPhaseSearch = true;
+    std::size_t detailPrefetchTitles = 24;
+    // 异步搜索任务；搜索共用 output 目录，在后台执行器上按到达顺序逐个运行，同一关键词不重复排队
+    SearchJobRegistry searchJobs;
+    std::deque<std::shared_ptr<SearchJob>> searchQueue;
+    bool searchLaneBusy = false;
+    // 排队和运行中的搜索上限，超过时返回 429
+    std::size_t searchQueueLimit = 4;
+    std::mutex searchQueueMutex;
+    // HTTP 工作线程数，0 表示按 CPU 核数
+    std::size_t httpThreads = 0;
+    // 搜索、目录解析和序列化经这里提交到共享线程池，不占用 HTTP 工作线程
+    std::unique_ptr<TaskExecutor> backgroundTasks;
+    // 异步 /api/detail 请求的执行器和任务序号
+    std::unique_ptr<TaskExecutor> detailTasks;
+    std::atomic<std::uint64_t> detailRequestSeq{0};
+    // HLS 代理和海报代理在缓存未命中时的异步请求
+    std::unique_ptr<TaskExecutor> mediaTasks;
+    std::atomic<std::uint64_t> mediaRequestSeq{0};
+    // 后台队列已满而被丢弃的目录 JSON 刷新次数
+    std::atomic<std::uint64_t> catalogRefreshDropped{0};
+    std::mutex detailPrefetchMutex;
+    // 当前后台预取的取消标志：目录变化时取消旧的预取并立即开始新的，不等待旧的结束
+    std::shared_ptr<std::atomic<bool>> detailPrefetchCancel;
+    // 尚未结束的后台预取，析构时等待它们退出
+    std::vector<std::future<void>> detailPrefetches;
 
 public:
-    WebServer() = default;
-    ~WebServer() = default;
+    WebServer();
+    ~WebServer();
 
     // 启动Web服务器
     void run(int port = 8080);
 
+    // 设置站点配置、搜索结果和缓存目录（需在 run 和 search 之前设置）
+    void setDataPaths(const std::string& inputDir, const std::string& outputDir, const std::string& cacheDir);
+
+    // 设置缓存文件的 fsync 策略
+    void setFileSyncMode(AtomicFileWriter::SyncMode mode);
+
+    // 是否以 gzip 压缩保存搜索结果和备份（需在 run 之前设置）
+    void setCacheCompression(bool enabled);
+
+    // 设置 HLS 分片缓存的内存和磁盘容量（字节，需在 run 之前设置）
+    void setHlsCacheBudget(std::size_t memoryBytes, std::size_t diskBytes);
+
+    // 设置搜索并发上限和单个主机的并发上限
+    void setSearchConcurrency(std::size_t maxConcurrency, std::size_t perHostConcurrency);
+
+    // 设置每个上游主机的请求速率（次/秒）和突发容量
+    void setProviderRateLimit(double requestsPerSecond, double burst);
+
+    // 设置搜索请求的最大尝试次数（含首次请求）
+    void setSearchRetryAttempts(int attempts);
+
+    // 设置每个站点最多请求的结果页数（含第一页）
+    void setSearchPageBudget(std::size_t pages);
+
+    // 设置海报图片缓存的磁盘容量（字节，需在 run 之前设置）
+    void setPosterCacheBudget(std::size_t diskBytes);
+
+    // 设置 HLS 分片预读数量和下一集预取的分片数量（需在 run 之前设置）
+    void setHlsPrefetchDepth(std::size_t segmentsAhead, std::size_t nextEpisodeSegments);
+
+    // 是否使用两阶段搜索，关闭时直接请求 ac=videolist 的完整结果
+    void setTwoPhaseSearch(bool enabled);
+
+    // 目录更新后在后台补全详情的标题数量（按视频源数量从多到少），0 表示只在打开时补全
+    void setDetailPrefetchTitles(std::size_t titles);
+
+    // 设置 HTTP 工作线程数（0 表示按 CPU 核数，需在 run 之前设置）
+    void setHttpThreads(std::size_t threads);
+
+    // 设置同时执行的后台任务数和排队搜索数上限
+    void setBackgroundThreads(std::size_t threads, std::size_t searchQueueLimit);
+
     // 设置视频数据
     void setVideoList(const std::map<std::string, std::vector<VideoInfo>>& data);
 
+    // 在本地目录索引中查询
+    std::vector<LocalSearchHit> localSearch(const std::string& query, std::size_t limit) const;
+
     // 读取视频数据
     std::map<std::string, std::vector<VideoInfo>> getVideoList();
 
+    // 读取按站点累计的上游传输量（网络字节数和解码后字节数）
+    std::map<std::string, ProviderTransferStats> getTransferStats() const;
+
+    // 补全标题下各视频源的详情，返回该标题的视频源；标题不存在时返回 false
+    bool loadTitleDetails(const std::string& title, std::vector<VideoInfo>& videos);
+
     // 首页路由处理
     void setupRoutes();
 
-    bool search(const std::string& key);
+    // 同步搜索；传入 job 时上报进度，并在任务被取消时中止进行中的请求
+    bool search(const std::string& key, SearchJob* job = nullptr);
+
+    // 在后台排队新的搜索并立即返回任务；同一关键词的搜索尚未结束时返回它并置 joined，
+    // 排队已满时返回 nullptr
+    std::shared_ptr<SearchJob> startSearchJob(const std::string& keyword, bool& joined);
     bool updateSiteConfig();
 
     json readSiteConfig(const std::string& filePath);
 
     bool deleteOutputJsonFiles();
+
+private:
+    // 按站点批量请求 ac=detail 并合并到目录，refs 为（站点文件名, vod_id）；
+    // 整个过程不超过 timeLimit，cancelled 置位后不再发起新的批次并中止进行中的请求。返回补全的条目数
+    std::size_t fetchDetails(const std::vector<std::pair<std::string, int>>& refs,
+                             std::chrono::steady_clock::duration timeLimit,
+                             const std::atomic<bool>* cancelled);
+    void saveDetailResult(const std::string& site, const std::vector<int>& ids, const std::string& response);
+    std::size_t mergeDetails(const std::vector<VideoInfo>& details);
+    void startDetailPrefetch(const std::map<std::string, std::vector<VideoInfo>>& data);
+    void rebuildSearchIndex();
+    // 用一次搜索的全部站点结果整体替换目录，只为内容变化的标题更新索引、联想词和预取
+    void publishSearchResults(std::map<std::string, std::vector<VideoInfo>> partitions);
+    // 在 previous 的基础上只重建变化的标题，目录在此期间未变化时发布，否则完整重建
+    void updateSearchIndex(const std::shared_ptr<const CatalogSearchIndex>& previous, std::uint64_t version,
+                           const std::set<std::string>& changed,
+                           const std::map<std::string, std::vector<VideoInfo>>& entries);
+    // 目录变化后按变化的标题更新联想词并开始预取详情
+    void publishCatalog(const std::map<std::string, std::vector<VideoInfo>>& data);
+    // 按当前目录重建 catalogPlayUrls 和 catalogPosterUrls，调用方需持有 videoListMutex
+    void rebuildCatalogUrls();
+    void addCatalogUrls(const VideoInfo& video);
+    bool isProxyAllowed(const std::string& url, const char* signature) const;
+    bool isCatalogPoster(const std::string& url) const;
+    // 在媒体执行器上生成响应（参数为请求的副本），完成后回到连接的 io 线程 end()；队列已满时返回 429
+    void respondAsync(const crow::request& req, crow::response& res,
+                      std::function<crow::response(const crow::request&)> produce);
+    void runSearchJob(const std::shared_ptr<SearchJob>& job);
+    bool commitSearchOutput(const std::filesystem::path& stagingDir);
+    void drainSearchQueue();
+    std::shared_ptr<const CatalogBody> buildCatalogBody();
+    std::shared_ptr<const CatalogBody> currentCatalogBody();
+    void refreshCatalogBody();
+    void scheduleCatalogRefresh();
+    void recordProviderTransfer(const std::string& domain, const HTTPSJsonClient::TransferSize& transfer);
 };
 
 #endif // WEBSERVER_H